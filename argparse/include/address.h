@@ -0,0 +1,135 @@
+#pragma once
+
+#include "std_optional.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace argparse {
+
+/// An IPv4 or IPv6 address, such as "192.0.2.1" or "2001:db8::1"
+/// The bytes are in network order, an IPv4 address in the first 4 and zeros after, so they can be copied into an
+/// [in_addr] or an [in6_addr] as they are
+struct IpAddress {
+    std::array<uint8_t, 16> bytes{};
+    bool v6 = false;
+
+    /// \return The number of bits of the address, 32 or 128
+    std::size_t bits() const noexcept { return v6 ? 128 : 32; }
+
+    /// \return Bit [n] of the address, counting from the most significant bit of the first byte
+    bool bit(const std::size_t n) const noexcept { return ((bytes[n / 8] >> (7 - n % 8)) & 1U) != 0; }
+};
+
+/// A block of addresses, such as "10.0.0.0/8", those whose first [prefix] bits are the bits of [address]
+/// The bits of [address] after the prefix are zero, so equal blocks have equal members
+struct Cidr {
+    IpAddress address;
+    uint8_t prefix = 0;
+
+    /// \return If [other] is in the block, an IPv4 address is never in an IPv6 block and the other way around
+    bool contains(const IpAddress &other) const noexcept;
+
+    /// \return If every address of [other] is in the block
+    bool contains(const Cidr &other) const noexcept { return (other.prefix >= prefix) && contains(other.address); }
+};
+
+/// @{ Equality compares the family and the bytes, and the prefix of blocks
+inline bool operator==(const IpAddress &lhs, const IpAddress &rhs) { return (lhs.v6 == rhs.v6) && (lhs.bytes == rhs.bytes); }
+inline bool operator!=(const IpAddress &lhs, const IpAddress &rhs) { return !(lhs == rhs); }
+inline bool operator==(const Cidr &lhs, const Cidr &rhs) { return (lhs.prefix == rhs.prefix) && (lhs.address == rhs.address); }
+inline bool operator!=(const Cidr &lhs, const Cidr &rhs) { return !(lhs == rhs); }
+/// @}
+
+namespace detail {
+
+/// Parses an IPv4 address as 4 decimal numbers separated by dots, such as "192.0.2.1", or an IPv6 address as 8 groups
+/// of hexadecimal digits separated by colons, where "::" stands for the groups of zeros it replaces and the last 2
+/// groups may be an IPv4 address, such as "2001:db8::1" or "::ffff:192.0.2.1"
+/// The characters are read once, straight into the bytes, the way [inet_pton] reads them
+/// \throws std::invalid_argument if the address is malformed
+IpAddress parse_ip_address(const char *data, const std::size_t size);
+
+/// Parses a block as an address and a prefix length, such as "10.0.0.0/8" or "2001:db8::/32"
+/// An address without a prefix length is the block of that address alone, and the bits after the prefix are cleared,
+/// so "10.1.2.3/8" is the block "10.0.0.0/8"
+/// \throws std::invalid_argument if the block is malformed
+/// \throws std::out_of_range if the prefix length is above the bits of the address
+Cidr parse_cidr(const char *data, const std::size_t size);
+
+/// @{ Formats an address, IPv6 ones in their shortest form as in RFC 5952, and a block with its prefix length
+std::string format(const IpAddress &address);
+std::string format(const Cidr &block);
+/// @}
+
+/// A set of blocks, in which an address or a block is found by the longest block that contains it
+/// The blocks are paths in a binary trie, one node per bit of their prefixes, whose nodes sit in one array and link
+/// to each other by index, so a lookup follows at most as many nodes as the address has bits and allocates nothing
+class PrefixTrie {
+  public:
+    PrefixTrie() = default;
+
+    /// Inserts each block of [blocks]
+    template <typename Blocks>
+    explicit PrefixTrie(const Blocks &blocks) {
+        for (const Cidr &block : blocks) {
+            insert(block);
+        }
+    }
+
+    /// Inserts a block, inserting a block twice keeps one
+    void insert(const Cidr &block);
+
+    /// \return The prefix length of the longest block that contains the first [bits] bits of [address], if any does
+    pstd::optional<std::size_t> longest_match(const IpAddress &address, const std::size_t bits) const noexcept;
+
+    /// @{ \return If a block contains the address, or every address of the block
+    bool contains(const IpAddress &address) const noexcept { return longest_match(address, address.bits()).has_value(); }
+    bool contains(const Cidr &block) const noexcept { return longest_match(block.address, block.prefix).has_value(); }
+    /// @}
+
+    /// \return If there are no blocks
+    bool empty() const noexcept { return blocks_ == 0; }
+
+  private:
+    /// A bit of a prefix, the index of the node of each value of the next bit, or 0 if there is none
+    struct Node {
+        std::array<uint32_t, 2> children{};
+        bool terminal = false;
+    };
+
+    /// The nodes, [0] and [1] are the roots of the IPv4 and the IPv6 blocks, which no node links to
+    std::vector<Node> nodes_ = std::vector<Node>(2);
+
+    /// Number of distinct blocks
+    std::size_t blocks_ = 0;
+};
+
+} // namespace detail
+} // namespace argparse
+
+namespace std {
+
+template <>
+struct hash<argparse::IpAddress> {
+    std::size_t operator()(const argparse::IpAddress &address) const {
+        std::size_t hash = address.v6 ? 1 : 0;
+        for (const auto byte : address.bytes) {
+            hash = hash * 31 + byte;
+        }
+        return hash;
+    }
+};
+
+template <>
+struct hash<argparse::Cidr> {
+    std::size_t operator()(const argparse::Cidr &block) const {
+        return std::hash<argparse::IpAddress>{}(block.address) * 131 + block.prefix;
+    }
+};
+
+} // namespace std
@@ -1,22 +1,46 @@
 #pragma once
 
+#include "bitmask.h"
+#include "choice.h"
 #include "config.h"
+#include "constraint.h"
+#include "exceptions.h"
+#include "lazy.h"
 #include "placeholder.h"
+#include "profile.h"
 #include "std_optional.h"
+#include "tuple.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace argparse {
 
 /// Forward Declarations
 class Args;
+class Option;
 class Options;
 namespace detail {
+struct Completions;
+class ConfigFile;
+class Environment;
+class ParseCache;
 class Parser;
+class SnapshotReader;
+class SnapshotWriter;
+struct Span;
+class Suggestions;
+struct Token;
 } // namespace detail
 
 /// Main interface to the parsing library
@@ -27,6 +51,9 @@ class Parser;
 ///     - add
 ///     - add_leading_positional
 ///     - add_multivalent
+/// Options can also be converted on first access, instead of while parsing, each of these methods returns a [LazyPlaceHolder]
+///     - add_lazy
+///     - add_lazy_multivalent
 /// After all options are registered, the library needs to parse it with
 ///     - parse
 class Parser {
@@ -38,8 +65,43 @@ class Parser {
         std::function<void(const std::string &)> missing;
         std::function<void(const std::string &, const std::vector<std::string> &)> invalid;
         std::function<void(const std::string &, const std::vector<std::string> &)> not_allowed;
+
+        /// Receives a violated constraint and the names of the options at fault
+        std::function<void(const Constraint, const std::vector<std::string> &)> constraint;
+
+        /// Receives an option that is not registered, and the closest registered names, when unknown options are rejected
+        std::function<void(const std::string &, const std::vector<std::string> &)> unknown;
+
+        /// Receives the candidates asked for by a hidden "--_complete <cword> <words...>" argument, see [set_completion]
+        /// The default prints one candidate per line, as a shell completion function expects, then [exit] ends the parse
+        std::function<void(const std::vector<std::string> &)> complete;
+
+        /// Receives the per phase measurements after every [parse] and [help]
+        /// Only invoked when the library is compiled with [ARGPARSE_INSTRUMENTATION], and must not throw
+        std::function<void(const Profile &)> profile;
+    };
+
+    /// A problem with the input arguments found by [validate]
+    struct Diagnostic {
+        /// What is wrong
+        enum class Error {
+            kMissing,    /// A required option, positional argument, subparser or value is missing
+            kInvalid,    /// A value can not be converted, too many values are given, or the subparser does not exist
+            kNotAllowed, /// A value is not one of the allowed values
+            kConstraint, /// A constraint between options is violated
+            kUnknown,    /// An option is not registered, only reported when unknown options are rejected
+        };
+
+        Error error;                        /// What is wrong
+        const char *name;                   /// Name of the option, or of the subparser group, or the first option at fault
+                                            /// or the input argument of an unknown option
+        pstd::optional<std::size_t> index;  /// Index of the input argument, if the problem is tied to one
+        const char *suggestion = nullptr;   /// Closest registered name to an unknown option, if any is close
     };
 
+    /// Receives each problem found by [validate]
+    using DiagnosticCallback = std::function<void(const Diagnostic &)>;
+
     /// Constructor
     /// \param name Name of the program
     /// \param help Help message / description of the program
@@ -70,6 +132,17 @@ class Parser {
     template <typename T>
     ConstPlaceHolder<T> add(Config<T> config);
 
+    /// Add an option that can have a single value, which is converted and checked on first access instead of while parsing
+    /// Parsing still checks the structure, such as a missing value or too many values
+    /// \param config Configuration for the option
+    template <typename T>
+    LazyPlaceHolder<T> add_lazy(Config<T> config);
+
+    /// Add an option that can have multiple values, which are converted and checked on first access instead of while parsing
+    /// \param config Configuration for the option
+    template <typename T>
+    LazyPlaceHolder<std::vector<T>> add_lazy_multivalent(Config<T> config);
+
     /// Add a positional argument that must come before other non-positional arguments
     /// Positional arguments are expected in the order this function is called
     /// \param config Configuration for the option
@@ -85,19 +158,160 @@ class Parser {
                             const char letter = kUnusedChar,
                             const bool required = false,
                             pstd::optional<T> default_value = T{},
-                            std::unordered_set<T> allowed_values = {});
+                            typename Config<T>::AllowedValues allowed_values = {});
+
+    /// Add an option whose value is one of a set of spellings, each standing for a value of an enum
+    /// The spellings are put in a perfect hash when the option is added, so parsing finds the value with one hash and
+    /// one comparison, and the help message lists the spellings
+    /// Spellings that are not one of the choices are not allowed
+    /// \param config  Configuration for the option, the choices are its allowed values
+    /// \param choices Each spelling and the value it stands for
+    /// \throws [InvalidConfig] if a spelling is repeated, [config] has allowed values, or the default is not a choice
+    /// \code{.cpp}
+    ///   enum class Mode { kRead, kWrite };
+    ///   const auto mode = parser.add_choice(Config<Mode>{.default_value = Mode::kRead, .name = "mode"},
+    ///                                       {{"read", Mode::kRead}, {"write", Mode::kWrite}});
+    /// \endcode
+    template <typename E>
+    ConstPlaceHolder<E> add_choice(Config<E> config, const std::vector<std::pair<std::string, E>> &choices);
+
+    /// Add an option that takes exactly [N] values of the same type, converted straight into a [std::array]
+    /// The values are given like those of a multivalent option, split by comma or following the option, and a value beyond
+    /// [N] is flagged while tokenizing, so too many or too few values are invalid
+    /// \param config        Configuration for the option, the allowed values are those of every element
+    /// \param default_value The default array, if there is one
+    /// \throws [InvalidConfig] if [config] has a default value, the default is the whole array
+    /// \code{.cpp}
+    ///   const auto bbox = parser.add_array<double, 4>(Config<double>{.name = "bbox"});
+    ///   parser.parse(argc, argv); // --bbox 0 0 640 480
+    ///   const double x1 = std::get<2>(bbox->value());
+    /// \endcode
+    template <typename T, std::size_t N>
+    ConstPlaceHolder<std::array<T, N>> add_array(Config<T> config, pstd::optional<std::array<T, N>> default_value = {});
+
+    /// Add an option that takes exactly one value of each of the types [Ts], converted straight into a [std::tuple]
+    /// The values are given as for [add_array], and each is converted to the type of its element
+    /// \param config        Configuration for the option, other than its values
+    /// \param default_value The default tuple, if there is one
+    /// \throws [InvalidConfig] if [config] has a default value or allowed values
+    /// \code{.cpp}
+    ///   const auto window = parser.add_tuple<Duration, Duration, uint32_t>(Config<std::string>{.name = "window"});
+    ///   parser.parse(argc, argv); // --window 1s,5s,10
+    ///   const uint32_t step = std::get<2>(window->value());
+    /// \endcode
+    template <typename... Ts>
+    ConstPlaceHolder<std::tuple<Ts...>> add_tuple(Config<std::string> config, detail::NotDeduced<pstd::optional<std::tuple<Ts...>>> default_value = {});
+
+    /// Adds a constraint on which options of a group may be given together
+    /// Constraints are checked after parsing, each as a handful of operations on a bitmask of the given options
+    /// \param constraint One of [kMutuallyExclusive], [kAllOrNone] or [kAtLeastOne]
+    /// \param names      Names or letters of registered options
+    /// \throws [InvalidConfig] if an option is not registered, or the constraint is not a group constraint
+    void add_group(const Constraint constraint, const std::vector<std::string> &names);
+
+    /// Adds a constraint that if the option is given, every option in [required] must be given too
+    /// \throws [InvalidConfig] if an option is not registered
+    void add_requires(const std::string &name, const std::vector<std::string> &required);
+
+    /// Adds a constraint that if the option is given, none of the options in [conflicts] may be given
+    /// \throws [InvalidConfig] if an option is not registered
+    void add_conflicts(const std::string &name, const std::vector<std::string> &conflicts);
+
+    /// Makes room for [count] more options, so registering a large schema grows the option tables once
+    void reserve(const std::size_t count);
 
     /// Stores each valid callback
     /// Ignores null callback objects so existing callback will not be overwritten
     void set_callbacks(Callbacks &&cbs);
 
+    /// Converts and checks lazy options that are required while parsing, as for other options
+    /// Values that are not allowed are then reported through the callbacks, instead of thrown on first access
+    void set_strict(const bool strict) {
+        strict_ = strict;
+        bump_generation();
+    }
+
+    /// Answers a hidden "--_complete <cword> <words...>" argument of [parse] from [argc, argv] with the candidates of
+    /// [complete], through the [complete] callback then the [exit] callback, instead of parsing
+    /// Off by default, so the argument is otherwise parsed as any other, and never answered for a [cmdline] buffer
+    void set_completion(const bool completion) {
+        completion_ = completion;
+    }
+
+    /// Prints nothing, neither the help message nor the diagnostics of the default callbacks, for parsers whose failures
+    /// are reported some other way
+    /// Replaces the callbacks that print with ones that do not, or back with the printing defaults, so it goes before
+    /// [set_callbacks], the [exit] and [help] callbacks are kept
+    /// Also applies to the subparsers
+    void set_quiet(const bool quiet);
+
+    /// Reports options that are not registered through the [unknown] callback, with the closest registered names, then
+    /// exits as for other invalid arguments, instead of ignoring them
+    /// Also applies to [validate], and to the subparsers
+    void set_reject_unknown(const bool reject);
+
+    /// Takes environment variables from [envp] instead of from the environment of the process
+    /// The variables are copied and indexed once, then shared with the subparsers and used by every parse
+    /// \param envp Array of "NAME=value" strings ending with a null pointer
+    void set_environment(const char *const *envp);
+
+    /// Replaces each "${NAME}" in values by the environment variable, or by nothing if it is not set
+    /// Applies to the values of the input arguments, of environment variables and of the config file
+    /// Lazy options record the expanded values, which live in the parser until its next parse
+    void set_expand(const bool expand);
+
+    /// Takes the values of options that are not given from a file of "name = value" lines, see [detail::ConfigFile]
+    /// The file is mapped and parsed once, then shared with the subparsers, which read the "[section]" of their name
+    /// The input arguments and environment variables take precedence over the file, which takes precedence over the defaults
+    /// \throws std::system_error if the file can not be read, std::invalid_argument if a line is not an entry
+    void set_config_file(const std::string &path);
+
+    /// Shares a config file that is already parsed, such as one just compared with the last file that was read
+    void set_config_file(const std::shared_ptr<const detail::ConfigFile> &file);
+
+    /// Reuses the results of earlier parses of the same arguments from a cache in a file, shared by every process that
+    /// maps it, see [detail::ParseCache]
+    /// A parse that hits skips classifying, converting and checking the arguments, and loads the converted values instead
+    /// The key is the schema, the input arguments after the program, and the environment variables and config file the
+    /// options read, parses that fail or print the help message are not stored, and parses that expand "${NAME}" are not
+    /// cached since any variable may change them
+    /// Lazy options loaded from the cache keep their values in the cache, which must outlive their first access
+    /// \throws std::system_error if the file can not be created or mapped, std::invalid_argument if it is not a cache
+    void set_cache(const std::string &path);
+
+    /// Shares a cache, such as one over a region mapped before forking the processes that parse
+    void set_cache(const std::shared_ptr<detail::ParseCache> &cache);
+
     /// Prints the help message
     void help() const;
 
+    /// Completes a word of a command line, as a shell completion function asks for
+    /// Earlier words select the subparsers, then the word completes to a subparser, to an option name as "--name" or
+    /// letter as "-x", or to an allowed value of the option before it, or after "--name=" in the same word
+    /// The candidates are looked up in sorted indexes built on the first completion, not by scanning the options
+    /// \param words Words of the command line, the first being the program
+    /// \param cword Index of the word to complete, [words.size()] for a word not yet started
+    /// \return The candidates, sorted
+    std::vector<std::string> complete(const std::vector<std::string> &words, const std::size_t cword);
+
     /// Parse arguments
+    /// Every parse starts from the default values, so the same parser can parse many times
     /// \return Remaining arguments that come after a "--"
     const std::vector<std::string> &parse(const int argc, const char **argv);
 
+    /// Checks the arguments the same way as [parse], without setting any values or invoking any callbacks
+    /// Arguments are checked one at a time where they appear, converted values are discarded, and no memory is allocated
+    /// once the buffers have grown, so validating many command lines runs in constant memory
+    /// Arguments that ask for the help message are valid, even without the required options, as [parse] shows it instead
+    /// \param report Receives each problem, if non null
+    /// \return       True if [parse] would accept the arguments
+    bool validate(const int argc, const char **argv, const DiagnosticCallback &report = nullptr);
+
+    /// Parse a block of NUL separated arguments, the first being the program, such as the contents of /proc/<pid>/cmdline
+    /// The arguments are parsed in place, without building an [argv], and the last argument may be missing its terminator
+    /// \return Remaining arguments that come after a "--"
+    const std::vector<std::string> &parse(const char *cmdline, const std::size_t size);
+
     /// Creates subparser(s) from a set of allowed values
     /// The subparser(s) are just like another [Parser] object, except each's options are separate from other subparser's options
     /// The idea behind a subparser is for different options to be handled for a specific group
@@ -138,11 +352,11 @@ class Parser {
     /// Remaining arguments after the "--" splitter
     std::vector<std::string> remaining_args_;
 
-    /// Set of arguments that were parsed
-    std::unordered_set<std::string> existing_args_;
+    /// If each option, by id, was given in the last parse
+    detail::Bitmask present_;
 
-    /// Positional arguments that go before other arguments
-    std::vector<std::string> positionals_;
+    /// Ids of the positional arguments that go before other arguments, in order
+    std::vector<std::size_t> positionals_;
 
     /// Map of subparser name to subparser
     pstd::optional<std::map<std::string, Parser>> subparser_;
@@ -153,24 +367,205 @@ class Parser {
     /// Chosen subparser from the subparser group
     std::string selected_subparser_;
 
+    /// If lazy options that are required are converted while parsing
+    bool strict_ = false;
+
+    /// If a hidden "--_complete" argument asks for completions instead of parsing
+    bool completion_ = false;
+
+    /// If nothing is printed
+    bool quiet_ = false;
+
+    /// Snapshot of the environment variables, taken on first use and shared with the subparsers
+    std::shared_ptr<const detail::Environment> environment_;
+
+    /// If "${NAME}" in values is replaced by the environment variable
+    bool expand_ = false;
+
+    /// Config file under the input arguments, shared with the subparsers
+    std::shared_ptr<const detail::ConfigFile> file_;
+
+    /// Section of the config file for this parser, the name of the subparser or empty
+    std::string section_;
+
+    /// 1 + index of the entry of each option in the config file, by id, 0 if the option has no entry
+    /// Resolved on the first parse after the file or the options change
+    std::vector<uint32_t> file_entries_;
+
+    /// Options that have an entry in the config file, by id
+    detail::Bitmask file_options_;
+
+    /// @{ Buffers for handing values to the options, reused between parses
+    std::string value_;
+    std::vector<std::string> values_;
+    std::vector<detail::Span> spans_;
+    /// @}
+
+    /// Expanded values of lazy options, kept until the next parse, the elements of a deque do not move as it grows
+    std::deque<std::string> expanded_;
+
+    /// If options that are not registered are rejected
+    bool reject_unknown_ = false;
+
+    /// Names of the options grouped by length for suggestions, built on the first unknown option
+    std::unique_ptr<detail::Suggestions> suggestions_;
+
+    /// Sorted names and allowed values of the options, built on the first completion
+    std::unique_ptr<detail::Completions> completions_;
+
+    /// Cache of the results of parses, only used by the parser [parse] is called on
+    std::shared_ptr<detail::ParseCache> cache_;
+
+    /// Generation of the schema of this parser, a fresh number taken from a counter shared by every parser on each change
+    /// of its options, constraints, subparsers or settings
+    uint64_t generation_ = 0;
+
+    /// Hash of the schema of this parser and its subparsers, and the [schema_generation] it was hashed at
+    uint64_t schema_hash_ = 0;
+    uint64_t schema_generation_ = 0;
+
+    /// Key of the arguments being parsed, and the snapshot of the result, reused between parses
+    std::string key_;
+    std::string snapshot_;
+
+    /// If the last parse invoked the exit callback, or missed its subparser, so its result is not cached
+    bool failed_ = false;
+
+    /// Number of values of each option, by id, while validating
+    /// 0 if the option is not given, 1 if given without values, 2 if given with values, 3 if given too many values
+    std::vector<uint8_t> counts_;
+
+    /// Number of values of each option with a fixed number of values, by id, while validating
+    std::vector<uint32_t> elements_;
+
+    /// Adds the help option, every parser has one
+    void add_help();
+
     /// Validates the configuration name / letter is correct
     /// If the name is empty then the name becomes equal to the letter
     template <typename T>
     void validate(Config<T> &config);
 
+    /// Adds an option with choices, once the enum is out of the way
+    /// \param config  Configuration with the spellings of the choices as the allowed values
+    /// \param choices The perfect hash of the spellings, and their values
+    void add_choice(Config<std::string> &&config, const std::shared_ptr<detail::ChoiceIndex> &choices);
+
+    /// Adds an option with a fixed number of values, once the types of the values are out of the way
+    /// \param config Configuration with the default and the allowed values spelled as strings
+    /// \param tuple  Conversions of the values into the elements, and where the value goes
+    void add_tuple(Config<std::string> &&config, const std::shared_ptr<detail::TupleIndex> &tuple);
+
+    /// Parse classified arguments, the entry point shared by both forms of input arguments
+    /// \param tokens The classified arguments, the first being the program
+    /// \return       Remaining arguments that come after a "--"
+    const std::vector<std::string> &parse(const std::vector<detail::Token> &tokens);
+
+    /// Answers "--_complete <cword> <words...>" with the candidates, through the [complete] then the [exit] callbacks
+    /// \param tokens The classified arguments, the first being the program and the second "--_complete"
+    /// \return       No remaining arguments
+    const std::vector<std::string> &answer_completion(const std::vector<detail::Token> &tokens);
+
     /// Parse arguments
+    /// \param tokens    The classified arguments
+    /// \param count     Number of arguments
     /// \param pop_first To remove the first argument or not
+    /// \param offset    Index of [tokens[0]] in the arguments given to the top level parser
     /// \return          Remaining, non-parsed arguments
-    const std::vector<std::string> &parse(const int argc, const char **argv, const bool pop_first);
+    const std::vector<std::string> &parse(const detail::Token *tokens, const std::size_t count, const bool pop_first, const std::size_t offset);
+
+    /// Converts the parsed arguments into the values of the registered options
+    /// \param offset Index of the first parsed argument in the arguments given to the top level parser
+    void cross_check(const Args &args, const std::size_t offset);
+
+    /// Validates arguments, the program has already been removed
+    /// \param offset Index of [argv[0]] in the arguments given to the top level parser
+    bool validate(const char **argv, const std::size_t count, const std::size_t offset, const DiagnosticCallback &report);
+
+    /// \return The snapshot of the environment variables, the one of the process unless [set_environment] was called
+    const detail::Environment &environment();
+
+    /// Shares a snapshot of the environment variables with this parser and its subparsers
+    void share_environment(const std::shared_ptr<const detail::Environment> &environment);
 
-    /// Checks the parsed arguments against the registered options
-    void cross_check(Args &&args);
+    /// Copies a value into [out], expanding "${NAME}" if [expand_]
+    void assign(std::string &out, const char *data, const std::size_t size);
 
-    /// Checks if all the required options have been provided
+    /// @{ Values of lazy options as they are recorded, expanded into [expanded_] if [expand_] and they hold a "$"
+    detail::Span expand_lazy(const char *data, const std::size_t size);
+    const std::vector<detail::Span> &expand_lazy(const std::vector<detail::Span> &values);
+    /// @}
+
+    /// Shares a config file with this parser and its subparsers
+    void share_config_file(const std::shared_ptr<const detail::ConfigFile> &file);
+
+    /// Maps the entries of the config file in [section_] to the options they name, if not done since the last change
+    /// Keys that name no option are ignored, and the last of repeated keys wins
+    void resolve_config_file();
+
+    /// \return The value of the entry of an option in the config file, "true" for a boolean without "="
+    pstd::optional<detail::Span> config_value(const std::size_t id) const;
+
+    /// Sets an option that is not given from the value of its environment variable or config file entry
+    /// \return False if the value is not allowed
+    bool set_from_source(Option &option, const std::size_t id, const detail::Span &value);
+
+    /// \return Ids of the registered options closest to a name that is not registered, closest first
+    std::vector<std::size_t> suggest(const char *name, const std::size_t size);
+
+    /// \return The completion indexes, built if the options changed since they were last built
+    const detail::Completions &completions();
+
+    /// Appends the allowed values of an option that start with [prefix] to [out]
+    /// Values of multivalent options complete after the last comma of [prefix]
+    void complete_values(const std::size_t id, const std::string &prefix, std::string lead, std::vector<std::string> &out);
+
+    /// Takes a fresh [generation_], so the schema is described again on the next cached parse
+    void bump_generation();
+
+    /// \return The generations of this parser and its subparsers folded together, which changes with the schema
+    uint64_t schema_generation() const;
+
+    /// Appends a description of every option and setting of this parser and its subparsers to [out]
+    void describe(std::string &out) const;
+
+    /// Hashes the environment variables of the options of this parser and its subparsers into [hash]
+    uint64_t hash_environment(uint64_t hash);
+
+    /// Builds [key_] from the schema, the sources of values, and the arguments after the program
+    void cache_key(const std::vector<detail::Token> &tokens);
+
+    /// @{ Saves the result of the last parse, and restores one, following the selected subparsers
+    void save(detail::SnapshotWriter &out) const;
+    const std::vector<std::string> &restore(detail::SnapshotReader &in);
+    /// @}
+
+    /// \return If the last parse, or that of the selected subparser, failed
+    bool failed() const;
+
+    /// Checks a single value of an option while validating
+    /// \param element Index of the value among those of an option with a fixed number of values
+    /// \return        The problem with the value, if any
+    pstd::optional<Diagnostic::Error> check_value(const Option &option, const char *data, const std::size_t size, const std::size_t element = 0);
+
+    /// Records the values of a lazy option, and converts them right away if the option is required and [strict_]
+    /// \return False if the values were converted but are not allowed
+    bool defer(Option &option, const std::vector<detail::Span> &values);
+
+    /// Checks if all the required options have been provided, and that no constraint is violated
     bool check_requirements() const;
 
     /// Set the default callbacks into [cbs_]
     void set_default_callbacks();
+
+    /// Set the default callbacks that print diagnostics into [cbs_], or ones that print nothing if [quiet_]
+    void set_printing_callbacks();
+
+    /// Prints the usage, the description and the table of the options
+    void print_help() const;
 };
 
+/// Implementation
+#include "argparse.ipp"
+
 } // namespace argparse
@@ -0,0 +1,107 @@
+template <typename E>
+ConstPlaceHolder<E> Parser::add_choice(Config<E> config, const std::vector<std::pair<std::string, E>> &choices) {
+    static_assert(std::is_enum<E>::value, "Choices must stand for values of an enum");
+
+    // The choices are the allowed values
+    if (!config.allowed_values.empty()) {
+        throw InvalidConfig{};
+    }
+
+    auto value = std::make_shared<detail::ChoiceValue<E>>();
+    std::vector<std::string> spellings;
+    spellings.reserve(choices.size());
+    value->values.reserve(choices.size());
+    for (const auto &choice : choices) {
+        spellings.push_back(choice.first);
+        value->values.push_back(choice.second);
+    }
+    value->spellings = detail::PerfectHash(spellings);
+    value->assign = [](detail::ChoiceIndex &index, const pstd::optional<std::size_t> choice) {
+        auto &self = static_cast<detail::ChoiceValue<E> &>(index);
+        if (choice.has_value()) {
+            *self.placeholder = self.values[choice.value()];
+        } else {
+            self.placeholder->reset();
+        }
+    };
+
+    Config<std::string> spelled{
+        .default_value = {},
+        .allowed_values = {spellings.begin(), spellings.end()},
+        .name = std::move(config.name),
+        .help = std::move(config.help),
+        .required = config.required,
+        .letter = config.letter,
+        .env = std::move(config.env),
+    };
+
+    // The default is shown by its spelling
+    if (config.default_value.has_value()) {
+        const auto found = std::find(value->values.begin(), value->values.end(), config.default_value.value());
+        if (found == value->values.end()) {
+            throw InvalidConfig{};
+        }
+        value->default_index = static_cast<std::size_t>(found - value->values.begin());
+        spelled.default_value = spellings[value->default_index.value()];
+    }
+
+    add_choice(std::move(spelled), value);
+    return value->placeholder;
+}
+
+template <typename T, std::size_t N>
+ConstPlaceHolder<std::array<T, N>> Parser::add_array(Config<T> config, pstd::optional<std::array<T, N>> default_value) {
+    static_assert(supported<T>(), "Values of an array must be of a supported type");
+    static_assert(N > 0, "An array takes at least one value");
+
+    // The default is the whole array
+    if (config.default_value.has_value()) {
+        throw InvalidConfig{};
+    }
+
+    using V = std::array<T, N>;
+    auto value = std::make_shared<detail::TupleValue<V>>();
+    value->allowed_values = typename detail::AllowedElements<V>::type(config.allowed_values);
+    value->default_value = std::move(default_value);
+
+    // The allowed values of every element are shown by their spelling
+    Config<std::string> spelled{
+        .default_value = {},
+        .allowed_values = {},
+        .name = std::move(config.name),
+        .help = std::move(config.help),
+        .required = config.required,
+        .letter = config.letter,
+        .env = std::move(config.env),
+    };
+    for (const auto &allowed : config.allowed_values) {
+        spelled.allowed_values.insert(Variant{allowed}.string());
+    }
+    if (value->default_value.has_value()) {
+        spelled.default_value = detail::TupleValue<V>::spell(value->default_value.value());
+    }
+
+    add_tuple(std::move(spelled), value);
+    return value->placeholder;
+}
+
+template <typename... Ts>
+ConstPlaceHolder<std::tuple<Ts...>> Parser::add_tuple(Config<std::string> config, detail::NotDeduced<pstd::optional<std::tuple<Ts...>>> default_value) {
+    static_assert(sizeof...(Ts) > 0, "A tuple takes at least one value");
+    static_assert(std::min({supported<Ts>()...}), "Values of a tuple must be of supported types");
+
+    // The default is the whole tuple, and elements of different types have no allowed values
+    if (config.default_value.has_value() || !config.allowed_values.empty()) {
+        throw InvalidConfig{};
+    }
+
+    using V = std::tuple<Ts...>;
+    auto value = std::make_shared<detail::TupleValue<V>>();
+    value->default_value = std::move(default_value);
+    if (value->default_value.has_value()) {
+        config.default_value = detail::TupleValue<V>::spell(value->default_value.value());
+    }
+
+    add_tuple(std::move(config), value);
+    return value->placeholder;
+}
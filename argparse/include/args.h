@@ -1,30 +1,97 @@
 #pragma once
 
-#include <string>
-#include <unordered_map>
+#include "span.h"
+
+#include <cstddef>
+#include <limits>
 #include <vector>
 
 namespace argparse {
 
-/// Wrapper / interface over a map of parsed arguments
-class Args {
-    using Values = std::vector<std::string>;
+/// Denotes the absence of an index into the input arguments
+constexpr std::size_t kNoIndex = std::numeric_limits<std::size_t>::max();
 
+/// Arguments parsed against a set of registered options
+/// Every registered option has a slot, indexed by the id it was registered with
+/// Spans point into the input arguments, and all buffers keep their capacity between parses
+class Args {
   public:
-    void create(const std::string &key) { string_map_[key]; }
-    void create(const std::string &key, Values &&value) { string_map_[key] = std::move(value); }
-    void insert(const std::string &key, std::string &&value) { string_map_[key].push_back(std::move(value)); }
-    bool exists(const std::string &key) const { return string_map_.find(key) != string_map_.end(); }
-    const Values &get(const std::string &key) const { return string_map_.at(key); }
-    std::size_t size() const { return string_map_.size(); }
-
-    auto begin() const { return string_map_.begin(); }
-    auto end() const { return string_map_.end(); }
-    auto begin() { return string_map_.begin(); }
-    auto end() { return string_map_.end(); }
+    /// Values of a single option
+    struct Slot {
+        bool present = false;                  /// If the option appeared in the input arguments
+        std::size_t index = kNoIndex;          /// Index of the input argument where the option first appeared
+        std::size_t surplus = kNoIndex;        /// Index of the first value beyond the number the option accepts
+        std::vector<detail::Span> values{};    /// Values in the order they appeared
+    };
+
+    /// Clears the results of the previous parse
+    /// \param num_options Number of registered options
+    void reset(const std::size_t num_options) {
+        for (const auto id : order_) {
+            auto &slot = slots_[id];
+            slot.present = false;
+            slot.index = kNoIndex;
+            slot.surplus = kNoIndex;
+            slot.values.clear();
+        }
+        order_.clear();
+        if (slots_.size() < num_options) {
+            slots_.resize(num_options);
+        }
+        positionals_.clear();
+        remaining_.clear();
+        unknown_.clear();
+        unknown_names_.clear();
+    }
+
+    /// Marks an option as present, the first appearance is kept
+    /// \return The slot of the option
+    Slot &mark(const std::size_t id, const std::size_t index) {
+        auto &slot = slots_[id];
+        if (!slot.present) {
+            slot.present = true;
+            slot.index = index;
+            order_.push_back(id);
+        }
+        return slot;
+    }
+
+    /// @{ Records arguments that do not belong to a registered option
+    void add_positional(const detail::Span s) { positionals_.push_back(s); }
+    void add_remaining(const detail::Span s) { remaining_.push_back(s); }
+    void add_unknown(const std::size_t index, const detail::Span name) {
+        unknown_.push_back(index);
+        unknown_names_.push_back(name);
+    }
+    /// @}
+
+    /// @{ Accessors of the parsed arguments
+    const Slot &slot(const std::size_t id) const { return slots_[id]; }
+    const std::vector<std::size_t> &order() const { return order_; }
+    const std::vector<detail::Span> &positionals() const { return positionals_; }
+    const std::vector<detail::Span> &remaining() const { return remaining_; }
+    const std::vector<std::size_t> &unknown() const { return unknown_; }
+    const std::vector<detail::Span> &unknown_names() const { return unknown_names_; }
+    /// @}
 
   private:
-    std::unordered_map<std::string, Values> string_map_;
+    /// Slot of every registered option, indexed by id
+    std::vector<Slot> slots_;
+
+    /// Ids of the options that were present, in the order they first appeared
+    std::vector<std::size_t> order_;
+
+    /// Arguments before any option, these are positional arguments
+    std::vector<detail::Span> positionals_;
+
+    /// Arguments after the "--" splitter
+    std::vector<detail::Span> remaining_;
+
+    /// Indices of the input arguments that looked like options but are not registered
+    std::vector<std::size_t> unknown_;
+
+    /// Names of the options that are not registered, without the hyphens or a value, in the same order as [unknown_]
+    std::vector<detail::Span> unknown_names_;
 };
 
 } // namespace argparse
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace argparse {
+namespace detail {
+
+/// Set of option ids, one bit per id
+/// Masks of different lengths can be combined, the missing words of the shorter mask are zero
+class Bitmask {
+  public:
+    Bitmask() = default;
+
+    /// \param bits Number of ids the mask holds without growing
+    explicit Bitmask(const std::size_t bits) : words_(words(bits), 0) {}
+
+    /// Clears every bit and makes room for [bits] ids, without releasing memory
+    void assign(const std::size_t bits) {
+        words_.assign(words(bits), 0);
+    }
+
+    /// @{ Single bit access, [set] grows the mask if needed
+    void set(const std::size_t id) {
+        if (id / kBits >= words_.size()) {
+            words_.resize(id / kBits + 1, 0);
+        }
+        words_[id / kBits] |= bit(id);
+    }
+    void reset(const std::size_t id) {
+        if (id / kBits < words_.size()) {
+            words_[id / kBits] &= ~bit(id);
+        }
+    }
+    bool test(const std::size_t id) const {
+        return (id / kBits < words_.size()) && ((words_[id / kBits] & bit(id)) != 0);
+    }
+    /// @}
+
+    /// \return The number of set bits
+    std::size_t count() const {
+        std::size_t total = 0;
+        for (const auto word : words_) {
+            total += popcount(word);
+        }
+        return total;
+    }
+
+    /// \return The number of bits set in both masks
+    std::size_t count_and(const Bitmask &other) const {
+        const std::size_t size = std::min(words_.size(), other.words_.size());
+        std::size_t total = 0;
+        for (std::size_t ii = 0; ii < size; ii++) {
+            total += popcount(words_[ii] & other.words_[ii]);
+        }
+        return total;
+    }
+
+    /// \return True if every bit set in this mask is also set in [other]
+    bool subset_of(const Bitmask &other) const {
+        for (std::size_t ii = 0; ii < words_.size(); ii++) {
+            const uint64_t word = (ii < other.words_.size()) ? other.words_[ii] : 0;
+            if ((words_[ii] & ~word) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Invokes [f] with the id of every set bit, in increasing order
+    template <typename Function>
+    void for_each(Function &&f) const {
+        for (std::size_t ii = 0; ii < words_.size(); ii++) {
+            for_each_bit(ii, words_[ii], f);
+        }
+    }
+
+    /// Invokes [f] with the id of every bit set in this mask but not in [other], in increasing order
+    template <typename Function>
+    void for_each_missing(const Bitmask &other, Function &&f) const {
+        for (std::size_t ii = 0; ii < words_.size(); ii++) {
+            const uint64_t word = (ii < other.words_.size()) ? other.words_[ii] : 0;
+            for_each_bit(ii, words_[ii] & ~word, f);
+        }
+    }
+
+    /// Invokes [f] with the id of every bit set in both masks, in increasing order
+    template <typename Function>
+    void for_each_common(const Bitmask &other, Function &&f) const {
+        const std::size_t size = std::min(words_.size(), other.words_.size());
+        for (std::size_t ii = 0; ii < size; ii++) {
+            for_each_bit(ii, words_[ii] & other.words_[ii], f);
+        }
+    }
+
+  private:
+    /// Number of ids per word
+    static constexpr std::size_t kBits = 64;
+
+    /// Bits of the ids, bit N of word W is id W * 64 + N
+    std::vector<uint64_t> words_;
+
+    static std::size_t words(const std::size_t bits) { return (bits + kBits - 1) / kBits; }
+    static uint64_t bit(const std::size_t id) { return uint64_t{1} << (id % kBits); }
+    static std::size_t popcount(const uint64_t word) { return static_cast<std::size_t>(__builtin_popcountll(word)); }
+
+    template <typename Function>
+    static void for_each_bit(const std::size_t index, uint64_t word, Function &f) {
+        while (word != 0) {
+            f(index * kBits + static_cast<std::size_t>(__builtin_ctzll(word)));
+            word &= word - 1;
+        }
+    }
+};
+
+} // namespace detail
+} // namespace argparse
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "perfect_hash.h"
+#include "placeholder.h"
+#include "std_optional.h"
+
+#include <memory>
+#include <vector>
+
+namespace argparse {
+namespace detail {
+
+/// The part of an option with choices that does not depend on the enum, see [Parser::add_choice]
+struct ChoiceIndex {
+    /// Spellings of the choices, the index of a spelling is the index of its value
+    PerfectHash spellings;
+
+    /// Index of the default choice, if there is one
+    pstd::optional<std::size_t> default_index;
+
+    /// Index of the chosen value, if there is one
+    pstd::optional<std::size_t> chosen;
+
+    /// Sets the value to the choice at [index], or to no value if [index] is empty
+    void (*assign)(ChoiceIndex &choices, const pstd::optional<std::size_t> index) = nullptr;
+};
+
+/// Values of the choices of an option, and the value chosen
+template <typename E>
+struct ChoiceValue : ChoiceIndex {
+    /// The value chosen
+    PlaceHolder<E> placeholder = std::make_shared<PlaceHolderType<E>>();
+
+    /// Value of each choice, in the order of the spellings
+    std::vector<E> values;
+};
+
+} // namespace detail
+} // namespace argparse
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace argparse {
+namespace detail {
+
+/// Classification of a single input argument
+struct Token {
+    /// Flags describing the argument
+    enum Flag : uint8_t {
+        kOption = 1U << 0U,         /// Starts with '-' and is not a negative number
+        kLongPrefix = 1U << 1U,     /// Starts with "--"
+        kSplitter = 1U << 2U,       /// Is exactly "--"
+        kNegativeNumber = 1U << 3U, /// Starts with '-' followed by a digit
+    };
+
+    const char *data = nullptr; /// Start of the argument
+    std::size_t size = 0;       /// Length of the argument
+    std::size_t equals = 0;     /// Offset of the first '=', or [size] if there is none
+    uint8_t flags = 0;          /// Combination of [Flag]
+
+    /// \return Number of hyphens prefixing an option
+    std::size_t prefix() const noexcept {
+        return ((flags & kLongPrefix) != 0) ? 2 : 1;
+    }
+};
+
+/// Splits the input arguments into tokens and classifies each
+/// On Linux the kernel lays out the argument strings back to back in one block, in which case the whole block is
+/// swept a vector at a time for the NUL terminators and '=' characters, instead of scanning each argument separately
+/// The layout is verified while sweeping, and anything else falls back to scanning each argument
+class Classifier {
+  public:
+    /// Classifies the input arguments
+    /// \return One token per argument, valid until the next call and for as long as [argv] is
+    const std::vector<Token> &classify(const int argc, const char **argv);
+
+    /// Classifies a block of NUL separated arguments, such as the contents of /proc/<pid>/cmdline
+    /// The last argument may be missing its terminator, in which case it ends with the block
+    /// \return One token per argument, valid until the next call and for as long as [data] is
+    const std::vector<Token> &classify(const char *data, const std::size_t size);
+
+    /// Classifies a single NUL terminated argument on its own
+    static Token classify(const char *arg);
+
+    /// \return If the last [classify] swept the arguments as a contiguous block
+    bool swept() const noexcept {
+        return swept_;
+    }
+
+  private:
+    /// Tokens of the last [classify]
+    std::vector<Token> tokens_;
+
+    /// If the last [classify] swept the arguments as a contiguous block
+    bool swept_ = false;
+
+    /// Sweeps arguments laid out back to back
+    /// \param begin Start of the first argument
+    /// \param end   End of the block, or nullptr to stop after [argc] arguments
+    /// \param argc  Number of arguments, only used without [end]
+    /// \param argv  Expected start of each argument, only used without [end]
+    /// \return      False if the arguments are not back to back, in which case [tokens_] is incomplete
+    bool sweep(const char *begin, const char *end, const std::size_t argc, const char **argv);
+
+    /// Scans each argument separately
+    void scan(const std::size_t argc, const char **argv);
+
+    /// Appends a token
+    void add(const char *data, const std::size_t size, const std::size_t equals) {
+        tokens_.push_back(make(data, size, equals));
+    }
+
+    /// \return A token with its flags determined
+    static Token make(const char *data, const std::size_t size, const std::size_t equals);
+};
+
+} // namespace detail
+} // namespace argparse
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "argparse.h"
+
+#include <sys/types.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace argparse {
+
+/// Result of reading and parsing the command line of one process
+template <typename T>
+struct CmdlineResult {
+    pid_t pid = 0;       /// The process
+    int error = 0;       /// [errno] of reading /proc/<pid>/cmdline, 0 if it was read
+    bool parsed = false; /// If the command line was read and the schema accepted it
+    T value{};           /// Values extracted after parsing, only meaningful if [parsed]
+};
+
+namespace detail {
+
+/// Reads the command lines of other processes for a single thread
+/// /proc is opened once and every command line is opened relative to it, instead of resolving the full path each time
+/// The buffer grows to the longest command line read so far and is kept
+class CmdlineReader {
+  public:
+    CmdlineReader();
+    ~CmdlineReader();
+
+    CmdlineReader(const CmdlineReader &) = delete;
+    CmdlineReader(CmdlineReader &&) = delete;
+    CmdlineReader &operator=(const CmdlineReader &) = delete;
+    CmdlineReader &operator=(CmdlineReader &&) = delete;
+
+    /// Reads /proc/<pid>/cmdline into the buffer
+    /// \return 0 if read, otherwise the [errno] of the failure and the command line is empty
+    int read(const pid_t pid);
+
+    /// @{ The command line of the last [read], NUL separated arguments
+    const char *data() const noexcept { return buffer_.data(); }
+    std::size_t size() const noexcept { return size_; }
+    /// @}
+
+  private:
+    /// Handle to /proc, or -1 if it could not be opened
+    int proc_ = -1;
+
+    /// [errno] of opening /proc
+    int proc_error_ = 0;
+
+    /// Contents of the last command line, and its length
+    std::vector<char> buffer_;
+    std::size_t size_ = 0;
+};
+
+} // namespace detail
+
+/// Reads the command lines of other processes and parses them with the options their binaries register, in parallel
+/// Each worker thread owns a [Parser] built once from the schema, a handle to /proc and a buffer, reused for every process
+/// Failures to parse are reported per process, the worker parsers are quiet so nothing is printed
+/// \code{.cpp}
+///   struct Flags { int32_t port; bool verbose; };
+///   CmdlineScanner<Flags> scanner([](Parser &parser) {
+///       auto port = parser.add<int32_t>("port", "Port to listen on");
+///       auto verbose = parser.add<bool>("verbose", "Verbose logging");
+///       return [port, verbose] { return Flags{port->value_or(0), verbose->value_or(false)}; };
+///   });
+///   for (const auto &result : scanner.scan(pids)) {
+///       ...
+///   }
+/// \endcode
+template <typename T>
+class CmdlineScanner {
+  public:
+    /// Extracts the values from the placeholders after a parse
+    using Extract = std::function<T()>;
+
+    /// Registers the options of the schema, and returns how to extract the values after each parse
+    using Schema = std::function<Extract(Parser &parser)>;
+
+    /// \param schema  Called once for each worker
+    /// \param workers Number of worker threads, 0 for one per hardware thread
+    explicit CmdlineScanner(const Schema &schema, std::size_t workers = 0);
+
+    /// Reads and parses the command line of every process
+    /// \return One result per process, in the same order as [pids]
+    std::vector<CmdlineResult<T>> scan(const std::vector<pid_t> &pids);
+
+  private:
+    /// Number of processes a worker takes at a time
+    static constexpr std::size_t kBatchSize = 32;
+
+    /// State owned by one worker thread
+    struct Worker {
+        Parser parser;
+        Extract extract;
+        detail::CmdlineReader reader;
+    };
+
+    /// One worker per thread
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    /// Takes batches of processes until there are none left
+    static void run(Worker &worker, const std::vector<pid_t> &pids, std::vector<CmdlineResult<T>> &results,
+                    std::atomic<std::size_t> &next);
+};
+
+template <typename T>
+constexpr std::size_t CmdlineScanner<T>::kBatchSize;
+
+template <typename T>
+CmdlineScanner<T>::CmdlineScanner(const Schema &schema, std::size_t workers) {
+    if (workers == 0) {
+        workers = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    for (std::size_t ii = 0; ii < workers; ii++) {
+        auto worker = std::make_unique<Worker>();
+
+        // Report failures through the results instead, the exit callback still ends the parse
+        worker->parser.set_quiet(true);
+
+        worker->extract = schema(worker->parser);
+        workers_.push_back(std::move(worker));
+    }
+}
+
+template <typename T>
+std::vector<CmdlineResult<T>> CmdlineScanner<T>::scan(const std::vector<pid_t> &pids) {
+    std::vector<CmdlineResult<T>> results(pids.size());
+    std::atomic<std::size_t> next{0};
+
+    // No more threads than there are batches, the calling thread is the first worker
+    const std::size_t batches = (pids.size() + kBatchSize - 1) / kBatchSize;
+    const std::size_t workers = std::max<std::size_t>(1, std::min(workers_.size(), batches));
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (std::size_t ii = 1; ii < workers; ii++) {
+        threads.emplace_back(&CmdlineScanner::run, std::ref(*workers_[ii]), std::cref(pids), std::ref(results), std::ref(next));
+    }
+    run(*workers_[0], pids, results, next);
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    return results;
+}
+
+template <typename T>
+void CmdlineScanner<T>::run(Worker &worker, const std::vector<pid_t> &pids, std::vector<CmdlineResult<T>> &results,
+                            std::atomic<std::size_t> &next) {
+    while (true) {
+        const std::size_t begin = next.fetch_add(kBatchSize, std::memory_order_relaxed);
+        if (begin >= pids.size()) {
+            return;
+        }
+
+        const std::size_t end = std::min(begin + kBatchSize, pids.size());
+        for (std::size_t ii = begin; ii < end; ii++) {
+            auto &result = results[ii];
+            result.pid = pids[ii];
+            result.error = worker.reader.read(result.pid);
+            if (result.error != 0) {
+                continue;
+            }
+
+            try {
+                worker.parser.parse(worker.reader.data(), worker.reader.size());
+                result.value = worker.extract();
+                result.parsed = true;
+            } catch (const std::exception &) {
+                result.parsed = false;
+            }
+        }
+    }
+}
+
+} // namespace argparse
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace argparse {
+namespace detail {
+
+/// Words sorted once, so the words starting with a prefix are found with a binary search instead of a scan
+/// The words are kept in one buffer and sorted by a most significant byte radix sort, which walks the words as a trie
+/// would, so sorting thousands of words that share long prefixes reads each byte about once instead of comparing strings
+class SortedWords {
+  public:
+    SortedWords() = default;
+
+    /// Sorts the words, and removes repeated ones
+    explicit SortedWords(const std::vector<std::string> &words);
+
+    /// Makes room for [count] more words
+    void reserve(const std::size_t count) { words_.reserve(words_.size() + count); }
+
+    /// Adds a word, [prefix] and [data] together, the words must be sorted again before completing
+    void add(const char *prefix, const char *data, const std::size_t size);
+
+    /// Sorts the words added, and removes repeated ones
+    void sort();
+
+    /// Appends every word starting with [prefix] to [out], in order
+    /// \param lead Put before each word appended, such as "--name=" for values completed in the same argument
+    void complete(const std::string &prefix, const std::string &lead, std::vector<std::string> &out) const;
+
+    /// \return Number of words
+    std::size_t size() const noexcept { return words_.size(); }
+
+  private:
+    /// A word in [text_]
+    struct Word {
+        uint32_t offset; /// Start in [text_]
+        uint32_t size;   /// Length
+    };
+
+    /// Text of every word
+    std::string text_;
+
+    /// The words
+    std::vector<Word> words_;
+
+    /// Sorts [begin, end), whose words are the same before [depth]
+    void sort(Word *begin, Word *end, std::size_t depth, std::vector<Word> &scratch) const;
+};
+
+/// Indexes of the options of a parser for completion
+struct Completions {
+    std::size_t options = 0;                              /// Number of options when built
+    SortedWords names;                                    /// "--name" and "-x" of every option that is not positional
+    std::unordered_map<std::size_t, SortedWords> values;  /// Allowed values of each option, by id, built when first asked for
+};
+
+} // namespace detail
+} // namespace argparse
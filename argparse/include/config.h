@@ -1,6 +1,8 @@
 #pragma once
 
+#include "address.h"
 #include "std_optional.h"
+#include "units.h"
 
 #include <string>
 #include <unordered_set>
@@ -10,15 +12,33 @@ namespace argparse {
 /// Denotes the letter should not be considered and the name should be considered
 constexpr char kUnusedChar = 0;
 
+namespace detail {
+
+/// Set of the allowed values of an option of type [T]
+/// Addresses are allowed by the blocks that contain them, so both addresses and blocks have blocks as allowed values
+template <typename T>
+struct AllowedSet {
+    using type = std::unordered_set<T, Hash<T>>;
+};
+template <>
+struct AllowedSet<IpAddress> {
+    using type = std::unordered_set<Cidr, Hash<Cidr>>;
+};
+
+} // namespace detail
+
 /// Configuration of the option
 template <typename T>
 struct Config {
+    using AllowedValues = typename detail::AllowedSet<T>::type;
+
     pstd::optional<T> default_value{};      /// Optional default value
-    std::unordered_set<T> allowed_values{}; /// Set of allowed values the option can be
+    AllowedValues allowed_values{};         /// Set of allowed values the option can be, see [detail::AllowedSet]
     std::string name{};                     /// Name of the option, multicharacter string
     std::string help{};                     /// Optional help message
     bool required = false;                  /// Should enforce requirement of the option
     char letter = kUnusedChar;              /// Character of the option, if != kUnusedChar
+    std::string env{};                      /// Environment variable that supplies the value if the option is not given
 };
 
 } // namespace argparse
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "span.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace argparse {
+namespace detail {
+
+/// A file of "name = value" lines, read once into a buffer of its own and parsed in place
+/// Lines before any "[section]" are for the parser itself, lines after a "[section]" are for the subparser of that name
+/// A name without "=" is a boolean that is given, lines starting with '#' or ';' are comments, and whitespace around names
+/// and values is ignored, as are double quotes around a value
+/// The entries point into the buffer, which lives as long as this object
+/// The file is copied instead of mapped, so writing or truncating it later never changes nor faults the entries
+class ConfigFile {
+  public:
+    /// A "name = value" line
+    struct Entry {
+        Span section;      /// Section the line is in, empty before the first section
+        Span name;         /// Name or letter of the option
+        Span value;        /// Value, empty if there is no "="
+        std::size_t line;  /// Line number, starting at 1
+        bool assigned;     /// If the line has a "="
+    };
+
+    /// Reads and parses a file
+    /// \throws std::system_error if the file can not be read, std::invalid_argument if a line is not an entry
+    explicit ConfigFile(const std::string &path);
+
+    /// Parses text in place, the text must outlive this object
+    /// \throws std::invalid_argument if a line is not an entry
+    ConfigFile(const char *data, const std::size_t size);
+
+    ConfigFile(const ConfigFile &) = delete;
+    ConfigFile &operator=(const ConfigFile &) = delete;
+
+    /// \return Every entry, in the order of the file
+    const std::vector<Entry> &entries() const noexcept { return entries_; }
+
+  private:
+    /// Contents of the file, empty if parsed from text the caller owns
+    std::string text_;
+
+    /// Every entry, in the order of the file
+    std::vector<Entry> entries_;
+
+    /// Splits the text into entries
+    void parse(const char *data, const std::size_t size);
+};
+
+} // namespace detail
+} // namespace argparse
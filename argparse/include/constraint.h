@@ -0,0 +1,29 @@
+#pragma once
+
+namespace argparse {
+
+/// Rules between options, checked after parsing from which options were given
+enum class Constraint {
+    kMutuallyExclusive, /// At most one option of the group is given
+    kAllOrNone,         /// Either every option of the group is given, or none are
+    kAtLeastOne,        /// At least one option of the group is given
+    kRequires,          /// If the option is given, every option it requires is given too
+    kConflicts,         /// If the option is given, none of the options it conflicts with are given
+};
+
+/// Convert [Constraint] to string
+constexpr const char * enum_to_str(const Constraint constraint) {
+    switch (constraint) {
+    case Constraint::kMutuallyExclusive : return "mutually exclusive"; break;
+    case Constraint::kAllOrNone         : return "all or none";        break;
+    case Constraint::kAtLeastOne        : return "at least one";       break;
+    case Constraint::kRequires          : return "requires";           break;
+    case Constraint::kConflicts         : return "conflicts with";     break;
+    default:
+        break;
+    }
+
+    return nullptr;
+}
+
+} // namespace argparse
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "address.h"
+#include "cpu_set.h"
 #include "std_optional.h"
+#include "units.h"
 
 #include <string>
 
@@ -26,6 +29,12 @@ template <> inline uint8_t convert_helper(const std::string &input) { return std
 template <> inline int8_t convert_helper(const std::string &input) { return std::stol(input); }
 template <> inline bool convert_helper(const std::string &input) { return (input == "true" || input == "True"); }
 template <> inline char convert_helper(const std::string &input) { return input.empty() ? '\0' : input[0]; }
+template <> inline Bytes convert_helper(const std::string &input) { return parse_bytes(input.data(), input.size()); }
+template <> inline Duration convert_helper(const std::string &input) { return parse_duration(input.data(), input.size()); }
+template <> inline Rate convert_helper(const std::string &input) { return parse_rate(input.data(), input.size()); }
+template <> inline CpuSet convert_helper(const std::string &input) { return parse_cpu_set(input.data(), input.size()); }
+template <> inline IpAddress convert_helper(const std::string &input) { return parse_ip_address(input.data(), input.size()); }
+template <> inline Cidr convert_helper(const std::string &input) { return parse_cidr(input.data(), input.size()); }
 
 template <> inline std::string convert_helper(const double &input) { return std::to_string(input); }
 template <> inline std::string convert_helper(const float &input) { return std::to_string(input); }
@@ -39,6 +48,12 @@ template <> inline std::string convert_helper(const uint8_t &input) { return std
 template <> inline std::string convert_helper(const int8_t &input) { return std::to_string(input); }
 template <> inline std::string convert_helper(const bool &input) { return (input) ? "true" : "false"; }
 template <> inline std::string convert_helper(const char &input) { return std::string(1, input); }
+template <> inline std::string convert_helper(const Bytes &input) { return format(input); }
+template <> inline std::string convert_helper(const Duration &input) { return format(input); }
+template <> inline std::string convert_helper(const Rate &input) { return format(input); }
+template <> inline std::string convert_helper(const CpuSet &input) { return format(input); }
+template <> inline std::string convert_helper(const IpAddress &input) { return format(input); }
+template <> inline std::string convert_helper(const Cidr &input) { return format(input); }
 
 } // namespace detail
 } // namespace argparse
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace argparse {
+
+/// A set of CPUs, or of any small numbers such as NUMA nodes, given as a list of ranges such as "0-15,32-47"
+/// Number n is bit n % 64 of word n / 64, which is the layout of [cpu_set_t] on 64 bit Linux, so the words can be
+/// handed to the kernel as they are:
+/// \code{.cpp}
+///   sched_setaffinity(0, cpus.bytes(), reinterpret_cast<const cpu_set_t *>(cpus.data()));
+/// \endcode
+struct CpuSet {
+    /// Bits of the numbers, without trailing words of zeros, so equal sets have equal words
+    std::vector<uint64_t> words;
+
+    /// \return If [n] is in the set
+    bool test(const std::size_t n) const noexcept {
+        return (n / 64 < words.size()) && (((words[n / 64] >> (n % 64)) & 1U) != 0);
+    }
+
+    /// \return The number of numbers in the set
+    std::size_t count() const noexcept {
+        std::size_t total = 0;
+        for (const auto word : words) {
+            total += static_cast<std::size_t>(__builtin_popcountll(word));
+        }
+        return total;
+    }
+
+    /// \return If the set has no numbers
+    bool empty() const noexcept { return words.empty(); }
+
+    /// @{ The words of the mask, and their size in bytes, as [sched_setaffinity] and [CPU_ALLOC] masks expect
+    const uint64_t *data() const noexcept { return words.data(); }
+    std::size_t bytes() const noexcept { return words.size() * sizeof(uint64_t); }
+    /// @}
+
+    /// Invokes [f] with every number in the set, in increasing order
+    template <typename Function>
+    void for_each(Function &&f) const {
+        for (std::size_t ii = 0; ii < words.size(); ii++) {
+            for (uint64_t word = words[ii]; word != 0; word &= word - 1) {
+                f(ii * 64 + static_cast<std::size_t>(__builtin_ctzll(word)));
+            }
+        }
+    }
+};
+
+/// @{ Equality compares the numbers in the sets, "0-3" is equal to "0,1,2,3"
+inline bool operator==(const CpuSet &lhs, const CpuSet &rhs) { return lhs.words == rhs.words; }
+inline bool operator!=(const CpuSet &lhs, const CpuSet &rhs) { return !(lhs == rhs); }
+/// @}
+
+namespace detail {
+
+/// Largest number of a [CpuSet], well above the CPUs of any machine, so a typo can not make a mask of gigabytes
+constexpr std::size_t kMaxCpu = 65535;
+
+/// Parses a list of items separated by commas, each being one of
+///   - "n", the number n
+///   - "a-b", the numbers from a to b, both included
+///   - "a-b:s", every s-th number from a, such as "0-63:2" for the even numbers below 64
+///   - "^" before any of the above, which excludes the numbers from the others whatever the order, as in "0-15,^3"
+/// Bits are set straight into the words, a word at a time for plain ranges, without listing the numbers or the items
+/// An empty list is an empty set
+/// \throws std::invalid_argument if the list is malformed, or a range ends before it starts
+/// \throws std::out_of_range if a number is above [kMaxCpu]
+CpuSet parse_cpu_set(const char *data, const std::size_t size);
+
+/// Formats a set as the shortest list of numbers and ranges, such as "0-15,32-47", the inverse of [parse_cpu_set]
+std::string format(const CpuSet &cpus);
+
+} // namespace detail
+} // namespace argparse
+
+namespace std {
+
+template <>
+struct hash<argparse::CpuSet> {
+    std::size_t operator()(const argparse::CpuSet &cpus) const {
+        std::size_t hash = cpus.words.size();
+        for (const auto word : cpus.words) {
+            hash = hash * 31 + std::hash<uint64_t>{}(word);
+        }
+        return hash;
+    }
+};
+
+} // namespace std
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "span.h"
+#include "std_optional.h"
+#include "string_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace argparse {
+namespace detail {
+
+/// Snapshot of environment variables, indexed by name
+/// The variables are copied and indexed once, so looking one up is a hash and a comparison instead of a scan of the
+/// environment, and later changes to the environment are not seen
+class Environment {
+  public:
+    /// \param envp Array of "NAME=value" strings ending with a null pointer, such as [environ]
+    explicit Environment(const char *const *envp);
+
+    /// \return The snapshot of the environment of the process, taken on the first call and shared by every parser
+    static const std::shared_ptr<const Environment> &process();
+
+    /// \return The value of a variable, valid for as long as the snapshot, if the variable is set
+    pstd::optional<Span> find(const char *name, const std::size_t size) const;
+    pstd::optional<Span> find(const std::string &name) const { return find(name.data(), name.size()); }
+
+    /// Copies characters into [out], replacing every "${NAME}" by the value of the variable, or nothing if it is not set
+    /// A "$" that does not start a "${NAME}" is copied as it is
+    void expand(const char *data, const std::size_t size, std::string &out) const;
+
+    /// \return Number of variables
+    std::size_t size() const noexcept { return variables_.size(); }
+
+  private:
+    /// A variable, as offsets into [text_]
+    struct Variable {
+        PooledString name;
+        PooledString value;
+    };
+
+    /// Names and values of every variable, each followed by a NUL
+    std::vector<char> text_;
+
+    /// Every variable, in the order of the environment
+    std::vector<Variable> variables_;
+
+    /// Open addressing table of 1 + index into [variables_], 0 for an empty slot
+    /// The number of slots is a power of 2 and at least twice the number of variables
+    std::vector<uint32_t> slots_;
+
+    /// \return The slot of the variable with [name], or the empty slot where it would go
+    std::size_t slot(const char *name, const std::size_t size) const;
+};
+
+} // namespace detail
+} // namespace argparse
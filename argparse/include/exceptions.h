@@ -12,4 +12,12 @@ class InvalidConfig : public std::exception {
     }
 };
 
+/// Exception for when a lazily converted value is accessed, but is not one of the allowed values
+class NotAllowed : public std::exception {
+  public:
+    const char *what() const noexcept override {
+        return "Value is not allowed";
+    }
+};
+
 } // namespace argparse
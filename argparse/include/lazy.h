@@ -0,0 +1,58 @@
+#pragma once
+
+#include "exceptions.h"
+#include "placeholder.h"
+#include "span.h"
+
+#include <memory>
+#include <vector>
+
+namespace argparse {
+
+/// Forward Declarations
+class Option;
+
+/// Value of an option that is converted from the input arguments on first access, then kept until the next parse
+/// Parsing only records where the value is in the input arguments, so options that are never read are never converted
+/// The input arguments and the [Parser] must outlive the first access, and accessing is not thread safe
+/// Values not yet converted when their option is replaced by registering its name again are dropped, leaving the default
+template <typename T>
+class LazyValue {
+  public:
+    /// Converts the recorded input arguments and checks them against the allowed values on first access
+    /// \throws The exception of the conversion if a value can not be converted, or [NotAllowed] if it is not allowed
+    /// \return The value, or the default if the option was not given
+    const PlaceHolderType<T> &get() const {
+        if (!pending_.empty() && !resolve_(*option_, *this)) {
+            throw NotAllowed{};
+        }
+        return value_;
+    }
+
+    /// @{ Same as [get]
+    const PlaceHolderType<T> &operator*() const { return get(); }
+    const PlaceHolderType<T> *operator->() const { return &get(); }
+    /// @}
+
+  private:
+    friend class Option;
+
+    /// The converted value, or the default
+    mutable PlaceHolderType<T> value_{};
+
+    /// Values in the input arguments that are not converted yet
+    mutable std::vector<detail::Span> pending_{};
+
+    /// The option this is the value of
+    const Option *option_ = nullptr;
+
+    /// Converts [pending_] into [value_]
+    /// \return False if a value is not allowed, in which case nothing changes
+    bool (*resolve_)(const Option &option, const LazyValue &lazy) = nullptr;
+};
+
+/// Pointer to a lazily converted value
+template <typename T>
+using LazyPlaceHolder = std::shared_ptr<const LazyValue<T>>;
+
+} // namespace argparse
@@ -1,13 +1,20 @@
 #pragma once
 
+#include "choice.h"
 #include "config.h"
+#include "lazy.h"
 #include "placeholder.h"
+#include "snapshot.h"
+#include "span.h"
+#include "string_pool.h"
 #include "table.h"
+#include "tuple.h"
 #include "variant.h"
 
 #include <memory>
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 namespace argparse {
 
@@ -21,14 +28,55 @@ class Option {
     /// Single Constructor
     /// \param placeholder Placeholder pointer to a previously allocated object, the value will be populated later
     /// \param config Configuration for the option
+    /// \param pool Holds the name and help message, must outlive the option
     template <typename T>
-    Option(const PlaceHolder<T> &placeholder, Config<T> &&config, const pstd::optional<std::size_t> position);
+    Option(const PlaceHolder<T> &placeholder, Config<T> &&config, const pstd::optional<std::size_t> position, detail::StringPool &pool);
 
     /// Multivalent Constructor
     /// \param placeholder Placeholder pointer to a previously allocated object, the value will be populated later
     /// \param config Configuration for the option
+    /// \param pool Holds the name and help message, must outlive the option
     template <typename T>
-    Option(const PlaceHolder<std::vector<T>> &placeholder, Config<T> &&config, const pstd::optional<std::size_t> position);
+    Option(const PlaceHolder<std::vector<T>> &placeholder, Config<T> &&config, const pstd::optional<std::size_t> position,
+           detail::StringPool &pool);
+
+    /// Lazy Constructor
+    /// \param lazy   Value that is converted on first access, from the input arguments recorded while parsing
+    /// \param config Configuration for the option
+    /// \param pool   Holds the name and help message, must outlive the option
+    template <typename T>
+    Option(const std::shared_ptr<LazyValue<T>> &lazy, Config<T> &&config, const pstd::optional<std::size_t> position,
+           detail::StringPool &pool);
+
+    /// Lazy Multivalent Constructor
+    /// \param lazy   Values that are converted on first access, from the input arguments recorded while parsing
+    /// \param config Configuration for the option
+    /// \param pool   Holds the name and help message, must outlive the option
+    template <typename T>
+    Option(const std::shared_ptr<LazyValue<std::vector<T>>> &lazy, Config<T> &&config, const pstd::optional<std::size_t> position,
+           detail::StringPool &pool);
+
+    /// Choice Constructor
+    /// \param choices Perfect hash of the spellings of the choices, and where the chosen value goes
+    /// \param config  Configuration for the option, with the spellings as the allowed values
+    /// \param pool    Holds the name and help message, must outlive the option
+    Option(const std::shared_ptr<detail::ChoiceIndex> &choices, Config<std::string> &&config, const pstd::optional<std::size_t> position,
+           detail::StringPool &pool);
+
+    /// Tuple Constructor
+    /// \param tuple  Conversions of the values into the elements, and where the value goes
+    /// \param config Configuration for the option, with the spelled default and allowed values
+    /// \param pool   Holds the name and help message, must outlive the option
+    Option(const std::shared_ptr<detail::TupleIndex> &tuple, Config<std::string> &&config, const pstd::optional<std::size_t> position,
+           detail::StringPool &pool);
+
+    /// Detaches the value of a lazy option, which may outlive it, so it never reaches back to a destroyed option
+    ~Option();
+
+    Option(const Option &) = delete;
+    Option(Option &&) = delete;
+    Option &operator=(const Option &) = delete;
+    Option &operator=(Option &&) = delete;
 
     /// Populates a row of string information about this option
     OptionTable::Row to_string() const;
@@ -41,55 +89,204 @@ class Option {
     /// \returns True if set successfully, false if not (value is not allowed)
     bool set(const std::vector<std::string> &s);
 
+    /// Restores the value of this option to its default, or to no value if there is no default
+    void reset();
+
+    /// Records the values of a lazy option, to be converted on first access
+    void defer(const std::vector<detail::Span> &values);
+
+    /// Converts the recorded values of a lazy option now, instead of on first access
+    /// \returns True if converted successfully, false if not (value is not allowed)
+    bool resolve();
+
+    /// Appends the value of this option to a snapshot, see [Parser::set_cache]
+    void save(detail::SnapshotWriter &out) const;
+
+    /// Restores the value appended by [save], lazy options record their values in place in the snapshot
+    void load(detail::SnapshotReader &in);
+
+    /// Converts a single value and checks it against the allowed values, without setting anything
+    /// Throws the exception of the conversion if the value can not be converted
+    /// \returns True if the value is allowed
+    bool check(const std::string &s) const;
+
+    /// Checks a single value of the element at [index] of an option with a fixed number of values, see [check]
+    bool check(const std::string &s, const std::size_t index) const;
+
     /// @{ Gets configuration details about this option
-    const std::string &name() const noexcept { return name_; }
+    const char *name() const noexcept { return pool_->c_str(name_); }
     char letter() const noexcept { return letter_; }
     Type type() const noexcept { return type_; }
     bool required() const noexcept { return required_; }
     bool multivalent() const noexcept { return multivalent_; }
     bool positional() const noexcept { return position_.has_value(); }
+    bool lazy() const noexcept { return lazy_; }
+    const char *env() const noexcept { return pool_->c_str(env_); }
+    bool has_env() const noexcept { return env_.size != 0; }
+    const pstd::optional<Variant> &default_value() const noexcept { return default_value_; }
+    const std::unordered_set<Variant, Variant::hash> &allowed_values() const noexcept { return allowed_values_; }
     /// @}
 
+    /// \return Number of values of an option with a fixed number of values, 0 for any other option
+    std::size_t arity() const noexcept;
+
+    /// \return Name of the type, with the types of the values of an option with a fixed number of values
+    const char *type_name() const noexcept;
+
   private:
+    /// Typed setters of an option, resolved when the option is constructed
+    /// Only the setter matching whether the option is multivalent is non null, [reset] always is
+    /// Lazy options have [defer], [resolve] and [detach] instead of [single] and [multiple]
+    struct Setters {
+        bool (*single)(Option &option, const std::string &s);
+        bool (*multiple)(Option &option, const std::vector<std::string> &s);
+        void (*reset)(Option &option);
+        void (*defer)(Option &option, const std::vector<detail::Span> &values);
+        bool (*resolve)(Option &option);
+        void (*detach)(Option &option);
+        bool (*check)(const Option &option, const std::string &s);
+        void (*save)(const Option &option, detail::SnapshotWriter &out);
+        void (*load)(Option &option, detail::SnapshotReader &in);
+    };
+
+    /// @{ The setters of each type
+    template <typename T>
+    static const Setters kSingleSetters;
+    template <typename T>
+    static const Setters kMultipleSetters;
+    template <typename T>
+    static const Setters kLazySetters;
+    template <typename T>
+    static const Setters kLazyMultipleSetters;
+    static const Setters kChoiceSetters;
+    static const Setters kTupleSetters;
+    /// @}
+
     /// Enumeration of the option type
     const Type type_;
 
     /// @{ Decomposed members of the configuration
     const pstd::optional<Variant> default_value_;
     const std::unordered_set<Variant, Variant::hash> allowed_values_;
-    const std::string name_;
-    const std::string help_;
+    const std::shared_ptr<const detail::PrefixTrie> prefixes_; /// Allowed blocks of addresses and blocks, null if none
+    const detail::PooledString name_;
+    const detail::PooledString help_;
+    const detail::PooledString env_;
     const pstd::optional<std::size_t> position_;
     const char letter_;
     const bool multivalent_;
     const bool required_;
     /// @}
 
-    /// Handle to value to be populated
+    /// If the value is converted on first access, see [LazyValue]
+    const bool lazy_;
+
+    /// Handle to value to be populated, only keeps the value alive
     std::shared_ptr<void> placeholder_;
 
+    /// The value to be populated, a [PlaceHolderType<T>] or [PlaceHolderType<std::vector<T>>] depending on [multivalent_]
+    /// Or, for lazy options, a [LazyValue<T>] or [LazyValue<std::vector<T>>], for choices a [detail::ChoiceIndex], and
+    /// for options with a fixed number of values a [detail::TupleIndex]
+    /// Used instead of [placeholder_] when setting so there is no reference counting
+    void *const value_;
+
+    /// Values of a multivalent option without a default, a [std::vector<T>] kept aside when the option is reset, so the
+    /// next values reuse its capacity and a steady stream of parses does not allocate
+    std::shared_ptr<void> spare_;
+
+    /// Setters of the type of this option
+    const Setters *const setters_;
+
+    /// Text of [name_], [help_] and [env_]
+    const detail::StringPool *const pool_;
+
     /// Determines the value of [default_value_]
     /// Converts [T] to [Variant]
     template <typename T>
     pstd::optional<Variant> determine_default_value(const pstd::optional<T> &default_value);
 
-    /// Depending on the type, calls [set_helper] with the appropriate template type
-    /// The type [T] of this function is not the type of the option, it is the type of the values
-    ///   - Either [std::string] or [std::vector<std::string>]
-    /// \param s Values to set
-    /// \returns True if set successfully, false if not (value is not allowed)
+    /// Checks a converted value against [allowed_values_], or an address or a block against [prefixes_]
+    /// \returns True if there are no allowed values or the value is one of them, or is in one of the allowed blocks
     template <typename T>
-    bool set_dispatch_helper(const T &s);
+    bool allowed(const T &value) const;
 
     /// Sets the value
     /// \returns True if set successfully, false if not (value is not allowed)
     template <typename T>
-    bool set_helper(const std::string &s);
+    static bool set_helper(Option &option, const std::string &s);
 
     /// Sets the values
     /// \returns True if set successfully, false if not (value is not allowed)
     template <typename T>
-    bool set_helper(const std::vector<std::string> &s);
+    static bool set_helper(Option &option, const std::vector<std::string> &s);
+
+    /// @{ Restores the value, or values, to the default
+    template <typename T>
+    static void reset_helper(Option &option);
+    template <typename T>
+    static void reset_multiple_helper(Option &option);
+    template <typename V>
+    static void reset_lazy_helper(Option &option);
+    /// @}
+
+    /// @{ Assigns the default value, or values, or no value if there is no default
+    template <typename T>
+    static void assign_default(const Option &option, PlaceHolderType<T> &optional);
+    template <typename T>
+    static void assign_default(const Option &option, PlaceHolderType<std::vector<T>> &optional);
+    /// @}
+
+    /// Converts a value only to check it
+    template <typename T>
+    static bool check_helper(const Option &option, const std::string &s);
+
+    /// @{ Finds a spelling in the choices, restores the default choice, and checks a spelling is a choice
+    static bool set_choice(Option &option, const std::string &s);
+    static void reset_choice(Option &option);
+    static bool check_choice(const Option &option, const std::string &s);
+    /// @}
+
+    /// @{ Converts exactly as many values as the elements, restores the default, and checks a value of the first element
+    static bool set_tuple(Option &option, const std::vector<std::string> &s);
+    static void reset_tuple(Option &option);
+    static bool check_tuple(const Option &option, const std::string &s);
+    /// @}
+
+    /// @{ Saves and loads the value, or values, the index of the choice, or the recorded or converted values of a lazy option
+    template <typename V>
+    static void save_helper(const Option &option, detail::SnapshotWriter &out);
+    template <typename V>
+    static void load_helper(Option &option, detail::SnapshotReader &in);
+    static void save_choice(const Option &option, detail::SnapshotWriter &out);
+    static void load_choice(Option &option, detail::SnapshotReader &in);
+    static void save_tuple(const Option &option, detail::SnapshotWriter &out);
+    static void load_tuple(Option &option, detail::SnapshotReader &in);
+    template <typename V>
+    static void save_lazy_helper(const Option &option, detail::SnapshotWriter &out);
+    template <typename V>
+    static void load_lazy_helper(Option &option, detail::SnapshotReader &in);
+    /// @}
+
+    /// Records the values of a lazy option
+    template <typename V>
+    static void defer_helper(Option &option, const std::vector<detail::Span> &values);
+
+    /// Converts the recorded values of a lazy option, if there are any
+    template <typename V>
+    static bool resolve_helper(Option &option);
+
+    /// Drops the recorded values of a lazy option that is destroyed, such as when its name is registered again
+    /// The value keeps what was converted, or the default, and no longer points back to the option
+    template <typename V>
+    static void detach_helper(Option &option);
+
+    /// @{ Converts the recorded values of a lazy option, and checks them against the allowed values
+    /// \returns True if converted successfully, false if not (value is not allowed)
+    template <typename T>
+    static bool convert_lazy(const Option &option, const LazyValue<T> &lazy);
+    template <typename T>
+    static bool convert_lazy(const Option &option, const LazyValue<std::vector<T>> &lazy);
+    /// @}
 };
 
 } // namespace argparse
@@ -1,20 +1,36 @@
 #pragma once
 
+#include "bitmask.h"
+#include "constraint.h"
 #include "option.h"
+#include "string_pool.h"
 
+#include <array>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 namespace argparse {
 
+/// Denotes an option was not found
+constexpr std::size_t kNoOption = std::numeric_limits<std::size_t>::max();
+
 /// Encapsulates a set of options
+/// Each option is identified by an id, which is the order it was registered in
+/// What parsing looks at for every argument is kept in parallel arrays by id, the rest stays in the [Option] objects
 class Options {
     using OptionTable = Option::OptionTable;
-    using MapType = std::unordered_map<std::string, std::shared_ptr<Option>>;
+    using ListType = std::vector<std::shared_ptr<Option>>;
 
   public:
-    using NameLetterVector = std::vector<std::pair<std::string, std::string>>;
+    /// \param pool Holds the names and help messages of the options, shared with the options of subparsers
+    explicit Options(std::shared_ptr<detail::StringPool> pool = std::make_shared<detail::StringPool>())
+        : pool_(std::move(pool)), touched_(std::make_shared<detail::Bitmask>()) {}
+
+    /// Receives the names of the options of a violated constraint
+    using ConstraintCallback = std::function<void(const Constraint, const std::vector<std::string> &)>;
 
     /// Add an option that can have a single value
     /// \param config Configuration for the option
@@ -28,6 +44,26 @@ class Options {
     template <typename T>
     ConstPlaceHolder<std::vector<T>> add_multivalent(Config<T> &&config);
 
+    /// Add an option that can have a single value, converted on first access
+    /// \param config Configuration for the option
+    template <typename T>
+    LazyPlaceHolder<T> add_lazy(Config<T> &&config);
+
+    /// Add an option that can have multiple values, converted on first access
+    /// \param config Configuration for the option
+    template <typename T>
+    LazyPlaceHolder<std::vector<T>> add_lazy_multivalent(Config<T> &&config);
+
+    /// Add an option whose value is one of a set of choices
+    /// \param config  Configuration for the option, with the spellings of the choices as the allowed values
+    /// \param choices Perfect hash of the spellings, and where the chosen value goes
+    void add_choice(Config<std::string> &&config, const std::shared_ptr<detail::ChoiceIndex> &choices);
+
+    /// Add an option that takes a fixed number of values
+    /// \param config Configuration for the option, with the spelled default and allowed values
+    /// \param tuple  Conversions of the values into the elements, and where the value goes
+    void add_tuple(Config<std::string> &&config, const std::shared_ptr<detail::TupleIndex> &tuple);
+
     /// Creates a string for the usage message
     /// \note Positionals are skipped and are handled by the [Parser]
     std::string usage_string() const;
@@ -36,21 +72,145 @@ class Options {
     /// Generates a table of the details of every option
     std::string display_string() const;
 
-    /// Searches for an option by name
-    /// \param name Name of the option
-    /// \return     A pointer to the option if found, otherwise nullptr
-    std::shared_ptr<Option> get(const std::string &name);
+    /// Searches for an option by name, or by letter if [name] is a single character
+    /// \param name Name or letter of the option
+    /// \return     The id of the option if found, otherwise [kNoOption]
+    std::size_t find(const std::string &name) const { return find(name.data(), name.size()); }
+    std::size_t find(const char *name, const std::size_t size) const;
+
+    /// Searches for an option by letter, through a table of every possible letter
+    /// \return The id of the option if found, otherwise [kNoOption]
+    std::size_t find_letter(const char letter) const noexcept {
+        const auto index = letter_ids_[static_cast<uint8_t>(letter)];
+        return (index == 0) ? kNoOption : (index - 1);
+    }
+
+    /// Resolves a cluster of letters such as "xvf" of "-xvf", boolean options up to the first option that takes values
+    /// \param letters The letters after the '-'
+    /// \return        The number of letters that are options, the last one may take values and the rest of the letters
+    ///                is its value, or 0 if a letter is not registered
+    std::size_t cluster(const char *letters, const std::size_t size) const noexcept;
+
+    /// \return The pool holding the text of the options
+    const std::shared_ptr<detail::StringPool> &pool() const noexcept { return pool_; }
+
+    /// \return The option with the id
+    Option &at(const std::size_t id) { return *options_[id]; }
+    const Option &at(const std::size_t id) const { return *options_[id]; }
+
+    /// \return The number of registered options, ids are in the range [0, size)
+    std::size_t size() const noexcept { return options_.size(); }
+
+    /// Makes room for [count] options in total, so registering many options grows each table once
+    void reserve(const std::size_t count);
+
+    /// @{ Configuration of the option with the id, without touching the [Option]
+    Type type(const std::size_t id) const noexcept { return types_[id]; }
+    char letter(const std::size_t id) const noexcept { return letters_[id]; }
+    bool required(const std::size_t id) const noexcept { return (flags_[id] & kRequired) != 0; }
+    bool positional(const std::size_t id) const noexcept { return (flags_[id] & kPositional) != 0; }
+    bool multivalent(const std::size_t id) const noexcept { return (flags_[id] & kMultivalent) != 0; }
+    bool lazy(const std::size_t id) const noexcept { return (flags_[id] & kLazy) != 0; }
+    /// @}
+
+    /// \return Number of values an option takes if it takes a fixed number, 0 otherwise, only tuples touch the [Option]
+    std::size_t arity(const std::size_t id) const noexcept { return (types_[id] == Type::kTuple) ? options_[id]->arity() : 0; }
+
+    /// \return If the option is a boolean that takes no values, a multivalent boolean takes a list of values instead
+    bool flag(const std::size_t id) const noexcept { return (types_[id] == Type::kBool) && !multivalent(id); }
 
-    /// Check the input set of arguments with the set of required arguments
-    /// \return The set of arguments that were required but non existing
-    NameLetterVector check_requirements(const std::unordered_set<std::string> &existing_args) const;
+    /// \return The options that have an environment variable, by id
+    const detail::Bitmask &environment() const noexcept { return environment_; }
+
+    /// Records that an option is about to be set, so the next [reset] restores it
+    void touch(const std::size_t id) { touched_->set(id); }
+
+    /// Restores the options set since the last reset to their default values, so a parse does not see values of the
+    /// previous parse, the other options still have their default values
+    void reset();
+
+    /// Adds a constraint between registered options
+    /// \param constraint Kind of constraint
+    /// \param names      Names or letters of the options of the group, or the options the subject requires / conflicts with
+    /// \param subject    Name or letter of the option that requires / conflicts with [names], only for those kinds
+    /// \throws [InvalidConfig] if an option is not registered, or [subject] does not match the kind
+    void add_constraint(const Constraint constraint, const std::vector<std::string> &names, const std::string &subject = "");
+
+    /// \return The number of constraints
+    std::size_t constraints() const noexcept { return rules_.size(); }
+
+    /// Check the given options against the required options
+    /// \param present If each option, by id, was given
+    /// \param missing Invoked with the name of every option that is required but not given
+    /// \return        True if every required option was given
+    bool check_requirements(const detail::Bitmask &present, const std::function<void(const std::string &)> &missing) const;
+
+    /// Check the given options against the constraints, in the order they were added
+    /// \param present  If each option, by id, was given
+    /// \param violated Invoked for every violated constraint, with the names of the options at fault
+    ///                 Those are the options given for [kMutuallyExclusive] and the options missing for [kAllOrNone],
+    ///                 every option of a [kAtLeastOne] group, and the subject then the options at fault for the others
+    /// \return         True if no constraint was violated
+    bool check_constraints(const detail::Bitmask &present, const ConstraintCallback &violated) const;
 
   private:
-    /// Map of registered options
-    MapType options_{};
+    /// Bits of [flags_]
+    enum Flag : uint8_t {
+        kRequired = 1U << 0U,
+        kPositional = 1U << 1U,
+        kMultivalent = 1U << 2U,
+        kLazy = 1U << 3U,
+    };
+
+    /// Registered options, indexed by id
+    /// Their addresses must not change, lazy values point back at them
+    ListType options_{};
+
+    /// @{ Per option data, indexed by id
+    std::vector<uint32_t> hashes_{}; /// Hash of the name, compared before the name itself
+    std::vector<char> letters_{};    /// Letter, or [kUnusedChar]
+    std::vector<Type> types_{};      /// Type of the value
+    std::vector<uint8_t> flags_{};   /// Combination of [Flag]
+    /// @}
+
+    /// Names and help messages of the options
+    std::shared_ptr<detail::StringPool> pool_;
+
+    /// 1 + id of the option of each letter, 0 if no option has the letter
+    /// The first option registered with a letter keeps it
+    std::array<uint32_t, 256> letter_ids_{};
+
+    /// Options set since the last [reset], shared by copies since they share the [Option] objects
+    std::shared_ptr<detail::Bitmask> touched_;
+
+    /// Open addressing table of 1 + id of each option by name, 0 for an empty slot
+    /// The names are compared against the pool, so the table holds no copies of them
+    std::vector<uint32_t> slots_{};
+
+    /// \return The slot of the option with [name], or the empty slot where it would go
+    std::size_t slot(const char *name, const std::size_t size, const uint32_t hash) const;
+
+    /// Resizes the table to at least twice [count] slots and reinserts every option
+    void grow(const std::size_t count);
+
+    /// A constraint with its options resolved to ids
+    struct Rule {
+        Constraint constraint;
+        std::size_t subject;     /// Option that requires / conflicts with [members], otherwise [kNoOption]
+        detail::Bitmask members; /// Options of the group, or the options [subject] requires / conflicts with
+    };
+
+    /// Options that are required, by id
+    detail::Bitmask required_{};
+
+    /// Options that have an environment variable, by id
+    detail::Bitmask environment_{};
+
+    /// Constraints, in the order they were added
+    std::vector<Rule> rules_{};
 
-    /// List of options that are required
-    NameLetterVector required_options_{};
+    /// \return The names of the options in [mask], with [subject] first if it is an option
+    std::vector<std::string> names(const std::size_t subject, const detail::Bitmask &mask, const detail::Bitmask &present, const bool given) const;
 
     /// Helper for registering an option with a configuration
     template <typename T, typename PlaceholderType>
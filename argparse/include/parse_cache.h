@@ -0,0 +1,87 @@
+#pragma once
+
+#include "span.h"
+#include "std_optional.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace argparse {
+namespace detail {
+
+/// Results of parses, each stored as a binary snapshot under the key of its input, in one region of memory that is
+/// mapped from a file or shared between processes
+/// The region holds a header, an open addressing table of the offset of each entry, 0 for an empty slot, then the
+/// entries, appended one after another and never moved or removed, so a cache that is full stays full
+/// An entry is written before its slot is published, so processes and threads can look up and insert at the same time
+/// without locks, and a reader never sees a partial entry
+/// Any process that maps the region can write it, so every offset and size read from it is checked against the region
+/// before it is followed, and an entry that does not fit is skipped as if it were missing
+class ParseCache {
+  public:
+    /// Size of a region created by [ParseCache(path)]
+    static constexpr std::size_t kDefaultSize = 4 * 1024 * 1024;
+
+    /// Maps a file, created with [size] bytes if it does not exist, readable and writable by its owner only, the mapping
+    /// is shared with every process mapping it
+    /// \throws std::system_error if the file can not be created or mapped, std::invalid_argument if it is not a cache
+    explicit ParseCache(const std::string &path, const std::size_t size = kDefaultSize);
+
+    /// Uses a region that outlives this object, such as a shared mapping made before forking the processes that use it
+    /// A region of zeros is set up as an empty cache, so the first process must construct the cache before the others
+    /// \throws std::invalid_argument if the region is too small or is not a cache
+    ParseCache(void *region, const std::size_t size);
+
+    /// Unmaps the file, if mapped
+    ~ParseCache();
+
+    ParseCache(const ParseCache &) = delete;
+    ParseCache &operator=(const ParseCache &) = delete;
+
+    /// \return The snapshot stored under [key], in place in the region, if there is one
+    pstd::optional<Span> find(const std::string &key) const;
+
+    /// Stores a snapshot under [key], unless one is already stored
+    /// \return False if the region is full or the table is crowded, in which case nothing is stored
+    bool insert(const std::string &key, const std::string &snapshot);
+
+    /// \return Number of entries
+    std::size_t size() const noexcept;
+
+    /// 64 bit FNV-1a of [data], continued from [seed] so several pieces can be hashed as one
+    static uint64_t hash(const char *data, const std::size_t size, uint64_t seed = 14695981039346656037ULL);
+
+  private:
+    /// Start of the region, laid out as described above
+    struct Header;
+    Header *header_ = nullptr;
+
+    /// An entry in the region, followed by its key then its snapshot
+    struct Entry;
+
+    /// Size of the region
+    std::size_t size_ = 0;
+
+    /// Number of slots of the table, read once when attaching so a region changed afterwards can not move the table
+    std::size_t slots_ = 0;
+
+    /// If the region is a mapping of a file owned by this object
+    bool mapped_ = false;
+
+    /// Sets up a region of zeros as an empty cache, and checks the layout of any other region
+    void attach();
+
+    /// \return The table of entry offsets, right after the header
+    std::atomic<uint64_t> *slots() const noexcept;
+
+    /// \return The entry at [offset], or null if it is not an offset of an entry that fits in the region
+    const Entry *entry(const uint64_t offset) const noexcept;
+
+    /// \return The slot of the entry with [key], or the empty slot where it would go, or none if every slot probed is taken
+    pstd::optional<std::size_t> slot(const std::string &key, const uint64_t hash) const;
+};
+
+} // namespace detail
+} // namespace argparse
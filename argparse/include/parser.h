@@ -1,6 +1,8 @@
 #pragma once
 
 #include "args.h"
+#include "classify.h"
+#include "options.h"
 
 #include <string>
 #include <vector>
@@ -9,36 +11,63 @@ namespace argparse {
 namespace detail {
 
 /// Handles the parsing of the input arguments at a lower level
+/// Tokenizing and resolving against the registered options happen in the same pass
 class Parser {
   public:
-    /// Map key string for the remaining / splitted arguments
-    static constexpr const char * const kRemainingArgsKey = "_remaining";
+    /// @{ Classifies input arguments, to then be parsed
+    /// \return One token per argument, valid until the next call and for as long as the input arguments are
+    const std::vector<Token> &classify(const int argc, const char **argv) {
+        return classifier_.classify(argc, argv);
+    }
+    const std::vector<Token> &classify(const char *data, const std::size_t size) {
+        return classifier_.classify(data, size);
+    }
+    /// @}
 
-    /// Parses the programs input arguments
-    /// \return The parsed arguments in a map-like object
-    Args parse(const int argc, const char **argv);
+    /// Parses the programs input arguments against the registered options
+    /// \return The parsed arguments, valid until the next call and for as long as [argv] is
+    const Args &parse(const int argc, const char **argv, const Options &options);
 
-    /// \return The parsed positional arguments
-    const std::vector<std::string> &positional_args() const {
-        return positional_args_;
-    }
+    /// Parses classified input arguments against the registered options
+    /// Each option is looked up once, where it appears, and its values are written straight into its slot
+    /// Options that are not registered are recorded, and their values are skipped
+    /// \return The parsed arguments, valid until the next call and for as long as the tokens are
+    const Args &parse(const Token *tokens, const std::size_t count, const Options &options);
 
   private:
-    /// Positional arguments are the arguments that are before other options
-    std::vector<std::string> positional_args_;
+    /// Id of the option that following values belong to
+    /// [kNoOption] before the first option, and after an option that is not registered
+    std::size_t last_option_ = kNoOption;
+
+    /// If an option has appeared yet, values before the first option are positional arguments
+    bool any_option_ = false;
+
+    /// If the following arguments are part of the splitted arguments set
+    bool is_splitted_args_ = false;
+
+    /// Classifies the input arguments before they are parsed, reused between parses
+    Classifier classifier_;
+
+    /// Parsed arguments, reused between parses
+    Args args_;
+
+    /// Buffer for looking up option names, reused between parses
+    std::string key_;
 
     /// Parse a single argument
-    /// \param args             Map of arguments currently parsed
-    /// \param last_option      The last option that the current value belongs to
-    /// \param s                The value of the argument
-    /// \param is_splitted_args If the following arguments are part of the splitted arguments set
-    void parse_arg(Args &args, std::string &last_option, std::string &&s, bool &is_splitted_args);
+    /// \param options Registered options
+    /// \param token   The classified argument
+    /// \param index   The index of the argument in the input arguments
+    void parse_arg(const Options &options, const Token &token, const std::size_t index);
 
-    /// Checks if the string is an option or not by checking for 1-2 hyphens '-'
-    bool is_option(const std::string &s);
+    /// Parses a cluster of letters such as -xvf, which are boolean options up to the last letter
+    /// The last letter may take values, from the rest of the argument or from the following arguments
+    /// \param letters Number of letters that are options, see [Options::cluster]
+    void parse_cluster(const Options &options, const Token &token, const std::size_t letters, const std::size_t index);
 
-    /// Strips the prefixing hyphens
-    void strip_prefix(std::string &s);
+    /// Adds a value to the slot of the option, multivalent options have their values split by comma
+    /// The first value beyond the number the option accepts is flagged as the surplus of the slot
+    void add_value(const Options &options, const std::size_t id, const Span value, const std::size_t index);
 };
 
 } // namespace detail
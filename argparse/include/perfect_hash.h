@@ -0,0 +1,70 @@
+#pragma once
+
+#include "string_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace argparse {
+namespace detail {
+
+/// Perfect hash of a fixed set of strings, built once then only searched
+/// Each key has a slot of its own, so a search hashes the input once, reads one displacement and compares one key
+/// Built with hash and displace: the keys are split into buckets, then the largest buckets are placed first, each
+/// with the first displacement that moves all of its keys to free slots
+class PerfectHash {
+  public:
+    /// Denotes a string is not one of the keys
+    static constexpr std::size_t kNoKey = std::numeric_limits<std::size_t>::max();
+
+    PerfectHash() = default;
+
+    /// \param keys Strings to search for, each must be different
+    /// \throws [InvalidConfig] if a key is repeated
+    explicit PerfectHash(const std::vector<std::string> &keys);
+
+    /// \return The index of the string in the keys given at construction, or [kNoKey]
+    std::size_t find(const char *data, const std::size_t size) const;
+    std::size_t find(const std::string &s) const { return find(s.data(), s.size()); }
+
+    /// \return Number of keys
+    std::size_t size() const noexcept { return size_; }
+
+  private:
+    /// Moves the keys of a bucket to slot ((hash + multiplier * step + offset) & mask)
+    struct Displacement {
+        uint32_t multiplier;
+        uint32_t offset;
+    };
+
+    /// Number of keys
+    std::size_t size_ = 0;
+
+    /// One less than the number of slots, and of buckets, which is a power of 2
+    uint32_t mask_ = 0;
+
+    /// Displacement of each bucket
+    std::vector<Displacement> displacements_;
+
+    /// Key in each slot, as an offset into [text_]
+    std::vector<PooledString> keys_;
+
+    /// Index of the key in each slot, in the keys given at construction, or [kNoKey] for an empty slot
+    std::vector<std::size_t> indices_;
+
+    /// Characters of every key, each followed by a NUL
+    std::vector<char> text_;
+
+    /// \return The slot of a key hashed to [hash] in a bucket displaced by [displacement]
+    uint32_t slot(const uint64_t hash, const Displacement displacement) const noexcept;
+
+    /// Places every key, with [mask] + 1 slots
+    /// \return False if a bucket could not be placed, so more slots are needed
+    bool build(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes, const uint32_t mask);
+};
+
+} // namespace detail
+} // namespace argparse
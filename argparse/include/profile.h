@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace argparse {
+
+/// Stages of parsing that are measured when compiled with [ARGPARSE_INSTRUMENTATION]
+enum class Phase {
+    kTokenize,      /// Splitting the input arguments into options and values
+    kResolve,       /// Positional resolution and option lookup
+    kConvert,       /// Converting string values to the type of the option
+    kAllowedValues, /// Checking converted values against the allowed values
+    kRequirements,  /// Checking that the required options were provided
+    kHelp,          /// Rendering the help message
+    kCount,         /// Number of phases, not an actual phase
+};
+
+/// Convert [Phase] to string
+constexpr const char * enum_to_str(const Phase phase) {
+    switch (phase) {
+    case Phase::kTokenize      : return "tokenize";       break;
+    case Phase::kResolve       : return "resolve";        break;
+    case Phase::kConvert       : return "convert";        break;
+    case Phase::kAllowedValues : return "allowed_values"; break;
+    case Phase::kRequirements  : return "requirements";   break;
+    case Phase::kHelp          : return "help";           break;
+    case Phase::kCount:
+    default:
+        break;
+    }
+
+    return nullptr;
+}
+
+/// Measurements of a single phase
+/// Time spent in a nested phase is only accounted to the nested phase
+struct PhaseStats {
+    uint64_t count = 0;        /// Number of times the phase was entered
+    uint64_t nanoseconds = 0;  /// Wall clock time spent in the phase
+    uint64_t cycles = 0;       /// CPU cycles spent in the phase, if hardware counters are available
+    uint64_t instructions = 0; /// Instructions retired in the phase, if hardware counters are available
+};
+
+/// Measurements of every phase of a single top level [Parser::parse] or [Parser::help] call
+struct Profile {
+    static constexpr std::size_t kNumPhases = static_cast<std::size_t>(Phase::kCount);
+
+    /// Measurements indexed by [Phase]
+    std::array<PhaseStats, kNumPhases> phases{};
+
+    /// If [PhaseStats::cycles] and [PhaseStats::instructions] were measured
+    bool hardware_counters = false;
+
+    /// @{ Accessors by phase
+    PhaseStats &operator[](const Phase phase) { return phases[static_cast<std::size_t>(phase)]; }
+    const PhaseStats &operator[](const Phase phase) const { return phases[static_cast<std::size_t>(phase)]; }
+    /// @}
+};
+
+} // namespace argparse
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "profile.h"
+
+#include <functional>
+
+namespace argparse {
+namespace detail {
+
+/// Callback that receives the measurements of a parse
+using ProfileCallback = std::function<void(const Profile &)>;
+
+#if defined(ARGPARSE_INSTRUMENTATION)
+
+/// Accumulates the measurements of each phase of a parse on the current thread
+/// Phases are exclusive, entering a nested phase pauses the enclosing phase until the nested phase exits
+class Profiler {
+  public:
+    /// \return The profiler of the session running on this thread, or nullptr if there is none
+    static Profiler *active() noexcept;
+
+    /// Starts accounting to [phase]
+    /// \return The phase that was being accounted to before
+    Phase enter(const Phase phase) noexcept;
+
+    /// Stops accounting to the current phase and resumes [previous]
+    void exit(const Phase previous) noexcept;
+
+  private:
+    friend class ProfileSession;
+
+    /// Snapshot of every measured quantity at one point in time
+    struct Sample {
+        uint64_t nanoseconds = 0;
+        uint64_t cycles = 0;
+        uint64_t instructions = 0;
+    };
+
+    /// Measurements so far
+    Profile profile_{};
+
+    /// Phase that is currently accounted to, [Phase::kCount] if none
+    Phase current_ = Phase::kCount;
+
+    /// Sample taken at the last phase transition
+    Sample mark_{};
+
+    /// Adds the difference since [mark_] to the current phase, then moves [mark_] forward
+    void charge() noexcept;
+
+    /// Reads the clock and the hardware counters
+    Sample sample() const noexcept;
+};
+
+/// Installs a [Profiler] for the current thread for the lifetime of this object, then reports to the callback
+/// Nested sessions, such as subparsers parsing on behalf of their parent, do nothing so the outermost session reports
+class ProfileSession {
+  public:
+    explicit ProfileSession(const ProfileCallback &report);
+    ~ProfileSession();
+
+    ProfileSession(const ProfileSession &) = delete;
+    ProfileSession(ProfileSession &&) = delete;
+    ProfileSession &operator=(const ProfileSession &) = delete;
+    ProfileSession &operator=(ProfileSession &&) = delete;
+
+  private:
+    /// Callback to report to, or nullptr if this session is not the outermost
+    const ProfileCallback *report_ = nullptr;
+
+    /// Profiler owned by this session
+    Profiler profiler_{};
+};
+
+/// Accounts the lifetime of this object to a phase of the active profiler, if any
+class ScopedPhase {
+  public:
+    explicit ScopedPhase(const Phase phase) noexcept : profiler_(Profiler::active()) {
+        if (profiler_ != nullptr) {
+            previous_ = profiler_->enter(phase);
+        }
+    }
+
+    ~ScopedPhase() {
+        if (profiler_ != nullptr) {
+            profiler_->exit(previous_);
+        }
+    }
+
+    ScopedPhase(const ScopedPhase &) = delete;
+    ScopedPhase(ScopedPhase &&) = delete;
+    ScopedPhase &operator=(const ScopedPhase &) = delete;
+    ScopedPhase &operator=(ScopedPhase &&) = delete;
+
+  private:
+    Profiler *const profiler_;
+    Phase previous_ = Phase::kCount;
+};
+
+#else
+
+/// Compiled out, these are empty and optimized away entirely
+class ProfileSession {
+  public:
+    explicit ProfileSession(const ProfileCallback & /*report*/) noexcept {}
+};
+
+class ScopedPhase {
+  public:
+    explicit ScopedPhase(const Phase /*phase*/) noexcept {}
+};
+
+#endif
+
+} // namespace detail
+} // namespace argparse
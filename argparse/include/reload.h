@@ -0,0 +1,325 @@
+#pragma once
+
+#include "argparse.h"
+#include "config_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace argparse {
+namespace detail {
+
+/// Watches a file for being written or replaced, through inotify on the directory of the file
+/// The directory is watched instead of the file, so a file replaced by renaming another over it is still seen
+/// Where inotify is not available, every wait times out as if the file may have changed
+class FileWatch {
+  public:
+    /// \throws std::system_error if the directory can not be watched
+    explicit FileWatch(const std::string &path);
+    ~FileWatch();
+
+    FileWatch(const FileWatch &) = delete;
+    FileWatch(FileWatch &&) = delete;
+    FileWatch &operator=(const FileWatch &) = delete;
+    FileWatch &operator=(FileWatch &&) = delete;
+
+    /// Waits up to [timeout] for the file to change
+    /// \return True if the file may have changed
+    bool wait(const std::chrono::milliseconds timeout);
+
+  private:
+    /// The inotify instance, or -1 if not available
+    int fd_ = -1;
+
+    /// Name of the file within its directory
+    std::string name_;
+
+    /// Events read from [fd_]
+    std::vector<char> buffer_;
+};
+
+/// Epochs of the readers of published snapshots, so a replaced snapshot is freed once no reader can still see it
+/// A reader announces the epoch it entered in its own slot, then reads the snapshot, so reading takes no lock and touches
+/// no shared reference count, only a slot no other reader writes
+/// A writer publishes a new snapshot, then starts a new epoch, the old snapshot can be freed once every reader has entered
+/// that epoch or left
+class Epochs {
+  public:
+    /// Most readers at a time
+    static constexpr std::size_t kSlots = 64;
+
+    /// Takes a free slot for a reader
+    /// \throws std::length_error if every slot is taken
+    std::size_t claim();
+
+    /// Frees the slot of a reader
+    void release(const std::size_t slot) noexcept;
+
+    /// @{ Marks a reader as reading, or as done, in its slot
+    void enter(const std::size_t slot) noexcept { slots_[slot].epoch.store(epoch_.load()); }
+    void leave(const std::size_t slot) noexcept { slots_[slot].epoch.store(kIdle); }
+    /// @}
+
+    /// Starts a new epoch
+    /// \return The new epoch
+    uint64_t advance() noexcept;
+
+    /// \return The oldest epoch a reader is in, or the current epoch if no reader is reading
+    uint64_t oldest() const noexcept;
+
+  private:
+    /// Epoch of a slot that is not reading
+    static constexpr uint64_t kIdle = 0;
+
+    /// A slot on its own cache line, so readers do not share lines
+    struct Slot {
+        std::atomic<uint64_t> epoch{kIdle};
+        std::atomic<bool> claimed{false};
+        char padding[64 - sizeof(std::atomic<uint64_t>) - sizeof(std::atomic<bool>)];
+    };
+
+    /// The current epoch
+    std::atomic<uint64_t> epoch_{1};
+
+    /// Slot of each reader
+    Slot slots_[kSlots];
+};
+
+/// Compares two config files
+/// \return The keys whose value was added, removed or changed, sorted, as "name" or "section.name"
+std::vector<std::string> diff(const ConfigFile &before, const ConfigFile &after);
+
+} // namespace detail
+
+/// Re-parses a config file whenever it changes, and publishes the values as immutable snapshots for other threads
+/// The placeholders are only touched by the thread that reloads, readers see a [T] extracted from them after each parse
+/// Readers are wait free, a read marks the epoch of the reader then loads the snapshot, and a replaced snapshot is freed
+/// once no reader can still see it
+/// \code{.cpp}
+///   struct Flags { uint32_t threads; std::string mode; };
+///   Reloader<Flags> reloader([](Parser &parser) {
+///       auto threads = parser.add(Config<uint32_t>{.default_value = 1, .name = "threads"});
+///       auto mode = parser.add(Config<std::string>{.default_value = "fast", .name = "mode"});
+///       return [threads, mode] { return Flags{threads->value(), mode->value()}; };
+///   }, {argv, argv + argc}, "/etc/app.conf");
+///
+///   // Each worker thread
+///   auto reader = reloader.reader();
+///   while (running) {
+///       const auto flags = reader.read();
+///       work(flags->threads, flags->mode);
+///   }
+///
+///   // The reloading thread
+///   while (running) {
+///       for (const auto &key : reloader.poll(std::chrono::seconds(1))) {
+///           log("changed", key);
+///       }
+///   }
+/// \endcode
+template <typename T>
+class Reloader {
+  public:
+    /// Extracts the values from the placeholders after a parse
+    using Extract = std::function<T()>;
+
+    /// Registers the options of the schema, and returns how to extract the values after each parse
+    using Schema = std::function<Extract(Parser &parser)>;
+
+    /// A snapshot being read, the snapshot is not freed while the view lives
+    class View {
+      public:
+        View(View &&other) noexcept : epochs_(other.epochs_), slot_(other.slot_), value_(other.value_) { other.epochs_ = nullptr; }
+        ~View() {
+            if (epochs_ != nullptr) {
+                epochs_->leave(slot_);
+            }
+        }
+
+        View(const View &) = delete;
+        View &operator=(const View &) = delete;
+        View &operator=(View &&) = delete;
+
+        const T &operator*() const noexcept { return *value_; }
+        const T *operator->() const noexcept { return value_; }
+
+      private:
+        friend class Reloader;
+        View(detail::Epochs &epochs, const std::size_t slot, const T *value) : epochs_(&epochs), slot_(slot), value_(value) {}
+
+        detail::Epochs *epochs_;
+        std::size_t slot_;
+        const T *value_;
+    };
+
+    /// Handle of one reader thread, holds a slot of [detail::Epochs] for as long as it lives
+    /// A reader has at most one [View] at a time, and must not outlive the reloader
+    class Reader {
+      public:
+        Reader(Reader &&other) noexcept : owner_(other.owner_), slot_(other.slot_) { other.owner_ = nullptr; }
+        ~Reader() {
+            if (owner_ != nullptr) {
+                owner_->epochs_.release(slot_);
+            }
+        }
+
+        Reader(const Reader &) = delete;
+        Reader &operator=(const Reader &) = delete;
+        Reader &operator=(Reader &&) = delete;
+
+        /// \return The latest snapshot
+        View read() const noexcept {
+            owner_->epochs_.enter(slot_);
+            return View(owner_->epochs_, slot_, owner_->current_.load());
+        }
+
+      private:
+        friend class Reloader;
+        Reader(Reloader &owner, const std::size_t slot) : owner_(&owner), slot_(slot) {}
+
+        Reloader *owner_;
+        std::size_t slot_;
+    };
+
+    /// Parses [args] over the config file at [path], and publishes the first snapshot
+    /// \param schema Called once, the parser is owned by the reloader
+    /// \param args   Input arguments, the first being the program, they take precedence over the file on every parse
+    /// \param path   The config file, see [Parser::set_config_file]
+    /// \throws The errors of [Parser::set_config_file] and [Parser::parse]
+    Reloader(const Schema &schema, std::vector<std::string> args, std::string path);
+
+    /// Frees every snapshot, no reader may be reading
+    ~Reloader();
+
+    Reloader(const Reloader &) = delete;
+    Reloader(Reloader &&) = delete;
+    Reloader &operator=(const Reloader &) = delete;
+    Reloader &operator=(Reloader &&) = delete;
+
+    /// \return A handle for a thread to read the snapshots with
+    /// \throws std::length_error if there are already [detail::Epochs::kSlots] readers
+    Reader reader() { return Reader(*this, epochs_.claim()); }
+
+    /// Reads the config file again, and publishes a new snapshot if any entry changed
+    /// If the file can not be read or parsed, the exception is thrown and the current snapshot stays published
+    /// \return The keys of the entries that changed, see [detail::diff], empty if none did
+    std::vector<std::string> reload();
+
+    /// Waits up to [timeout] for the config file to change, then reloads it
+    /// Snapshots replaced earlier are freed if no reader can still see them
+    /// \return The keys of the entries that changed
+    std::vector<std::string> poll(const std::chrono::milliseconds timeout);
+
+  private:
+    /// Parser of the schema, and how to extract a snapshot from it
+    Parser parser_;
+    Extract extract_;
+
+    /// Input arguments, and pointers to them to parse with
+    std::vector<std::string> args_;
+    std::vector<const char *> argv_;
+
+    /// Path of the config file, and the last file that was read
+    std::string path_;
+    std::shared_ptr<const detail::ConfigFile> file_;
+
+    /// Watch of the config file
+    detail::FileWatch watch_;
+
+    /// Epochs of the readers
+    detail::Epochs epochs_;
+
+    /// The latest snapshot
+    std::atomic<const T *> current_{nullptr};
+
+    /// Snapshots that were replaced, with the epoch that replaced them, freed once no reader is in an older epoch
+    std::vector<std::pair<uint64_t, std::unique_ptr<const T>>> retired_;
+
+    /// Serializes reloads
+    std::mutex mutex_;
+
+    /// Parses over [file_] and publishes the snapshot
+    void publish();
+
+    /// Frees the replaced snapshots no reader can still see
+    void reclaim();
+};
+
+template <typename T>
+Reloader<T>::Reloader(const Schema &schema, std::vector<std::string> args, std::string path) :
+    args_(std::move(args)),
+    path_(std::move(path)),
+    file_(std::make_shared<const detail::ConfigFile>(path_)),
+    watch_(path_) {
+    extract_ = schema(parser_);
+    argv_.reserve(args_.size());
+    for (const auto &arg : args_) {
+        argv_.push_back(arg.c_str());
+    }
+    publish();
+}
+
+template <typename T>
+Reloader<T>::~Reloader() {
+    delete current_.load();
+}
+
+template <typename T>
+std::vector<std::string> Reloader<T>::reload() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+
+    auto file = std::make_shared<const detail::ConfigFile>(path_);
+    auto changed = detail::diff(*file_, *file);
+    if (!changed.empty()) {
+        std::swap(file_, file);
+        try {
+            publish();
+        } catch (...) {
+            std::swap(file_, file);
+            throw;
+        }
+    }
+    return changed;
+}
+
+template <typename T>
+std::vector<std::string> Reloader<T>::poll(const std::chrono::milliseconds timeout) {
+    if (!watch_.wait(timeout)) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        reclaim();
+        return {};
+    }
+    return reload();
+}
+
+template <typename T>
+void Reloader<T>::publish() {
+    parser_.set_config_file(file_);
+    parser_.parse(static_cast<int>(argv_.size()), argv_.data());
+    auto fresh = std::make_unique<const T>(extract_());
+
+    // Readers that entered before the new epoch may still see the old snapshot
+    const T *old = current_.exchange(fresh.release());
+    if (old != nullptr) {
+        retired_.emplace_back(epochs_.advance(), std::unique_ptr<const T>(old));
+    }
+    reclaim();
+}
+
+template <typename T>
+void Reloader<T>::reclaim() {
+    const uint64_t oldest = epochs_.oldest();
+    retired_.erase(std::remove_if(retired_.begin(), retired_.end(), [oldest](const auto &retired) {
+        return retired.first <= oldest;
+    }), retired_.end());
+}
+
+} // namespace argparse
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "address.h"
+#include "cpu_set.h"
+#include "span.h"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace argparse {
+namespace detail {
+
+/// Appends values to a binary snapshot, in the byte order of the machine
+/// Values of trivially copyable types are copied as they are, strings and vectors are prefixed by their size
+class SnapshotWriter {
+  public:
+    explicit SnapshotWriter(std::string &out) : out_(out) {}
+
+    template <typename T>
+    void put(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values are copied as they are");
+        out_.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    void put(const std::string &value) { put(value.data(), value.size()); }
+    void put(const Span &value) { put(value.data, value.size); }
+    void put(const CpuSet &value) { put(value.words); }
+
+    /// Addresses and blocks are written field by field, so their flags and prefix lengths can be checked when read back
+    void put(const IpAddress &value) {
+        put(value.bytes);
+        put(value.v6);
+    }
+    void put(const Cidr &value) {
+        put(value.address);
+        put(value.prefix);
+    }
+
+    template <typename T>
+    void put(const std::vector<T> &values) {
+        put(static_cast<uint32_t>(values.size()));
+        for (const auto &value : values) {
+            put(value);
+        }
+    }
+
+  private:
+    std::string &out_;
+
+    void put(const char *data, const std::size_t size) {
+        put(static_cast<uint32_t>(size));
+        out_.append(data, size);
+    }
+};
+
+/// Reads values back from a snapshot written by [SnapshotWriter], in the same order
+/// The snapshot may live in a region that other processes write, so it is not trusted: every read is checked against
+/// the end of the snapshot, and values that their type can not hold are rejected
+/// \throws std::out_of_range if a value runs past the end of the snapshot
+/// \throws std::invalid_argument if a value is not one of its type
+class SnapshotReader {
+  public:
+    SnapshotReader(const char *data, const std::size_t size) : it_(data), end_(data + size) {}
+
+    template <typename T>
+    void get(T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values are copied as they are");
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+    }
+
+    /// A byte other than 0 or 1 is not a bool
+    void get(bool &value) {
+        uint8_t byte = 0;
+        get(byte);
+        if (byte > 1) {
+            throw std::invalid_argument("snapshot holds a bool that is neither true nor false");
+        }
+        value = (byte == 1);
+    }
+
+    void get(IpAddress &value) {
+        get(value.bytes);
+        get(value.v6);
+    }
+
+    /// A prefix longer than the address would index past its bytes
+    void get(Cidr &value) {
+        get(value.address);
+        get(value.prefix);
+        if (value.prefix > value.address.bits()) {
+            throw std::invalid_argument("snapshot holds a block with a prefix longer than its address");
+        }
+    }
+
+    void get(std::string &value) {
+        const auto span = text();
+        value.assign(span.data, span.size);
+    }
+
+    void get(CpuSet &value) { get(value.words); }
+
+    template <typename T>
+    void get(std::vector<T> &values) {
+        values.resize(count());
+        for (auto &value : values) {
+            get(value);
+        }
+    }
+
+    /// std::vector<bool> is packed, so its values are read one at a time
+    void get(std::vector<bool> &values) {
+        const std::size_t size = count();
+        values.resize(size);
+        for (std::size_t ii = 0; ii < size; ii++) {
+            bool value = false;
+            get(value);
+            values[ii] = value;
+        }
+    }
+
+    /// \return A size prefixed text, in place in the snapshot
+    Span text() {
+        uint32_t size = 0;
+        get(size);
+        return Span{take(size), size};
+    }
+
+    /// \return The size prefix of a vector, which is at most the bytes left since every value takes at least one, so a
+    /// corrupted size can not make a huge allocation
+    std::size_t count() {
+        uint32_t size = 0;
+        get(size);
+        if (size > static_cast<std::size_t>(end_ - it_)) {
+            throw std::out_of_range("snapshot is truncated");
+        }
+        return size;
+    }
+
+  private:
+    const char *it_;
+    const char *const end_;
+
+    /// \return The next [size] bytes, which are skipped
+    const char *take(const std::size_t size) {
+        if (size > static_cast<std::size_t>(end_ - it_)) {
+            throw std::out_of_range("snapshot is truncated");
+        }
+        const char *const at = it_;
+        it_ += size;
+        return at;
+    }
+};
+
+} // namespace detail
+} // namespace argparse
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace argparse {
+namespace detail {
+
+/// Non owning view of characters of an input argument
+/// The input arguments outlive the parse, so a span stays valid for as long as the parse needs it
+struct Span {
+    const char *data = nullptr;
+    std::size_t size = 0;
+
+    /// \return A copy of the characters
+    std::string str() const {
+        return std::string(data, size);
+    }
+
+    /// \return If the characters are the same as the [count] characters at [text]
+    /// An empty span may have no data, so nothing is compared when there is nothing to compare
+    bool equals(const char *text, const std::size_t count) const {
+        return (size == count) && ((count == 0) || (std::memcmp(data, text, count) == 0));
+    }
+
+    /// \return If the characters are the same as those of [text]
+    template <std::size_t N>
+    bool equals(const char (&text)[N]) const {
+        return equals(text, N - 1);
+    }
+};
+
+} // namespace detail
+} // namespace argparse
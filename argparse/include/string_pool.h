@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace argparse {
+namespace detail {
+
+/// FNV-1a hash of a string, used by the open addressing tables of the schema
+inline uint32_t hash_string(const char *data, const std::size_t size) {
+    uint32_t hash = 2166136261U;
+    for (std::size_t ii = 0; ii < size; ii++) {
+        hash ^= static_cast<uint8_t>(data[ii]);
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+/// Reference to a string in a [StringPool]
+struct PooledString {
+    uint32_t offset = 0; /// Offset of the first character in the pool
+    uint32_t size = 0;   /// Length, excluding the terminating NUL
+};
+
+/// Contiguous storage for the text of a schema, such as option names and help messages
+/// Each distinct string is stored once, so a parser, its copies and its subparsers can share one pool
+/// Strings are referred to by offset, since the storage moves when it grows
+class StringPool {
+  public:
+    /// Adds a string, or finds the same string added before
+    PooledString intern(const char *data, const std::size_t size);
+    PooledString intern(const std::string &s) { return intern(s.data(), s.size()); }
+
+    /// \return The NUL terminated characters of a string, valid until the next [intern]
+    const char *c_str(const PooledString s) const noexcept { return buffer_.data() + s.offset; }
+
+    /// \return Number of bytes of text held, including terminators
+    std::size_t bytes() const noexcept { return buffer_.size(); }
+
+  private:
+    /// Characters of every string, each followed by a NUL
+    std::vector<char> buffer_;
+
+    /// Every distinct string, in the order they were added
+    std::vector<PooledString> strings_;
+
+    /// Open addressing table of 1 + index into [strings_], 0 for an empty slot
+    /// The number of slots is a power of 2 and at least twice the number of strings
+    std::vector<uint32_t> slots_;
+
+    /// Doubles the number of slots and reinserts every string
+    void grow();
+};
+
+} // namespace detail
+} // namespace argparse
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace argparse {
+namespace detail {
+
+/// Edit distance from a pattern of at most 64 bytes to any text, by the bit-parallel algorithm of Myers
+/// A column of the edit distance table is kept as two words of vertical deltas, one bit per byte of the pattern, so each
+/// byte of the text costs a handful of word operations instead of a pass over the pattern
+/// Swapping two adjacent bytes counts as one edit, as extended by Hyyro, since it is the most common typo
+class EditDistance {
+  public:
+    /// Longest pattern, one bit per byte in a word
+    static constexpr std::size_t kMaxPattern = 64;
+
+    /// \param pattern At most [kMaxPattern] bytes
+    EditDistance(const char *pattern, const std::size_t size);
+
+    /// \return The number of insertions, deletions, substitutions and swaps to turn the pattern into [text]
+    ///         or a value above [bound], as soon as the distance can no longer be within [bound]
+    std::size_t operator()(const char *text, const std::size_t size, const std::size_t bound) const;
+
+  private:
+    /// Positions of each byte in the pattern, as bits
+    std::array<uint64_t, 256> positions_{};
+
+    /// Length of the pattern
+    std::size_t size_;
+};
+
+/// Names of the options grouped by length, to find the closest ones to a name that is not registered
+/// Only the groups within the distance bound of the length of the name are searched, and a name whose set of bytes is
+/// too different to be within the bound is skipped before computing its distance
+class Suggestions {
+  public:
+    /// Most suggestions for one name
+    static constexpr std::size_t kMaxSuggestions = 3;
+
+    /// Adds the name of an option
+    void add(const char *name, const std::size_t size, const std::size_t id);
+
+    /// Finds the names closest to [name], at most a third of its length away and at least 1, at most 3
+    /// \return Ids of the closest names, closest first, then in the order they were added
+    std::vector<std::size_t> suggest(const char *name, const std::size_t size) const;
+
+    /// \return Number of names
+    std::size_t size() const noexcept { return size_; }
+
+  private:
+    /// Names of the same length, each [length] bytes of [text] apart
+    struct Group {
+        std::string text;                  /// Every name, without separators
+        std::vector<uint64_t> signatures;  /// Bytes in each name, one bit for each byte modulo 64
+        std::vector<uint32_t> ids;         /// Id of each name
+    };
+
+    /// Groups by length
+    std::vector<Group> groups_;
+
+    /// Number of names
+    std::size_t size_ = 0;
+};
+
+} // namespace detail
+} // namespace argparse
@@ -0,0 +1,247 @@
+#pragma once
+
+#include "address.h"
+#include "convert.h"
+#include "placeholder.h"
+#include "snapshot.h"
+#include "std_optional.h"
+#include "units.h"
+#include "variant.h"
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace argparse {
+namespace detail {
+
+/// The part of an option with a fixed number of values that does not depend on their types
+/// See [Parser::add_array] and [Parser::add_tuple]
+struct TupleIndex {
+    /// Number of values
+    std::size_t arity = 0;
+
+    /// Types of the values, such as "double[4]" or "tuple<uint32_t,string>", shown in the help message
+    std::string signature;
+
+    /// Converts exactly [arity] values, each into its element of the value in place
+    /// Throws the exception of the conversion if a value can not be converted
+    /// \return False if a value is not allowed
+    bool (*assign)(TupleIndex &tuple, const std::vector<std::string> &values) = nullptr;
+
+    /// Converts a value of the element at [index] only to check it
+    bool (*check)(const TupleIndex &tuple, const std::size_t index, const std::string &value) = nullptr;
+
+    /// Restores the default value, or no value if there is no default
+    void (*reset)(TupleIndex &tuple) = nullptr;
+
+    /// @{ Saves and loads the value, see [Parser::set_cache]
+    void (*save)(const TupleIndex &tuple, SnapshotWriter &out) = nullptr;
+    void (*load)(TupleIndex &tuple, SnapshotReader &in) = nullptr;
+    /// @}
+};
+
+/// A parameter of type [V] whose template arguments are not deduced from the argument, so a default value can be
+/// passed as it is to a function whose types of values are given explicitly
+template <typename V>
+using NotDeduced = typename std::enable_if<true, V>::type;
+
+/// Allowed values of the elements, only arrays have them since every element has the same type
+template <typename V>
+struct AllowedElements {
+    using type = std::tuple<>;
+};
+template <typename T, std::size_t N>
+struct AllowedElements<std::array<T, N>> {
+    using type = std::unordered_set<T, Hash<T>>;
+};
+template <std::size_t N>
+struct AllowedElements<std::array<IpAddress, N>> {
+    using type = PrefixTrie;
+};
+template <std::size_t N>
+struct AllowedElements<std::array<Cidr, N>> {
+    using type = PrefixTrie;
+};
+
+/// @{ \return True if there are no allowed values or the element is one of them
+template <typename T>
+bool allowed_element(const std::tuple<> & /*allowed*/, const T & /*element*/) {
+    return true;
+}
+template <typename T>
+bool allowed_element(const std::unordered_set<T, Hash<T>> &allowed, const T &element) {
+    return allowed.empty() || (allowed.count(element) != 0);
+}
+template <typename T>
+bool allowed_element(const PrefixTrie &allowed, const T &element) {
+    return allowed.empty() || allowed.contains(element);
+}
+/// @}
+
+/// @{ Converts a value into an element, strings are assigned so they keep their capacity
+template <typename T>
+void assign_element(T &element, const std::string &value) {
+    element = convert_helper<T>(value);
+}
+inline void assign_element(std::string &element, const std::string &value) {
+    element.assign(value);
+}
+/// @}
+
+/// \return Name of the type of an element
+template <typename T>
+std::string type_name() {
+    return enum_to_str(Variant{T{}}.type());
+}
+
+/// Spells the types of the values, arrays as "T[N]" and tuples as "tuple<Ts...>"
+template <typename V>
+struct Signature;
+template <typename T, std::size_t N>
+struct Signature<std::array<T, N>> {
+    static std::string spell() { return type_name<T>() + "[" + std::to_string(N) + "]"; }
+};
+template <typename... Ts>
+struct Signature<std::tuple<Ts...>> {
+    static std::string spell() {
+        std::string out = "tuple<";
+        (void)std::initializer_list<int>{(out += type_name<Ts>(), out += ",", 0)...};
+        out.back() = '>';
+        return out;
+    }
+};
+
+/// Value of an option with a fixed number of values, [V] is a [std::array] or a [std::tuple]
+/// The values are converted into the elements of [converted], which is swapped into the placeholder once every element
+/// converts and is allowed, so a value that fails part way never shows
+template <typename V>
+struct TupleValue : TupleIndex {
+    using Indices = std::make_index_sequence<std::tuple_size<V>::value>;
+
+    /// The value
+    PlaceHolder<V> placeholder = std::make_shared<PlaceHolderType<V>>();
+
+    /// The default value, if there is one
+    pstd::optional<V> default_value;
+
+    /// Allowed values of every element, see [AllowedElements]
+    typename AllowedElements<V>::type allowed_values;
+
+    /// The value being converted, which keeps the buffers of the value it was swapped with
+    V converted{};
+
+    TupleValue() {
+        arity = std::tuple_size<V>::value;
+        signature = Signature<V>::spell();
+        assign = &TupleValue::assign_values;
+        check = &TupleValue::check_value;
+        reset = &TupleValue::reset_value;
+        save = &TupleValue::save_value;
+        load = &TupleValue::load_value;
+    }
+
+    /// \return The elements of [value] joined by commas, as they are given on the command line
+    static std::string spell(const V &value) { return spell(value, Indices{}); }
+
+  private:
+    static bool assign_values(TupleIndex &index, const std::vector<std::string> &values) {
+        auto &self = static_cast<TupleValue &>(index);
+        if (!self.assign_elements(self.converted, values, Indices{})) {
+            return false;
+        }
+
+        auto &optional = *self.placeholder;
+        if (optional.has_value()) {
+            std::swap(optional.value(), self.converted);
+        } else {
+            optional.emplace(std::move(self.converted));
+        }
+        return true;
+    }
+
+    static bool check_value(const TupleIndex &index, const std::size_t element, const std::string &value) {
+        return check_at(static_cast<const TupleValue &>(index), element, value, Indices{});
+    }
+
+    static void reset_value(TupleIndex &index) {
+        auto &self = static_cast<TupleValue &>(index);
+        *self.placeholder = self.default_value;
+    }
+
+    static void save_value(const TupleIndex &index, SnapshotWriter &out) {
+        const auto &optional = *static_cast<const TupleValue &>(index).placeholder;
+        out.put(optional.has_value());
+        if (optional.has_value()) {
+            save_elements(optional.value(), out, Indices{});
+        }
+    }
+
+    static void load_value(TupleIndex &index, SnapshotReader &in) {
+        auto &optional = *static_cast<TupleValue &>(index).placeholder;
+        bool has_value = false;
+        in.get(has_value);
+        if (has_value) {
+            load_elements(optional.emplace(), in, Indices{});
+        } else {
+            optional = pstd::nullopt;
+        }
+    }
+
+    /// Converts each value into its element, up to the first that is not allowed
+    template <std::size_t... Is>
+    bool assign_elements(V &value, const std::vector<std::string> &values, std::index_sequence<Is...>) const {
+        bool ok = true;
+        (void)std::initializer_list<int>{(ok = ok && convert_element<Is>(value, values[Is]), 0)...};
+        return ok;
+    }
+
+    template <std::size_t I>
+    bool convert_element(V &value, const std::string &s) const {
+        auto &element = std::get<I>(value);
+        detail::assign_element(element, s);
+        return allowed_element(allowed_values, element);
+    }
+
+    /// Checks a value of the element at a runtime [index], through a table of one check per element
+    template <std::size_t... Is>
+    static bool check_at(const TupleValue &self, const std::size_t index, const std::string &s, std::index_sequence<Is...>) {
+        using Check = bool (*)(const TupleValue &self, const std::string &s);
+        static constexpr Check kChecks[] = {&TupleValue::check_element<Is>...};
+        return kChecks[index](self, s);
+    }
+
+    template <std::size_t I>
+    static bool check_element(const TupleValue &self, const std::string &s) {
+        std::tuple_element_t<I, V> element{};
+        detail::assign_element(element, s);
+        return allowed_element(self.allowed_values, element);
+    }
+
+    template <std::size_t... Is>
+    static void save_elements(const V &value, SnapshotWriter &out, std::index_sequence<Is...>) {
+        (void)std::initializer_list<int>{(out.put(std::get<Is>(value)), 0)...};
+    }
+
+    template <std::size_t... Is>
+    static void load_elements(V &value, SnapshotReader &in, std::index_sequence<Is...>) {
+        (void)std::initializer_list<int>{(in.get(std::get<Is>(value)), 0)...};
+    }
+
+    template <std::size_t... Is>
+    static std::string spell(const V &value, std::index_sequence<Is...>) {
+        std::string out;
+        (void)std::initializer_list<int>{(out += ((Is == 0) ? "" : ","), out += Variant{std::get<Is>(value)}.string(), 0)...};
+        return out;
+    }
+};
+
+} // namespace detail
+} // namespace argparse
@@ -16,6 +16,14 @@ enum class Type {
     kInt8,   /// int8_t
     kBool,   /// bool
     kChar,   /// char
+    kBytes,    /// Bytes
+    kDuration, /// Duration
+    kRate,     /// Rate
+    kCpuSet,   /// CpuSet
+    kIpAddress, /// IpAddress
+    kCidr,      /// Cidr
+    kChoice,   /// Enum chosen by spelling, see [Parser::add_choice]
+    kTuple,    /// Fixed number of values, see [Parser::add_array] and [Parser::add_tuple]
 };
 
 /// Convert [Type] to string
@@ -34,6 +42,14 @@ constexpr const char * enum_to_str(const Type type) {
     case Type::kInt8   : return "int8_t";   break;
     case Type::kBool   : return "bool";     break;
     case Type::kChar   : return "char";     break;
+    case Type::kBytes    : return "bytes";    break;
+    case Type::kDuration : return "duration"; break;
+    case Type::kRate     : return "rate";     break;
+    case Type::kCpuSet   : return "cpu_set";  break;
+    case Type::kIpAddress : return "ip_address"; break;
+    case Type::kCidr      : return "cidr";       break;
+    case Type::kChoice   : return "choice";   break;
+    case Type::kTuple    : return "tuple";    break;
     case Type::kNone:
     default:
         break;
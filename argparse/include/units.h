@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace argparse {
+
+/// A number of bytes, given with an SI or IEC suffix such as "500MB" or "4GiB"
+struct Bytes {
+    uint64_t count; /// Number of bytes
+};
+
+/// A length of time, given in units from "ns" through "h", such as "250ms" or "1h30m"
+using Duration = std::chrono::nanoseconds;
+
+/// A number of events per period, such as "10k/s" or "500/100ms"
+struct Rate {
+    uint64_t count;  /// Number of events in [period]
+    Duration period; /// Period of the events, one second if none is given
+
+    /// \return The number of events per second
+    double per_second() const {
+        return static_cast<double>(count) * 1e9 / static_cast<double>(period.count());
+    }
+};
+
+/// @{ Equality compares the values as given, "1k/s" is not equal to "1/ms"
+inline bool operator==(const Bytes &lhs, const Bytes &rhs) { return lhs.count == rhs.count; }
+inline bool operator!=(const Bytes &lhs, const Bytes &rhs) { return !(lhs == rhs); }
+inline bool operator==(const Rate &lhs, const Rate &rhs) { return lhs.count == rhs.count && lhs.period == rhs.period; }
+inline bool operator!=(const Rate &lhs, const Rate &rhs) { return !(lhs == rhs); }
+/// @}
+
+namespace detail {
+
+/// @{ Parses a value from a span of characters without allocating
+/// Fractions are allowed where they make a whole number of the smallest unit, such as "1.5GiB" or "0.5s"
+/// \throws std::invalid_argument if the characters are not a value of the type
+/// \throws std::out_of_range if the value does not fit
+Bytes parse_bytes(const char *data, const std::size_t size);
+Duration parse_duration(const char *data, const std::size_t size);
+Rate parse_rate(const char *data, const std::size_t size);
+/// @}
+
+/// @{ Formats a value with the largest unit that keeps it exact, the inverse of the parse functions
+std::string format(const Bytes &bytes);
+std::string format(const Duration &duration);
+std::string format(const Rate &rate);
+/// @}
+
+/// Hashes durations, which the standard library has no hash for and which, being a standard type, only the standard
+/// library may specialize [std::hash] for
+struct DurationHash {
+    std::size_t operator()(const Duration &duration) const {
+        return std::hash<Duration::rep>{}(duration.count());
+    }
+};
+
+/// @{ Hash of the values of type [T], used by the sets of allowed values and by [Variant::hash]
+/// The one of the standard library, or of the type, except for durations
+template <typename T>
+struct Hasher {
+    using type = std::hash<T>;
+};
+template <>
+struct Hasher<Duration> {
+    using type = DurationHash;
+};
+template <typename T>
+using Hash = typename Hasher<T>::type;
+/// @}
+
+} // namespace detail
+} // namespace argparse
+
+namespace std {
+
+template <>
+struct hash<argparse::Bytes> {
+    std::size_t operator()(const argparse::Bytes &bytes) const {
+        return std::hash<uint64_t>{}(bytes.count);
+    }
+};
+
+template <>
+struct hash<argparse::Rate> {
+    std::size_t operator()(const argparse::Rate &rate) const {
+        return std::hash<uint64_t>{}(rate.count) ^ (std::hash<argparse::Duration::rep>{}(rate.period.count()) << 1);
+    }
+};
+
+} // namespace std
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+/// Minimal SystemTap style USDT probes, laid out the same as <sys/sdt.h> so no package is needed
+/// Each probe site is a single nop, plus an ELF note in [.note.stapsdt] describing where the arguments live
+/// Tracers attach by provider and name, for example with bpftrace:
+///     bpftrace -e 'usdt:./libargparse.so:argparse:parse_entry { @start[tid] = nsecs; }'
+/// Arguments are widened to 64 bits, pointers and unsigned values are unsigned, token indices are signed (-1 for none)
+/// Define [ARGPARSE_DISABLE_USDT] to compile the probes out, unsupported targets always compile them out
+
+#if !defined(ARGPARSE_DISABLE_USDT) && defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+#define ARGPARSE_USDT 1
+#else
+#define ARGPARSE_USDT 0
+#endif
+
+namespace argparse {
+namespace detail {
+
+/// @{ Widens a probe argument to a 64 bit register sized value
+inline uint64_t usdt_arg(const void *value) { return reinterpret_cast<uintptr_t>(value); }
+inline uint64_t usdt_arg(const uint64_t value) { return value; }
+inline int64_t usdt_arg(const int64_t value) { return value; }
+inline int64_t usdt_arg(const int32_t value) { return value; }
+/// @}
+
+} // namespace detail
+} // namespace argparse
+
+#if ARGPARSE_USDT
+
+#if defined(__x86_64__)
+#define ARGPARSE_USDT_CONSTRAINT "nor"
+#else
+#define ARGPARSE_USDT_CONSTRAINT "r"
+#endif
+
+/// The format of a single argument, the operand is substituted by the compiler
+/// The size operand is printed negated by [%n], so signed values are passed as 8 to produce "-8@"
+#define ARGPARSE_USDT_FORMAT(operand) "%n[" #operand "_size]@%[" #operand "]"
+#define ARGPARSE_USDT_OPERAND(operand, arg)                                                           \
+    [operand##_size] "n" (std::is_signed<decltype(argparse::detail::usdt_arg(arg))>::value ? 8 : -8),    \
+    [operand] ARGPARSE_USDT_CONSTRAINT (argparse::detail::usdt_arg(arg))
+
+/// The probe site followed by the note describing it
+/// [_.stapsdt.base] lets tracers adjust the probe address when the section is relocated by prelinking
+#define ARGPARSE_USDT_ASM(name, format)                                                                \
+    "990: nop\n"                                                                                       \
+    ".pushsection .note.stapsdt,\"?\",\"note\"\n"                                                    \
+    ".balign 4\n"                                                                                      \
+    ".4byte 992f-991f, 994f-993f, 3\n"                                                                 \
+    "991: .asciz \"stapsdt\"\n"                                                                        \
+    "992: .balign 4\n"                                                                                 \
+    "993: .8byte 990b\n"                                                                               \
+    ".8byte _.stapsdt.base\n"                                                                          \
+    ".8byte 0\n"                                                                                       \
+    ".asciz \"argparse\"\n"                                                                            \
+    ".asciz \"" #name "\"\n"                                                                           \
+    ".asciz \"" format "\"\n"                                                                          \
+    "994: .balign 4\n"                                                                                 \
+    ".popsection\n"                                                                                    \
+    ".ifndef _.stapsdt.base\n"                                                                         \
+    ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"                          \
+    ".weak _.stapsdt.base\n"                                                                           \
+    ".hidden _.stapsdt.base\n"                                                                         \
+    "_.stapsdt.base: .space 1\n"                                                                       \
+    ".size _.stapsdt.base, 1\n"                                                                        \
+    ".popsection\n"                                                                                    \
+    ".endif\n"
+
+/// @{ Probes with 1 to 3 arguments
+#define ARGPARSE_USDT_PROBE1(name, a1)                                                                 \
+    __asm__ __volatile__(ARGPARSE_USDT_ASM(name, ARGPARSE_USDT_FORMAT(p1))                             \
+                         :: ARGPARSE_USDT_OPERAND(p1, a1))
+#define ARGPARSE_USDT_PROBE2(name, a1, a2)                                                             \
+    __asm__ __volatile__(ARGPARSE_USDT_ASM(name, ARGPARSE_USDT_FORMAT(p1) " " ARGPARSE_USDT_FORMAT(p2)) \
+                         :: ARGPARSE_USDT_OPERAND(p1, a1), ARGPARSE_USDT_OPERAND(p2, a2))
+#define ARGPARSE_USDT_PROBE3(name, a1, a2, a3)                                                         \
+    __asm__ __volatile__(ARGPARSE_USDT_ASM(name, ARGPARSE_USDT_FORMAT(p1) " " ARGPARSE_USDT_FORMAT(p2) \
+                                                 " " ARGPARSE_USDT_FORMAT(p3))                         \
+                         :: ARGPARSE_USDT_OPERAND(p1, a1), ARGPARSE_USDT_OPERAND(p2, a2),              \
+                            ARGPARSE_USDT_OPERAND(p3, a3))
+/// @}
+
+#else
+
+/// The arguments are not evaluated
+#define ARGPARSE_USDT_PROBE1(name, a1) do { (void)sizeof(a1); } while (false)
+#define ARGPARSE_USDT_PROBE2(name, a1, a2) do { (void)sizeof(a1); (void)sizeof(a2); } while (false)
+#define ARGPARSE_USDT_PROBE3(name, a1, a2, a3) do { (void)sizeof(a1); (void)sizeof(a2); (void)sizeof(a3); } while (false)
+
+#endif
@@ -1,32 +1,37 @@
 #pragma once
 
-#include <sstream>
+#include <cstddef>
 #include <string>
 #include <vector>
 
-/// For each string in the vector, split into separate strings by comma
+/// Calls [f] with the (pointer, length) of each non empty comma separated part of a string
 /// For example:
-///     "a,b,c" => {"a", "b", "c"}
-inline void split_values(std::vector<std::string> &values) {
+///     "a,,b,c" => f("a", 1), f("b", 1), f("c", 1)
+template <typename Function>
+void for_each_value(const char *s, const std::size_t length, Function &&f) {
     constexpr char kDelimiter = ',';
 
-    std::vector<std::string> additional;
-
-    for (auto &value : values) {
-        // Split value if possible
-        std::vector<std::string> splitted_values;
-        std::string splitted_value;
-        std::istringstream iss(value);
-        while (getline(iss, splitted_value, kDelimiter)) {
-            if (!splitted_value.empty()) {
-                splitted_values.push_back(std::move(splitted_value));
+    std::size_t start = 0;
+    for (std::size_t ii = 0; ii <= length; ii++) {
+        if (ii == length || s[ii] == kDelimiter) {
+            if (ii > start) {
+                f(s + start, ii - start);
             }
+            start = ii + 1;
         }
+    }
+}
 
-        std::move(splitted_values.begin(), splitted_values.end(), std::back_inserter(additional));
+/// For each string in the vector, split into separate strings by comma
+/// For example:
+///     "a,b,c" => {"a", "b", "c"}
+inline void split_values(std::vector<std::string> &values) {
+    std::vector<std::string> splitted_values;
+    for (const auto &value : values) {
+        for_each_value(value.data(), value.length(), [&splitted_values](const char *s, const std::size_t length) {
+            splitted_values.emplace_back(s, length);
+        });
     }
 
-    // Move other vector into original vector
-    values.clear();
-    std::move(additional.begin(), additional.end(), std::back_inserter(values));
+    values = std::move(splitted_values);
 }
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "address.h"
+#include "cpu_set.h"
 #include "type.h"
+#include "units.h"
 
 #include <cassert>
 #include <string>
@@ -8,13 +11,26 @@
 namespace argparse {
 
 /// Checks if a type is supported by this library
-/// Either [std::string] or a fundamental type
+/// Either [std::string], a fundamental type, one of the unit types [Bytes], [Duration] and [Rate], [CpuSet], or one of
+/// the address types [IpAddress] and [Cidr]
 template <typename T>
 constexpr bool supported() {
     if (std::is_same<T, std::string>::value) {
         return true;
     }
 
+    if (std::is_same<T, Bytes>::value || std::is_same<T, Duration>::value || std::is_same<T, Rate>::value) {
+        return true;
+    }
+
+    if (std::is_same<T, CpuSet>::value) {
+        return true;
+    }
+
+    if (std::is_same<T, IpAddress>::value || std::is_same<T, Cidr>::value) {
+        return true;
+    }
+
     return std::is_fundamental<T>::value;
 }
 
@@ -43,6 +59,9 @@ class Variant {
     /// Converts the current value into a string
     std::string string() const;
 
+    /// \return The type of the current value
+    Type type() const noexcept { return type_; }
+
     /// Any assignment operator, but bounded by valid union types
     template <typename T>
     Variant &operator=(T value) {
@@ -67,6 +86,40 @@ class Variant {
         case Type::kInt8   : return visitor(int8_t_);
         case Type::kBool   : return visitor(bool_);
         case Type::kChar   : return visitor(char_);
+        case Type::kBytes    : return visitor(bytes_);
+        case Type::kDuration : return visitor(duration_);
+        case Type::kRate     : return visitor(rate_);
+        case Type::kCpuSet   : return visitor(cpu_set_);
+        case Type::kIpAddress : return visitor(ip_address_);
+        case Type::kCidr      : return visitor(cidr_);
+        case Type::kNone   :
+        default            : assert(false);
+        }
+    }
+
+    /// Visitor method for a const variant
+    template <typename Visitor>
+    decltype(auto) visit(Visitor &&visitor) const {
+        switch (type_) {
+        case Type::kString : return visitor(string_);
+        case Type::kDouble : return visitor(double_);
+        case Type::kFloat  : return visitor(float_);
+        case Type::kUint64 : return visitor(uint64_t_);
+        case Type::kInt64  : return visitor(int64_t_);
+        case Type::kUint32 : return visitor(uint32_t_);
+        case Type::kInt32  : return visitor(int32_t_);
+        case Type::KUint16 : return visitor(uint16_t_);
+        case Type::KInt16  : return visitor(int16_t_);
+        case Type::kUint8  : return visitor(uint8_t_);
+        case Type::kInt8   : return visitor(int8_t_);
+        case Type::kBool   : return visitor(bool_);
+        case Type::kChar   : return visitor(char_);
+        case Type::kBytes    : return visitor(bytes_);
+        case Type::kDuration : return visitor(duration_);
+        case Type::kRate     : return visitor(rate_);
+        case Type::kCpuSet   : return visitor(cpu_set_);
+        case Type::kIpAddress : return visitor(ip_address_);
+        case Type::kCidr      : return visitor(cidr_);
         case Type::kNone   :
         default            : assert(false);
         }
@@ -87,6 +140,12 @@ class Variant {
     bool operator==(const int8_t &value) const;
     bool operator==(const bool &value) const;
     bool operator==(const char &value) const;
+    bool operator==(const Bytes &value) const;
+    bool operator==(const Duration &value) const;
+    bool operator==(const Rate &value) const;
+    bool operator==(const CpuSet &value) const;
+    bool operator==(const IpAddress &value) const;
+    bool operator==(const Cidr &value) const;
     /// @}
 
     /// Functor for hashing this object
@@ -114,12 +173,18 @@ class Variant {
         int8_t int8_t_;
         bool bool_;
         char char_;
+        Bytes bytes_;
+        Duration duration_;
+        Rate rate_;
+        CpuSet cpu_set_;
+        IpAddress ip_address_;
+        Cidr cidr_;
     };
 
     /// Copies the value of another instance
     void copy(const Variant &other);
 
-    /// Only std::string needs a destructor, so destruct it when it is going out of scope
+    /// Only std::string and CpuSet need a destructor, so destruct them when they are going out of scope
     void destroy();
 
     /// @{ Calls any destructors, sets the tag, then placement new's the new value
@@ -137,6 +202,12 @@ class Variant {
     void set(int8_t value);
     void set(bool value);
     void set(char value);
+    void set(Bytes value);
+    void set(Duration value);
+    void set(Rate value);
+    void set(CpuSet value);
+    void set(IpAddress value);
+    void set(Cidr value);
     /// @}
 };
 
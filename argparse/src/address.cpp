@@ -0,0 +1,335 @@
+#include "address.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace argparse {
+
+namespace {
+
+bool is_digit(const char c) {
+    return (c >= '0') && (c <= '9');
+}
+
+/// \return The value of a hexadecimal digit, or -1 if [c] is not one
+int hex_digit(const char c) {
+    if (is_digit(c)) {
+        return c - '0';
+    }
+    if ((c >= 'a') && (c <= 'f')) {
+        return c - 'a' + 10;
+    }
+    if ((c >= 'A') && (c <= 'F')) {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/// \return If the address starting at [it] is an IPv6 address, which has a colon before its prefix length
+bool is_v6(const char *it, const char *const end) {
+    for (; (it != end) && (*it != '/'); it++) {
+        if (*it == ':') {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Parses a decimal number of up to 3 digits and at most [max], without leading zeros
+/// \return The first character after the number
+const char *parse_decimal(const char *it, const char *const end, const unsigned max, unsigned &number) {
+    const char *const start = it;
+    number = 0;
+    for (; (it != end) && is_digit(*it) && (it - start < 3); it++) {
+        number = number * 10 + static_cast<unsigned>(*it - '0');
+    }
+
+    const bool leading_zero = (it - start > 1) && (*start == '0');
+    if ((it == start) || leading_zero || ((it != end) && is_digit(*it))) {
+        throw std::invalid_argument("expected an address such as 192.0.2.1 or 2001:db8::1");
+    }
+    if (number > max) {
+        throw std::invalid_argument("number of an address is above " + std::to_string(max));
+    }
+
+    return it;
+}
+
+/// Parses the 4 numbers of an IPv4 address into [out]
+/// \return The first character after the address
+const char *parse_v4(const char *it, const char *const end, uint8_t *out) {
+    for (std::size_t ii = 0; ii < 4; ii++) {
+        if (ii != 0) {
+            if ((it == end) || (*it != '.')) {
+                throw std::invalid_argument("expected an address such as 192.0.2.1");
+            }
+            it++;
+        }
+        unsigned number = 0;
+        it = parse_decimal(it, end, 255, number);
+        out[ii] = static_cast<uint8_t>(number);
+    }
+    return it;
+}
+
+/// Parses the groups of an IPv6 address into [out]
+/// \return The first character after the address
+const char *parse_v6(const char *it, const char *const end, uint8_t *out) {
+    constexpr std::size_t kNoGap = 8;
+    const auto malformed = [] { return std::invalid_argument("expected an address such as 2001:db8::1"); };
+    const auto done = [end](const char *at) { return (at == end) || (*at == '/'); };
+
+    // The groups before and after "::" are read in place, then the ones after are moved to the end
+    std::size_t groups = 0;
+    std::size_t gap = kNoGap;
+    if ((end - it >= 2) && (it[0] == ':') && (it[1] == ':')) {
+        gap = 0;
+        it += 2;
+    }
+
+    while (!done(it)) {
+        // An IPv4 address takes the last 2 groups, it is the only part with a dot before the next colon
+        const char *next = it;
+        while ((next != end) && (hex_digit(*next) >= 0)) {
+            next++;
+        }
+        if ((next != end) && (*next == '.')) {
+            if (groups > 6) {
+                throw malformed();
+            }
+            it = parse_v4(it, end, out + groups * 2);
+            groups += 2;
+            break;
+        }
+
+        if ((next == it) || (next - it > 4) || (groups == 8)) {
+            throw malformed();
+        }
+        unsigned group = 0;
+        for (; it != next; it++) {
+            group = group * 16 + static_cast<unsigned>(hex_digit(*it));
+        }
+        out[groups * 2] = static_cast<uint8_t>(group >> 8U);
+        out[groups * 2 + 1] = static_cast<uint8_t>(group & 0xFFU);
+        groups++;
+
+        if (done(it)) {
+            break;
+        }
+        if (*it != ':') {
+            throw malformed();
+        }
+        it++;
+        if ((it != end) && (*it == ':')) {
+            if (gap != kNoGap) {
+                throw malformed();
+            }
+            gap = groups;
+            it++;
+        } else if (done(it)) {
+            // A colon that ends the address
+            throw malformed();
+        }
+    }
+
+    if (!done(it)) {
+        throw malformed();
+    }
+
+    if (gap == kNoGap) {
+        if (groups != 8) {
+            throw malformed();
+        }
+        return it;
+    }
+
+    // "::" stands for at least one group of zeros
+    if (groups == 8) {
+        throw malformed();
+    }
+    const std::size_t moved = (groups - gap) * 2;
+    std::memmove(out + 16 - moved, out + gap * 2, moved);
+    std::memset(out + gap * 2, 0, 16 - groups * 2);
+    return it;
+}
+
+/// Parses an address of either family
+/// \return The first character after the address
+const char *parse_address(const char *it, const char *const end, IpAddress &address) {
+    address.v6 = is_v6(it, end);
+    return address.v6 ? parse_v6(it, end, address.bytes.data()) : parse_v4(it, end, address.bytes.data());
+}
+
+} // namespace
+
+bool Cidr::contains(const IpAddress &other) const noexcept {
+    if (other.v6 != address.v6) {
+        return false;
+    }
+
+    const std::size_t whole = prefix / 8;
+    if (!std::equal(address.bytes.begin(), address.bytes.begin() + whole, other.bytes.begin())) {
+        return false;
+    }
+
+    const std::size_t rest = prefix % 8;
+    const auto mask = static_cast<uint8_t>(0xFF00U >> rest);
+    return (rest == 0) || ((address.bytes[whole] & mask) == (other.bytes[whole] & mask));
+}
+
+namespace detail {
+
+IpAddress parse_ip_address(const char *data, const std::size_t size) {
+    IpAddress address;
+    const char *const end = data + size;
+    if (parse_address(data, end, address) != end) {
+        throw std::invalid_argument("expected an address such as 192.0.2.1 or 2001:db8::1");
+    }
+    return address;
+}
+
+Cidr parse_cidr(const char *data, const std::size_t size) {
+    Cidr block;
+    const char *const end = data + size;
+    const char *it = parse_address(data, end, block.address);
+    const std::size_t bits = block.address.bits();
+    if (it == end) {
+        block.prefix = static_cast<uint8_t>(bits);
+        return block;
+    }
+
+    // Past the address is only a slash and the prefix length
+    if (*it != '/') {
+        throw std::invalid_argument("expected a block such as 10.0.0.0/8 or 2001:db8::/32");
+    }
+    unsigned prefix = 0;
+    it = parse_decimal(it + 1, end, 999, prefix);
+    if (it != end) {
+        throw std::invalid_argument("expected a block such as 10.0.0.0/8 or 2001:db8::/32");
+    }
+    if (prefix > bits) {
+        throw std::out_of_range("prefix length is above " + std::to_string(bits));
+    }
+    block.prefix = static_cast<uint8_t>(prefix);
+
+    // Clear the bits after the prefix
+    auto &bytes = block.address.bytes;
+    if (prefix % 8 != 0) {
+        bytes[prefix / 8] &= static_cast<uint8_t>(0xFF00U >> (prefix % 8));
+    }
+    std::fill(bytes.begin() + (prefix + 7) / 8, bytes.end(), 0);
+
+    return block;
+}
+
+std::string format(const IpAddress &address) {
+    const auto &bytes = address.bytes;
+    const auto dotted = [&bytes](std::string &out, const std::size_t first) {
+        for (std::size_t ii = first; ii < first + 4; ii++) {
+            if (ii != first) {
+                out += '.';
+            }
+            out += std::to_string(bytes[ii]);
+        }
+    };
+
+    std::string out;
+    if (!address.v6) {
+        dotted(out, 0);
+        return out;
+    }
+
+    // IPv4 mapped addresses keep their IPv4 part
+    const bool mapped = std::all_of(bytes.begin(), bytes.begin() + 10, [](const uint8_t b) { return b == 0; }) &&
+                        (bytes[10] == 0xFF) && (bytes[11] == 0xFF);
+    if (mapped) {
+        out = "::ffff:";
+        dotted(out, 12);
+        return out;
+    }
+
+    // The first of the longest runs of at least 2 groups of zeros is shortened to "::"
+    std::array<unsigned, 8> groups{};
+    for (std::size_t ii = 0; ii < 8; ii++) {
+        groups[ii] = (static_cast<unsigned>(bytes[ii * 2]) << 8U) | bytes[ii * 2 + 1];
+    }
+    std::size_t gap = 8;
+    std::size_t gap_length = 1;
+    for (std::size_t ii = 0; ii < 8;) {
+        std::size_t length = 0;
+        while ((ii + length < 8) && (groups[ii + length] == 0)) {
+            length++;
+        }
+        if (length > gap_length) {
+            gap = ii;
+            gap_length = length;
+        }
+        ii += std::max<std::size_t>(length, 1);
+    }
+
+    static constexpr char kDigits[] = "0123456789abcdef";
+    for (std::size_t ii = 0; ii < 8; ii++) {
+        if (ii == gap) {
+            out += "::";
+            ii += gap_length - 1;
+            continue;
+        }
+        if ((ii != 0) && (ii != gap + gap_length)) {
+            out += ':';
+        }
+        bool leading = true;
+        for (int shift = 12; shift >= 0; shift -= 4) {
+            const unsigned digit = (groups[ii] >> static_cast<unsigned>(shift)) & 0xFU;
+            if (leading && (digit == 0) && (shift != 0)) {
+                continue;
+            }
+            leading = false;
+            out += kDigits[digit];
+        }
+    }
+
+    return out;
+}
+
+std::string format(const Cidr &block) {
+    return format(block.address) + "/" + std::to_string(block.prefix);
+}
+
+void PrefixTrie::insert(const Cidr &block) {
+    uint32_t node = block.address.v6 ? 1 : 0;
+    for (std::size_t ii = 0; ii < block.prefix; ii++) {
+        const std::size_t bit = block.address.bit(ii) ? 1 : 0;
+        if (nodes_[node].children[bit] == 0) {
+            nodes_[node].children[bit] = static_cast<uint32_t>(nodes_.size());
+            nodes_.emplace_back();
+        }
+        node = nodes_[node].children[bit];
+    }
+
+    if (!nodes_[node].terminal) {
+        nodes_[node].terminal = true;
+        blocks_++;
+    }
+}
+
+pstd::optional<std::size_t> PrefixTrie::longest_match(const IpAddress &address, const std::size_t bits) const noexcept {
+    pstd::optional<std::size_t> longest;
+    uint32_t node = address.v6 ? 1 : 0;
+    for (std::size_t ii = 0;; ii++) {
+        if (nodes_[node].terminal) {
+            longest = ii;
+        }
+        if (ii == bits) {
+            break;
+        }
+        node = nodes_[node].children[address.bit(ii) ? 1 : 0];
+        if (node == 0) {
+            break;
+        }
+    }
+    return longest;
+}
+
+} // namespace detail
+} // namespace argparse
@@ -1,17 +1,29 @@
 #include "argparse.h"
 
 #include "args.h"
+#include "completion.h"
+#include "config_file.h"
 #include "convert.h"
+#include "environment.h"
 #include "exceptions.h"
 #include "options.h"
+#include "parse_cache.h"
 #include "parser.h"
+#include "profiler.h"
+#include "snapshot.h"
+#include "suggest.h"
+#include "usdt.h"
 #include "utils.h"
 #include "variant.h"
 
+#include <atomic>
 #include <cassert>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 
 namespace argparse {
 
@@ -41,6 +53,34 @@ void log_error(Args && ... args) {
     std::cout << ss.str() << kRevertColorCode;
 }
 
+/// The value recorded for lazy booleans that are present
+const std::vector<detail::Span> kTrue{detail::Span{"true", 4}};
+
+/// The value recorded for lazy booleans turned off by their environment variable
+const std::vector<detail::Span> kFalse{detail::Span{"false", 5}};
+
+/// Last generation taken by a parser, shared by every parser so no two changes anywhere get the same generation
+std::atomic<uint64_t> last_generation{0};
+
+/// Token index given to probes for events that are not tied to an input argument
+constexpr int64_t kNoToken = -1;
+
+/// Converts the index of an input argument to the signed token index given to probes
+int64_t token(const std::size_t index) {
+    return static_cast<int64_t>(index);
+}
+
+/// Fires the [callback] probe before a callback is invoked
+/// \param kind  Name of the callback
+/// \param name  Name of the option / group the callback is about, empty if none
+/// \param index Index of the input argument the callback is about, [kNoToken] if none
+void trace_callback(const char *kind, const char *name, const int64_t index) {
+    ARGPARSE_USDT_PROBE3(callback, kind, name, index);
+}
+void trace_callback(const char *kind, const std::string &name, const int64_t index) {
+    trace_callback(kind, name.c_str(), index);
+}
+
 } // namespace
 
 Parser::Parser(std::string name, std::string help)
@@ -48,16 +88,7 @@ Parser::Parser(std::string name, std::string help)
       help_(std::move(help)),
       options_(std::make_unique<Options>()),
       parser_(std::make_unique<detail::Parser>()) {
-    // Add a help option by default
-    add(Config<bool>{
-        .default_value = false,
-        .allowed_values = {},
-        .name = "help",
-        .help = "Show help message",
-        .required = false,
-        .letter = 'h',
-    });
-
+    add_help();
     set_default_callbacks();
 }
 
@@ -67,33 +98,75 @@ Parser::Parser(const Parser &other) :
     options_(std::make_unique<Options>(*other.options_)),
     parser_(std::make_unique<detail::Parser>(*other.parser_)),
     remaining_args_(other.remaining_args_),
-    existing_args_(other.existing_args_),
+    present_(other.present_),
     positionals_(other.positionals_),
     subparser_(other.subparser_),
     subparser_group_(other.subparser_group_),
-    selected_subparser_(other.selected_subparser_) {
+    selected_subparser_(other.selected_subparser_),
+    strict_(other.strict_),
+    completion_(other.completion_),
+    quiet_(other.quiet_),
+    environment_(other.environment_),
+    expand_(other.expand_),
+    file_(other.file_),
+    section_(other.section_),
+    file_entries_(other.file_entries_),
+    file_options_(other.file_options_),
+    reject_unknown_(other.reject_unknown_),
+    cache_(other.cache_),
+    generation_(other.generation_) {
 }
 
 Parser::Parser(Parser &&other) noexcept :
     options_(std::move(other.options_)),
     parser_(std::move(other.parser_)),
     remaining_args_(std::move(other.remaining_args_)),
-    existing_args_(std::move(other.existing_args_)),
+    present_(std::move(other.present_)),
     positionals_(std::move(other.positionals_)),
     subparser_(std::move(other.subparser_)),
     subparser_group_(std::move(other.subparser_group_)),
-    selected_subparser_(std::move(other.selected_subparser_)) {
+    selected_subparser_(std::move(other.selected_subparser_)),
+    strict_(other.strict_),
+    completion_(other.completion_),
+    quiet_(other.quiet_),
+    environment_(std::move(other.environment_)),
+    expand_(other.expand_),
+    file_(std::move(other.file_)),
+    section_(std::move(other.section_)),
+    file_entries_(std::move(other.file_entries_)),
+    file_options_(std::move(other.file_options_)),
+    expanded_(std::move(other.expanded_)),
+    reject_unknown_(other.reject_unknown_),
+    suggestions_(std::move(other.suggestions_)),
+    completions_(std::move(other.completions_)),
+    cache_(std::move(other.cache_)),
+    generation_(other.generation_) {
 }
 
 Parser &Parser::operator=(const Parser &other) {
     options_ = std::make_unique<Options>(*other.options_);
     parser_ = std::make_unique<detail::Parser>(*other.parser_);
     remaining_args_ = other.remaining_args_;
-    existing_args_ = other.existing_args_;
+    present_ = other.present_;
     positionals_ = other.positionals_;
     subparser_ = other.subparser_;
     subparser_group_ = other.subparser_group_;
     selected_subparser_ = other.selected_subparser_;
+    strict_ = other.strict_;
+    completion_ = other.completion_;
+    quiet_ = other.quiet_;
+    environment_ = other.environment_;
+    expand_ = other.expand_;
+    file_ = other.file_;
+    section_ = other.section_;
+    file_entries_ = other.file_entries_;
+    file_options_ = other.file_options_;
+    reject_unknown_ = other.reject_unknown_;
+    suggestions_.reset();
+    completions_.reset();
+    cache_ = other.cache_;
+    generation_ = other.generation_;
+    schema_generation_ = 0;
 
     return *this;
 }
@@ -102,11 +175,27 @@ Parser &Parser::operator=(Parser &&other) noexcept {
     options_ = std::move(other.options_);
     parser_ = std::move(other.parser_);
     remaining_args_ = std::move(other.remaining_args_);
-    existing_args_ = std::move(other.existing_args_);
+    present_ = std::move(other.present_);
     positionals_ = std::move(other.positionals_);
     subparser_ = std::move(other.subparser_);
     subparser_group_ = std::move(other.subparser_group_);
     selected_subparser_ = std::move(other.selected_subparser_);
+    strict_ = other.strict_;
+    completion_ = other.completion_;
+    quiet_ = other.quiet_;
+    environment_ = std::move(other.environment_);
+    expand_ = other.expand_;
+    file_ = std::move(other.file_);
+    section_ = std::move(other.section_);
+    file_entries_ = std::move(other.file_entries_);
+    file_options_ = std::move(other.file_options_);
+    expanded_ = std::move(other.expanded_);
+    reject_unknown_ = other.reject_unknown_;
+    suggestions_ = std::move(other.suggestions_);
+    completions_ = std::move(other.completions_);
+    cache_ = std::move(other.cache_);
+    generation_ = other.generation_;
+    schema_generation_ = 0;
 
     return *this;
 }
@@ -117,6 +206,7 @@ ConstPlaceHolder<std::vector<T>> Parser::add_multivalent(Config<T> config) {
 
     // Check and update name
     validate<T>(config);
+    bump_generation();
 
     return options_->add_multivalent<T>(std::move(config));
 }
@@ -127,6 +217,7 @@ ConstPlaceHolder<T> Parser::add(Config<T> config) {
 
     // Check and update name
     validate<T>(config);
+    bump_generation();
 
     return options_->add<T>(std::move(config));
 }
@@ -137,7 +228,7 @@ ConstPlaceHolder<T> Parser::add(std::string name, // NOLINT(performance-unnecess
                                 const char letter,
                                 const bool required,
                                 pstd::optional<T> default_value,
-                                std::unordered_set<T> allowed_values) {
+                                typename Config<T>::AllowedValues allowed_values) {
     static_assert(supported<T>(), "Must be a valid type");
 
     Config<T> config{
@@ -151,24 +242,70 @@ ConstPlaceHolder<T> Parser::add(std::string name, // NOLINT(performance-unnecess
 
     // Check and update name
     validate<T>(config);
+    bump_generation();
 
     return options_->add<T>(std::move(config));
 }
 
 template <typename T>
-ConstPlaceHolder<T> Parser::add_leading_positional(Config<T> config) {
+LazyPlaceHolder<T> Parser::add_lazy(Config<T> config) {
     static_assert(supported<T>(), "Must be a valid type");
 
     // Check and update name
     validate<T>(config);
+    bump_generation();
 
-    // Save position
-    positionals_.push_back(config.name);
+    return options_->add_lazy<T>(std::move(config));
+}
+
+template <typename T>
+LazyPlaceHolder<std::vector<T>> Parser::add_lazy_multivalent(Config<T> config) {
+    static_assert(supported<T>(), "Must be a valid type");
+
+    // Check and update name
+    validate<T>(config);
+    bump_generation();
+
+    return options_->add_lazy_multivalent<T>(std::move(config));
+}
+
+template <typename T>
+ConstPlaceHolder<T> Parser::add_leading_positional(Config<T> config) {
+    static_assert(supported<T>(), "Must be a valid type");
+
+    // Check and update name
+    validate<T>(config);
 
     // All leading positional arguments are required, otherwise the positions invalidates others
     config.required = true;
 
-    return options_->add<T>(std::move(config), positionals_.size());
+    // Save position
+    bump_generation();
+    const auto name = config.name;
+    auto placeholder = options_->add<T>(std::move(config), positionals_.size() + 1);
+    positionals_.push_back(options_->find(name));
+
+    return placeholder;
+}
+
+void Parser::add_choice(Config<std::string> &&config, const std::shared_ptr<detail::ChoiceIndex> &choices) {
+    // Check and update name
+    validate<std::string>(config);
+    bump_generation();
+
+    options_->add_choice(std::move(config), choices);
+}
+
+void Parser::add_tuple(Config<std::string> &&config, const std::shared_ptr<detail::TupleIndex> &tuple) {
+    // Check and update name
+    validate<std::string>(config);
+    bump_generation();
+
+    options_->add_tuple(std::move(config), tuple);
+}
+
+void Parser::reserve(const std::size_t count) {
+    options_->reserve(options_->size() + count);
 }
 
 void Parser::set_callbacks(Callbacks &&cbs) {
@@ -183,9 +320,204 @@ void Parser::set_callbacks(Callbacks &&cbs) {
     move_if_exists(cbs.missing, cbs_.missing);
     move_if_exists(cbs.invalid, cbs_.invalid);
     move_if_exists(cbs.not_allowed, cbs_.not_allowed);
+    move_if_exists(cbs.constraint, cbs_.constraint);
+    move_if_exists(cbs.unknown, cbs_.unknown);
+    move_if_exists(cbs.complete, cbs_.complete);
+    move_if_exists(cbs.profile, cbs_.profile);
+}
+
+void Parser::set_reject_unknown(const bool reject) {
+    reject_unknown_ = reject;
+    bump_generation();
+    if (subparser_.has_value()) {
+        for (auto &subparser : subparser_.value()) {
+            subparser.second.set_reject_unknown(reject);
+        }
+    }
+}
+
+void Parser::set_quiet(const bool quiet) {
+    quiet_ = quiet;
+    set_printing_callbacks();
+    if (subparser_.has_value()) {
+        for (auto &subparser : subparser_.value()) {
+            subparser.second.set_quiet(quiet);
+        }
+    }
+}
+
+void Parser::set_environment(const char *const *envp) {
+    share_environment(std::make_shared<const detail::Environment>(envp));
+}
+
+void Parser::set_expand(const bool expand) {
+    expand_ = expand;
+    bump_generation();
+    if (subparser_.has_value()) {
+        for (auto &subparser : subparser_.value()) {
+            subparser.second.set_expand(expand);
+        }
+    }
+}
+
+void Parser::set_config_file(const std::string &path) {
+    share_config_file(std::make_shared<const detail::ConfigFile>(path));
+}
+
+void Parser::set_config_file(const std::shared_ptr<const detail::ConfigFile> &file) {
+    share_config_file(file);
+}
+
+void Parser::set_cache(const std::string &path) {
+    cache_ = std::make_shared<detail::ParseCache>(path);
+}
+
+void Parser::set_cache(const std::shared_ptr<detail::ParseCache> &cache) {
+    cache_ = cache;
+}
+
+const detail::Environment &Parser::environment() {
+    if (!environment_) {
+        environment_ = detail::Environment::process();
+    }
+    return *environment_;
+}
+
+void Parser::share_environment(const std::shared_ptr<const detail::Environment> &environment) {
+    environment_ = environment;
+    if (subparser_.has_value()) {
+        for (auto &subparser : subparser_.value()) {
+            subparser.second.share_environment(environment);
+        }
+    }
+}
+
+void Parser::share_config_file(const std::shared_ptr<const detail::ConfigFile> &file) {
+    file_ = file;
+    file_entries_.clear();
+    if (subparser_.has_value()) {
+        for (auto &subparser : subparser_.value()) {
+            subparser.second.share_config_file(file);
+        }
+    }
+}
+
+void Parser::resolve_config_file() {
+    if (file_entries_.size() == options_->size()) {
+        return;
+    }
+
+    file_entries_.assign(options_->size(), 0);
+    file_options_.assign(options_->size());
+    const auto &entries = file_->entries();
+    for (std::size_t ii = 0; ii < entries.size(); ii++) {
+        const auto &entry = entries[ii];
+        if (!entry.section.equals(section_.data(), section_.size())) {
+            continue;
+        }
+        const auto id = options_->find(entry.name.data, entry.name.size);
+        if (id != kNoOption) {
+            file_entries_[id] = static_cast<uint32_t>(ii + 1);
+            file_options_.set(id);
+        }
+    }
+}
+
+pstd::optional<detail::Span> Parser::config_value(const std::size_t id) const {
+    const auto &entry = file_->entries()[file_entries_[id] - 1];
+    if (entry.assigned) {
+        return entry.value;
+    }
+    if (options_->type(id) == Type::kBool) {
+        return detail::Span{"true", 4};
+    }
+    return {};
+}
+
+void Parser::assign(std::string &out, const char *data, const std::size_t size) {
+    if (expand_) {
+        environment().expand(data, size, out);
+    } else {
+        out.assign(data, size);
+    }
+}
+
+detail::Span Parser::expand_lazy(const char *data, const std::size_t size) {
+    if (!expand_ || (size == 0) || (std::memchr(data, '$', size) == nullptr)) {
+        return detail::Span{data, size};
+    }
+    expanded_.emplace_back();
+    environment().expand(data, size, expanded_.back());
+    return detail::Span{expanded_.back().data(), expanded_.back().size()};
+}
+
+const std::vector<detail::Span> &Parser::expand_lazy(const std::vector<detail::Span> &values) {
+    if (!expand_) {
+        return values;
+    }
+    spans_.clear();
+    for (const auto &value : values) {
+        spans_.push_back(expand_lazy(value.data, value.size));
+    }
+    return spans_;
+}
+
+bool Parser::set_from_source(Option &option, const std::size_t id, const detail::Span &value) {
+    const bool lazy = options_->lazy(id);
+
+    // Booleans are true unless the value is empty, "0" or "false", values from the file do not end with a null
+    if (options_->flag(id)) {
+        const bool enabled = (value.size != 0) && !value.equals("0") && !value.equals("false");
+        value_ = enabled ? "true" : "false";
+        return lazy ? defer(option, enabled ? kTrue : kFalse) : option.set(value_);
+    }
+
+    // Lazy values are recorded where they are in the snapshot or the file, which live as long as the parser, or where
+    // they were expanded, the whole value before it is split as for other options
+    if (lazy) {
+        const auto expanded = expand_lazy(value.data, value.size);
+        spans_.clear();
+        if (options_->multivalent(id)) {
+            for_each_value(expanded.data, expanded.size, [this](const char *data, const std::size_t size) {
+                spans_.push_back(detail::Span{data, size});
+            });
+        } else {
+            spans_.push_back(expanded);
+        }
+        value_.assign(expanded.data, expanded.size);
+        return defer(option, spans_);
+    }
+
+    assign(value_, value.data, value.size);
+    if (options_->multivalent(id)) {
+        std::size_t count = 0;
+        for_each_value(value_.data(), value_.size(), [this, &count](const char *data, const std::size_t size) {
+            if (count == values_.size()) {
+                values_.emplace_back();
+            }
+            values_[count++].assign(data, size);
+        });
+        values_.resize(count);
+        return option.set(values_);
+    }
+
+    return option.set(value_);
 }
 
 void Parser::help() const {
+    const detail::ProfileSession session(cbs_.profile);
+    const detail::ScopedPhase phase(Phase::kHelp);
+
+    // A quiet parser only invokes the callback
+    if (!quiet_) {
+        print_help();
+    }
+
+    trace_callback("help", name_, kNoToken);
+    cbs_.help();
+}
+
+void Parser::print_help() const {
     // Separator
     std::cout << '\n';
 
@@ -193,8 +525,8 @@ void Parser::help() const {
     std::stringstream ss;
     ss << "Usage: ";
     ss << name_ << " ";
-    for (const auto &name : positionals_) {
-        ss << "[" << name << "]" << " ";
+    for (const auto id : positionals_) {
+        ss << "[" << options_->at(id).name() << "]" << " ";
     }
     ss << options_->usage_string();
     std::cout << ss.str() << '\n';
@@ -213,37 +545,225 @@ void Parser::help() const {
             std::cout << "[" << pair.first << "] Parser Options:\n" << pair.second.options_->display_string() << std::endl;
         }
     }
-
-    cbs_.help();
 }
 
 const std::vector<std::string> &Parser::parse(const int argc, const char **argv) {
     assert(argv);
-    return parse(argc, argv, true);
+    const detail::ProfileSession session(cbs_.profile);
+
+    const auto &tokens = [&]() -> const std::vector<detail::Token> & {
+        const detail::ScopedPhase phase(Phase::kTokenize);
+        return parser_->classify(argc, argv);
+    }();
+
+    // A shell asks for completions with "--_complete <cword> <words...>" instead of parsing
+    constexpr char kComplete[] = "--_complete";
+    if (completion_ && (tokens.size() >= 2) && (tokens[1].size == sizeof(kComplete) - 1) &&
+        (std::memcmp(tokens[1].data, kComplete, tokens[1].size) == 0)) {
+        return answer_completion(tokens);
+    }
+    return parse(tokens);
+}
+
+const std::vector<std::string> &Parser::parse(const char *cmdline, const std::size_t size) {
+    assert(cmdline || size == 0);
+    const detail::ProfileSession session(cbs_.profile);
+
+    const auto &tokens = [&]() -> const std::vector<detail::Token> & {
+        const detail::ScopedPhase phase(Phase::kTokenize);
+        return parser_->classify(cmdline, size);
+    }();
+    return parse(tokens);
+}
+
+const std::vector<std::string> &Parser::answer_completion(const std::vector<detail::Token> &tokens) {
+    const std::size_t cword = (tokens.size() >= 3) ? std::strtoull(std::string(tokens[2].data, tokens[2].size).c_str(), nullptr, 10) : 0;
+    std::vector<std::string> words;
+    words.reserve(tokens.size());
+    for (std::size_t ii = 3; ii < tokens.size(); ii++) {
+        words.emplace_back(tokens[ii].data, tokens[ii].size);
+    }
+
+    const auto candidates = complete(words, std::min(cword, words.size()));
+    trace_callback("complete", name_, kNoToken);
+    cbs_.complete(candidates);
+
+    // Nothing was parsed, so the parse ends as a failed one, as after the help message
+    remaining_args_.clear();
+    failed_ = true;
+    trace_callback("exit", name_, kNoToken);
+    cbs_.exit();
+    return remaining_args_;
+}
+
+const std::vector<std::string> &Parser::parse(const std::vector<detail::Token> &tokens) {
+    ARGPARSE_USDT_PROBE2(parse_entry, name_.c_str(), static_cast<int32_t>(tokens.size()));
+
+    // A parse of the same arguments from the same sources loads the converted values instead
+    const bool cached = cache_ && !expand_;
+    if (cached) {
+        cache_key(tokens);
+        const auto snapshot = cache_->find(key_);
+        if (snapshot.has_value()) {
+            // A snapshot that does not load is a miss, the arguments are parsed again, which resets what it loaded
+            try {
+                detail::SnapshotReader in(snapshot->data, snapshot->size);
+                const auto &remaining_args = restore(in);
+                ARGPARSE_USDT_PROBE2(parse_return, name_.c_str(), 0);
+                return remaining_args;
+            } catch (const std::logic_error &) {
+            }
+        }
+    }
+
+    // The return probe fires for both outcomes, so latency can be measured even when the exit callback throws
+    try {
+        const auto &remaining_args = parse(tokens.data(), tokens.size(), true, 0);
+        if (cached && !failed()) {
+            snapshot_.clear();
+            detail::SnapshotWriter out(snapshot_);
+            save(out);
+            cache_->insert(key_, snapshot_);
+        }
+        ARGPARSE_USDT_PROBE2(parse_return, name_.c_str(), 0);
+        return remaining_args;
+    } catch (...) {
+        ARGPARSE_USDT_PROBE2(parse_return, name_.c_str(), 1);
+        throw;
+    }
+}
+
+std::vector<std::string> Parser::complete(const std::vector<std::string> &words, const std::size_t cword) {
+    std::vector<std::string> candidates;
+    if ((cword == 0) || (cword > words.size())) {
+        return candidates;
+    }
+
+    // Earlier words select the subparsers, the way [parse] does
+    Parser *parser = this;
+    std::size_t index = 1;
+    while (parser->subparser_.has_value() && (index < cword)) {
+        const auto found = parser->subparser_->find(words[index]);
+        if (found == parser->subparser_->end()) {
+            return candidates;
+        }
+        parser = &found->second;
+        index++;
+    }
+
+    const std::string empty;
+    const std::string &word = (cword < words.size()) ? words[cword] : empty;
+
+    // The subparsers are already sorted
+    if (parser->subparser_.has_value()) {
+        for (auto it = parser->subparser_->lower_bound(word); it != parser->subparser_->end(); ++it) {
+            if (it->first.compare(0, word.size(), word) != 0) {
+                break;
+            }
+            candidates.push_back(it->first);
+        }
+        return candidates;
+    }
+
+    // Value in the same word as the option
+    const auto equals = word.find('=');
+    if ((word.compare(0, 2, "--") == 0) && (equals != std::string::npos)) {
+        const auto id = parser->options_->find(word.data() + 2, equals - 2);
+        if (id != kNoOption) {
+            parser->complete_values(id, word.substr(equals + 1), word.substr(0, equals + 1), candidates);
+        }
+        return candidates;
+    }
+
+    // Value of the option before, if it takes values
+    const std::string &previous = words[cword - 1];
+    if ((word.empty() || (word[0] != '-')) && (cword - 1 >= index) && (previous.size() >= 2) && (previous[0] == '-') &&
+        (previous.find('=') == std::string::npos)) {
+        const std::size_t hyphens = (previous[1] == '-') ? 2 : 1;
+        const auto id = parser->options_->find(previous.data() + hyphens, previous.size() - hyphens);
+        if ((id != kNoOption) && (parser->options_->type(id) != Type::kBool)) {
+            parser->complete_values(id, word, {}, candidates);
+            return candidates;
+        }
+    }
+
+    // Names and letters, a word that is not an option is a positional value
+    if (word.empty() || (word[0] == '-')) {
+        parser->completions().names.complete(word, {}, candidates);
+    }
+    return candidates;
+}
+
+bool Parser::validate(const int argc, const char **argv, const DiagnosticCallback &report) {
+    assert(argv);
+    const std::size_t count = static_cast<std::size_t>((argc > 0) ? argc : 0);
+    return (count == 0) ? validate(argv, 0, 0, report) : validate(argv + 1, count - 1, 1, report);
+}
+
+void Parser::add_group(const Constraint constraint, const std::vector<std::string> &names) {
+    bump_generation();
+    options_->add_constraint(constraint, names);
+}
+
+void Parser::add_requires(const std::string &name, const std::vector<std::string> &required) {
+    bump_generation();
+    options_->add_constraint(Constraint::kRequires, required, name);
+}
+
+void Parser::add_conflicts(const std::string &name, const std::vector<std::string> &conflicts) {
+    bump_generation();
+    options_->add_constraint(Constraint::kConflicts, conflicts, name);
 }
 
 std::map<std::string, Parser> &Parser::add_subparser(std::string &&group,
                                                      std::unordered_set<std::string> &&allowed_values) {
     if (subparser_.has_value()) {
-        log_error("Can only register one subparser per parser");
+        if (!quiet_) {
+            log_error("Can only register one subparser per parser");
+        }
+        trace_callback("exit", name_, kNoToken);
         cbs_.exit();
         return subparser_.value();
     }
 
+    bump_generation();
     subparser_group_ = std::move(group);
     subparser_.emplace();
 
     for (auto &&av : allowed_values) {
-        subparser_.value().emplace(
+        auto &subparser = subparser_.value().emplace(
             std::piecewise_construct,
             std::forward_as_tuple(av),
             std::forward_as_tuple(av)
-        );
+        ).first->second;
+
+        // Subparsers keep their text in the pool of this parser, so text repeated across subparsers is stored once
+        subparser.options_ = std::make_unique<Options>(options_->pool());
+        subparser.add_help();
+        subparser.environment_ = environment_;
+        subparser.expand_ = expand_;
+        subparser.file_ = file_;
+        subparser.section_ = av;
+        subparser.reject_unknown_ = reject_unknown_;
+        if (quiet_) {
+            subparser.set_quiet(true);
+        }
     }
 
     return subparser_.value();
 }
 
+void Parser::add_help() {
+    add(Config<bool>{
+        .default_value = false,
+        .allowed_values = {},
+        .name = "help",
+        .help = "Show help message",
+        .required = false,
+        .letter = 'h',
+    });
+}
+
 template <typename T>
 void Parser::validate(Config<T> &config) {
     const bool not_using_char = (config.letter == kUnusedChar);
@@ -268,165 +788,816 @@ void Parser::validate(Config<T> &config) {
     }
 }
 
-const std::vector<std::string> &Parser::parse(const int argc, const char **argv, const bool pop_first) {
+const std::vector<std::string> &Parser::parse(const detail::Token *tokens, const std::size_t count, const bool pop_first, const std::size_t offset) {
     // If pop first, decrement size, increment pointer
-    const int new_argc = (pop_first) ? (argc - 1) : (argc);
-    const char **new_argv = (pop_first) ? (argv + 1) : (argv);
+    const bool pop = pop_first && (count > 0);
+    const std::size_t new_count = (pop) ? (count - 1) : (count);
+    const detail::Token *new_tokens = (pop) ? (tokens + 1) : (tokens);
+    const std::size_t new_offset = (pop_first) ? (offset + 1) : (offset);
+    failed_ = false;
 
     // If subparsers exists
     if (subparser_.has_value()) {
         // Check for subparser option, should have at least one argument
-        if (new_argc <= 0) {
+        if (new_count == 0) {
+            failed_ = true;
+            trace_callback("missing", subparser_group_.value(), kNoToken);
             cbs_.missing(subparser_group_.value());
             return remaining_args_;
         }
 
         // Select subparser
-        selected_subparser_ = new_argv[0];
+        selected_subparser_.assign(new_tokens[0].data, new_tokens[0].size);
+        ARGPARSE_USDT_PROBE3(subparser, subparser_group_->c_str(), selected_subparser_.c_str(), token(new_offset));
         const auto iterator = subparser_->find(selected_subparser_);
         if (iterator == subparser_->end()) {
+            trace_callback("invalid", subparser_group_.value(), token(new_offset));
             cbs_.invalid(subparser_group_.value(), {selected_subparser_});
             help();
+            failed_ = true;
+            trace_callback("exit", subparser_group_.value(), token(new_offset));
             cbs_.exit();
             return remaining_args_;
         }
 
         // Let the subparser do the remainder of the parsing
         auto &parser = (*subparser_)[selected_subparser_];
-        return parser.parse(new_argc, new_argv, true);
+        return parser.parse(new_tokens, new_count, true, new_offset);
     }
 
-    cross_check(parser_->parse(new_argc, new_argv));
+    // Start from the defaults, nothing carries over from a previous parse
+    // Only the options set by previous parses are restored, so this does not grow with the size of the schema
+    options_->reset();
+    present_.assign(options_->size());
+    expanded_.clear();
+
+    const auto &args = [&]() -> const Args & {
+        const detail::ScopedPhase phase(Phase::kTokenize);
+        return parser_->parse(new_tokens, new_count, *options_);
+    }();
+    cross_check(args, new_offset);
 
     // Print help if requested
-    const bool print_help = existing_args_.find("h")    != existing_args_.end() ||
-                            existing_args_.find("help") != existing_args_.end();
+    const auto help_id = options_->find("help");
+    const bool print_help = present_.test(help_id);
     if (print_help) {
         help();
+        failed_ = true;
+        trace_callback("exit", name_, kNoToken);
         cbs_.exit();
     }
 
     // Check against required arguments
     if (!check_requirements()) {
         help();
+        failed_ = true;
+        trace_callback("exit", name_, kNoToken);
         cbs_.exit();
     }
 
     return remaining_args_;
 }
 
-void Parser::cross_check(Args &&args) {
+void Parser::cross_check(const Args &args, const std::size_t offset) {
+    const detail::ScopedPhase phase(Phase::kResolve);
     bool any_invalid = false;
 
     // Check positional arguments
-    const auto &positional_args = parser_->positional_args();
+    const auto &positional_args = args.positionals();
     for (std::size_t position = 0; position < positionals_.size(); position++) {
-        const auto &name = positionals_[position];
+        const auto id = positionals_[position];
+        auto &option = options_->at(id);
+        const char *name = option.name();
 
         // Check if any value exists over there
         if (position < positional_args.size()) {
-            // Option should exist, the name is the same name that was used to add the option
-            auto option = options_->get(name);
-            assert(option);
-
-            // Mark as existing
-            existing_args_.insert(name);
+            // Mark as existing, and to be restored by the next parse
+            present_.set(id);
+            options_->touch(id);
 
             // Set the value
-            const auto &value = positional_args[position];
-            if (!option->set(value)) {
-                cbs_.invalid(name, {value});
+            assign(value_, positional_args[position].data, positional_args[position].size);
+            if (!option.set(value_)) {
+                ARGPARSE_USDT_PROBE3(set_failure, name, token(offset + position), value_.c_str());
+                trace_callback("invalid", name, token(offset + position));
+                cbs_.invalid(name, {value_});
                 any_invalid = true;
             }
         } else {
-            log_error("Expected positional argument [", name, "] at", position, "position");
+            if (!quiet_) {
+                log_error("Expected positional argument [", name, "] at", position, "position");
+            }
             help();
+            failed_ = true;
+            trace_callback("exit", name, kNoToken);
             cbs_.exit();
         }
     }
 
-    // Check non positional arguments
-    for (auto &pair : args) {
-        const auto &name = pair.first;
-        auto &values = pair.second;
-
-        if (name == detail::Parser::kRemainingArgsKey) {
-            remaining_args_ = std::move(values);
-            continue;
-        }
-
-        // Did not find option
-        auto option = options_->get(name);
-        if (!option) {
-            continue;
-        }
-
+    // Check non positional arguments, in the order they appeared
+    // Options that are not registered were already skipped while parsing
+    for (const auto id : args.order()) {
         // Don't check for positional arguments here
-        if (option->positional()) {
+        if (options_->positional(id)) {
             continue;
         }
 
-        // Boolean parameter just checks if the flag exists or not
-        if (option->type() == Type::kBool) {
-            if (!option->set("true")) {
+        auto &option = options_->at(id);
+        const auto &slot = args.slot(id);
+        const char *name = option.name();
+        const auto index = token(offset + slot.index);
+        const bool lazy = options_->lazy(id);
+        options_->touch(id);
+
+        // Boolean parameter just checks if the flag exists or not, any values are ignored
+        if (options_->flag(id)) {
+            const bool set = lazy ? defer(option, kTrue) : option.set("true");
+            if (!set) {
+                ARGPARSE_USDT_PROBE3(set_failure, name, index, "true");
+                trace_callback("invalid", name, index);
                 cbs_.invalid(name, {"true"});
                 any_invalid = true;
             }
-            existing_args_.insert(option->name());
+            present_.set(id);
             continue;
         }
 
         // No values for the option
-        if (values.empty()) {
+        if (slot.values.empty()) {
+            trace_callback("missing", name, index);
             cbs_.missing(name);
             any_invalid = true;
             continue;
         }
 
         // This option has a value, add it to set of args
-        existing_args_.insert(option->name());
+        present_.set(id);
+
+        // Multivalent, set all values, which were already split by comma
+        if (options_->multivalent(id) && lazy) {
+            if (!defer(option, expand_lazy(slot.values))) {
+                ARGPARSE_USDT_PROBE3(set_failure, name, index, "");
+                trace_callback("not_allowed", name, index);
+                cbs_.not_allowed(name, values_);
+                any_invalid = true;
+            }
+            continue;
+        }
+        if (options_->multivalent(id)) {
+            values_.resize(slot.values.size());
+            for (std::size_t ii = 0; ii < slot.values.size(); ii++) {
+                assign(values_[ii], slot.values[ii].data, slot.values[ii].size);
+            }
 
-        // Multivalent, set all values
-        if (option->multivalent()) {
-            split_values(values);
-            if (!option->set(values)) {
-                cbs_.not_allowed(name, values);
+            // A fixed number of values, any beyond were flagged where they appeared
+            const std::size_t arity = options_->arity(id);
+            if ((arity != 0) && (values_.size() != arity)) {
+                trace_callback("invalid", name, (slot.surplus != kNoIndex) ? token(offset + slot.surplus) : index);
+                cbs_.invalid(name, values_);
+                any_invalid = true;
+                continue;
+            }
+            if (!option.set(values_)) {
+                ARGPARSE_USDT_PROBE3(set_failure, name, index, "");
+                trace_callback("not_allowed", name, index);
+                cbs_.not_allowed(name, values_);
                 any_invalid = true;
             }
             continue;
         }
 
         // Not multivalent, should not have more than 1 value
-        if (values.size() > 1) {
+        if (slot.surplus != kNoIndex) {
+            std::vector<std::string> values;
+            for (const auto &value : slot.values) {
+                values.push_back(value.str());
+            }
+            trace_callback("invalid", name, token(offset + slot.surplus));
             cbs_.invalid(name, values);
             any_invalid = true;
+        } else if (lazy) {
+            // Lazy, only one value, which is recorded to be converted on first access
+            if (!defer(option, expand_lazy(slot.values))) {
+                ARGPARSE_USDT_PROBE3(set_failure, name, index, value_.c_str());
+                trace_callback("not_allowed", name, index);
+                cbs_.not_allowed(name, {value_});
+                any_invalid = true;
+            }
         } else {
             // Not multivalent, only one value
-            if (!option->set(values[0])) {
-                cbs_.not_allowed(name, {values[0]});
+            assign(value_, slot.values[0].data, slot.values[0].size);
+            if (!option.set(value_)) {
+                ARGPARSE_USDT_PROBE3(set_failure, name, index, value_.c_str());
+                trace_callback("not_allowed", name, index);
+                cbs_.not_allowed(name, {value_});
                 any_invalid = true;
             }
         }
     }
 
+    // Options that are not given take their value from their environment variable, if it is set
+    options_->environment().for_each_missing(present_, [&](const std::size_t id) {
+        auto &option = options_->at(id);
+        const auto value = option.positional() ? pstd::nullopt : environment().find(option.env(), std::strlen(option.env()));
+        if (!value.has_value()) {
+            return;
+        }
+
+        present_.set(id);
+        options_->touch(id);
+        if (!set_from_source(option, id, value.value())) {
+            const char *name = option.name();
+            ARGPARSE_USDT_PROBE3(set_failure, name, kNoToken, value_.c_str());
+            trace_callback("not_allowed", name, kNoToken);
+            cbs_.not_allowed(name, {value_});
+            any_invalid = true;
+        }
+    });
+
+    // Then from their entry in the config file
+    if (file_) {
+        resolve_config_file();
+        file_options_.for_each_missing(present_, [&](const std::size_t id) {
+            auto &option = options_->at(id);
+            if (option.positional()) {
+                return;
+            }
+
+            const char *name = option.name();
+            const auto value = config_value(id);
+            if (!value.has_value()) {
+                trace_callback("missing", name, kNoToken);
+                cbs_.missing(name);
+                any_invalid = true;
+                return;
+            }
+
+            present_.set(id);
+            options_->touch(id);
+            if (!set_from_source(option, id, value.value())) {
+                ARGPARSE_USDT_PROBE3(set_failure, name, kNoToken, value_.c_str());
+                trace_callback("not_allowed", name, kNoToken);
+                cbs_.not_allowed(name, {value_});
+                any_invalid = true;
+            }
+        });
+    }
+
+    // Options that are not registered, with the closest registered names
+    if (reject_unknown_) {
+        const auto &unknown = args.unknown();
+        const auto &names = args.unknown_names();
+        for (std::size_t ii = 0; ii < unknown.size(); ii++) {
+            values_.clear();
+            for (const auto id : suggest(names[ii].data, names[ii].size)) {
+                values_.emplace_back(options_->at(id).name());
+            }
+            value_.assign(names[ii].data, names[ii].size);
+            trace_callback("unknown", value_, token(offset + unknown[ii]));
+            cbs_.unknown(value_, values_);
+            any_invalid = true;
+        }
+    }
+
+    const auto &remaining = args.remaining();
+    remaining_args_.resize(remaining.size());
+    for (std::size_t ii = 0; ii < remaining.size(); ii++) {
+        remaining_args_[ii].assign(remaining[ii].data, remaining[ii].size);
+    }
+
     if (any_invalid) {
         help();
+        failed_ = true;
+        trace_callback("exit", name_, kNoToken);
         cbs_.exit();
     }
 }
 
-bool Parser::check_requirements() const {
-    const auto &missings = options_->check_requirements(existing_args_);
-    for (const auto &pair : missings) {
-        cbs_.missing(pair.first);
+bool Parser::validate(const char **argv, const std::size_t count, const std::size_t offset, const DiagnosticCallback &report) {
+    using Error = Diagnostic::Error;
+    bool valid = true;
+    auto diagnose = [&valid, &report](const Error error, const char *name, const pstd::optional<std::size_t> index) {
+        valid = false;
+        if (report) {
+            report(Diagnostic{error, name, index});
+        }
+    };
+
+    // Let the selected subparser validate the remainder
+    if (subparser_.has_value()) {
+        if (count == 0) {
+            diagnose(Error::kMissing, subparser_group_.value().c_str(), {});
+            return valid;
+        }
+
+        value_.assign(argv[0]);
+        const auto iterator = subparser_->find(value_);
+        if (iterator == subparser_->end()) {
+            diagnose(Error::kInvalid, subparser_group_.value().c_str(), offset);
+            return valid;
+        }
+
+        return iterator->second.validate(argv + 1, count - 1, offset + 1, report);
+    }
+
+    // Only the number of values of each option is kept, each value is checked where it appears
+    counts_.assign(options_->size(), 0);
+    std::size_t last_option = kNoOption;
+    std::size_t position = 0;
+    bool any_option = false;
+
+    // Values of an option with a fixed number of values are checked by their element, and flagged once beyond the last
+    elements_.assign(options_->size(), 0);
+    auto add_element = [&](const std::size_t id, const char *data, const std::size_t size, const pstd::optional<std::size_t> index) {
+        const auto &option = options_->at(id);
+        const std::size_t element = elements_[id]++;
+        if (element >= options_->arity(id)) {
+            if (counts_[id] != 3) {
+                diagnose(Error::kInvalid, option.name(), index);
+            }
+            counts_[id] = 3;
+            return;
+        }
+
+        counts_[id] = 2;
+        const auto error = check_value(option, data, size, element);
+        if (error.has_value()) {
+            diagnose(error.value(), option.name(), index);
+        }
+    };
+
+    auto add_value = [&](const std::size_t id, const char *data, const std::size_t size, const std::size_t index) {
+        // Booleans ignore values, like [parse] does
+        if (options_->flag(id)) {
+            return;
+        }
+
+        const auto &option = options_->at(id);
+        if (options_->arity(id) != 0) {
+            for_each_value(data, size, [&](const char *value, const std::size_t length) {
+                add_element(id, value, length, index);
+            });
+            return;
+        }
+        if (options_->multivalent(id)) {
+            for_each_value(data, size, [&](const char *value, const std::size_t length) {
+                counts_[id] = 2;
+                const auto error = check_value(option, value, length);
+                if (error.has_value()) {
+                    diagnose(error.value(), option.name(), index);
+                }
+            });
+            return;
+        }
+
+        // Flagged once, where the first value beyond the one accepted appears
+        if (counts_[id] >= 2) {
+            if (counts_[id] == 2) {
+                diagnose(Error::kInvalid, option.name(), index);
+            }
+            counts_[id] = 3;
+            return;
+        }
+
+        counts_[id] = 2;
+        const auto error = check_value(option, data, size);
+        if (error.has_value()) {
+            diagnose(error.value(), option.name(), index);
+        }
+    };
+
+    for (std::size_t ii = 0; ii < count; ii++) {
+        const auto token = detail::Classifier::classify(argv[ii]);
+        const std::size_t index = offset + ii;
+
+        if ((token.flags & detail::Token::kSplitter) != 0) {
+            // Everything after the splitter is left to the program
+            break;
+        }
+
+        if ((token.flags & detail::Token::kOption) != 0) {
+            any_option = true;
+
+            const std::size_t prefix = token.prefix();
+            const std::size_t size = (token.equals > prefix) ? (token.equals - prefix) : 0;
+            value_.assign(token.data + prefix, size);
+            last_option = options_->find(value_);
+
+            // Not a name, so maybe a cluster of letters such as -xvf, like [parse] does
+            std::size_t letters = 0;
+            if ((last_option == kNoOption) && (prefix == 1) && (size > 1)) {
+                letters = options_->cluster(value_.data(), size);
+                for (std::size_t jj = 0; jj < letters; jj++) {
+                    last_option = options_->find_letter(value_[jj]);
+                    counts_[last_option] = std::max<uint8_t>(counts_[last_option], 1);
+                }
+            }
+            if (last_option == kNoOption) {
+                // Suggestions are only looked for when there is someone to report them to
+                if (reject_unknown_) {
+                    valid = false;
+                    if (report) {
+                        const auto suggestions = suggest(token.data + prefix, size);
+                        const char *suggestion = suggestions.empty() ? nullptr : options_->at(suggestions.front()).name();
+                        report(Diagnostic{Error::kUnknown, argv[ii], index, suggestion});
+                    }
+                }
+                continue;
+            }
+
+            counts_[last_option] = std::max<uint8_t>(counts_[last_option], 1);
+            if ((letters != 0) && (letters < size)) {
+                add_value(last_option, token.data + prefix + letters, size - letters, index);
+            }
+            if (token.equals != token.size) {
+                add_value(last_option, token.data + token.equals + 1, token.size - token.equals - 1, index);
+            }
+        } else if (!any_option) {
+            // Leading positional arguments, any beyond the registered ones are ignored
+            if (position < positionals_.size()) {
+                const auto id = positionals_[position];
+                counts_[id] = 2;
+
+                const auto error = check_value(options_->at(id), token.data, token.size);
+                if (error.has_value()) {
+                    diagnose(error.value(), options_->at(id).name(), index);
+                }
+            }
+            position++;
+        } else if (last_option != kNoOption) {
+            add_value(last_option, token.data, token.size, index);
+        }
+    }
+
+    // Checks a value that an option not given takes from another source
+    auto check_source = [&](const std::size_t id, const detail::Span &value) {
+        const auto &option = options_->at(id);
+        counts_[id] = 2;
+        auto check = [&](const char *data, const std::size_t size) {
+            const auto error = check_value(option, data, size);
+            if (error.has_value()) {
+                diagnose(error.value(), option.name(), {});
+            }
+        };
+        if (options_->flag(id)) {
+            return;
+        }
+        if (options_->arity(id) != 0) {
+            for_each_value(value.data, value.size, [&](const char *data, const std::size_t size) {
+                add_element(id, data, size, {});
+            });
+        } else if (options_->multivalent(id)) {
+            for_each_value(value.data, value.size, check);
+        } else {
+            check(value.data, value.size);
+        }
+    };
+
+    // Options that are not given take their value from their environment variable, like [parse] does
+    options_->environment().for_each([&](const std::size_t id) {
+        const auto &option = options_->at(id);
+        if ((counts_[id] != 0) || option.positional()) {
+            return;
+        }
+        const auto value = environment().find(option.env(), std::strlen(option.env()));
+        if (value.has_value()) {
+            check_source(id, value.value());
+        }
+    });
+
+    // Then from their entry in the config file, an entry without a value is missing one like an option given without values
+    if (file_) {
+        resolve_config_file();
+        file_options_.for_each([&](const std::size_t id) {
+            if ((counts_[id] != 0) || options_->at(id).positional()) {
+                return;
+            }
+            const auto value = config_value(id);
+            if (value.has_value()) {
+                check_source(id, value.value());
+            } else {
+                counts_[id] = 1;
+            }
+        });
+    }
+
+    // Options given without values are missing a value, and are not counted as given, like [parse] does
+    present_.assign(options_->size());
+    for (std::size_t id = 0; id < counts_.size(); id++) {
+        const bool is_bool = options_->flag(id);
+        if ((counts_[id] >= 2) || (is_bool && (counts_[id] == 1))) {
+            present_.set(id);
+            if ((counts_[id] == 2) && (elements_[id] < options_->arity(id))) {
+                diagnose(Error::kInvalid, options_->at(id).name(), {});
+            }
+        } else if (counts_[id] == 1) {
+            diagnose(Error::kMissing, options_->at(id).name(), {});
+        }
+    }
+
+    // The help message is shown before the required options and the constraints are checked, like [parse] does, only
+    // missing positional arguments are reported before it
+    if (present_.test(options_->find("help"))) {
+        for (const auto id : positionals_) {
+            if (!present_.test(id)) {
+                diagnose(Error::kMissing, options_->at(id).name(), {});
+            }
+        }
+        return valid;
+    }
+
+    // Options that are required but not given, then the constraints
+    options_->check_requirements(present_, [&](const std::string &name) { diagnose(Error::kMissing, name.c_str(), {}); });
+    options_->check_constraints(present_, [&](const Constraint, const std::vector<std::string> &names) {
+        diagnose(Error::kConstraint, names.front().c_str(), {});
+    });
+
+    return valid;
+}
+
+std::vector<std::size_t> Parser::suggest(const char *name, const std::size_t size) {
+    if (!suggestions_ || (suggestions_->size() != options_->size())) {
+        suggestions_ = std::make_unique<detail::Suggestions>();
+        for (std::size_t id = 0; id < options_->size(); id++) {
+            const char *option = options_->at(id).name();
+            suggestions_->add(option, std::strlen(option), id);
+        }
+    }
+    return suggestions_->suggest(name, size);
+}
+
+const detail::Completions &Parser::completions() {
+    if (completions_ && (completions_->options == options_->size())) {
+        return *completions_;
+    }
+
+    completions_ = std::make_unique<detail::Completions>();
+    completions_->options = options_->size();
+    auto &names = completions_->names;
+    names.reserve(options_->size() * 2);
+    for (std::size_t id = 0; id < options_->size(); id++) {
+        const auto &option = options_->at(id);
+        if (option.positional()) {
+            continue;
+        }
+        const std::size_t size = std::strlen(option.name());
+        if (size > 1) {
+            names.add("--", option.name(), size);
+        }
+        const char letter = option.letter();
+        if (letter != kUnusedChar) {
+            names.add("-", &letter, 1);
+        }
+    }
+    names.sort();
+    return *completions_;
+}
+
+void Parser::complete_values(const std::size_t id, const std::string &prefix, std::string lead, std::vector<std::string> &out) {
+    completions();
+    auto found = completions_->values.find(id);
+    if (found == completions_->values.end()) {
+        std::vector<std::string> values;
+        for (const auto &value : options_->at(id).allowed_values()) {
+            values.push_back(value.string());
+        }
+        found = completions_->values.emplace(id, detail::SortedWords(values)).first;
+    }
+
+    // Earlier values of a multivalent option stay as they are
+    const auto comma = options_->multivalent(id) ? prefix.rfind(',') : std::string::npos;
+    if (comma == std::string::npos) {
+        found->second.complete(prefix, lead, out);
+    } else {
+        lead.append(prefix, 0, comma + 1);
+        found->second.complete(prefix.substr(comma + 1), lead, out);
+    }
+}
+
+pstd::optional<Parser::Diagnostic::Error> Parser::check_value(const Option &option, const char *data, const std::size_t size, const std::size_t element) {
+    assign(value_, data, size);
+    try {
+        const bool allowed = (option.type() == Type::kTuple) ? option.check(value_, element) : option.check(value_);
+        if (!allowed) {
+            return Diagnostic::Error::kNotAllowed;
+        }
+    } catch (const std::exception &) {
+        return Diagnostic::Error::kInvalid;
+    }
+
+    return {};
+}
+
+bool Parser::defer(Option &option, const std::vector<detail::Span> &values) {
+    option.defer(values);
+    if (!strict_ || !option.required() || option.resolve()) {
+        return true;
+    }
+
+    // Copy the values that are not allowed for the callbacks
+    values_.resize(values.size());
+    for (std::size_t ii = 0; ii < values.size(); ii++) {
+        values_[ii].assign(values[ii].data, values[ii].size);
+    }
+    if (!values_.empty()) {
+        value_ = values_.front();
+    }
+
+    return false;
+}
+
+void Parser::bump_generation() {
+    generation_ = ++last_generation;
+}
+
+uint64_t Parser::schema_generation() const {
+    // Subparsers are changed through the map handed out by [add_subparser], so theirs are folded in with their names
+    uint64_t generation = detail::ParseCache::hash(reinterpret_cast<const char *>(&generation_), sizeof(generation_));
+    if (subparser_.has_value()) {
+        for (const auto &subparser : subparser_.value()) {
+            const uint64_t nested = subparser.second.schema_generation();
+            generation = detail::ParseCache::hash(subparser.first.data(), subparser.first.size(), generation);
+            generation = detail::ParseCache::hash(reinterpret_cast<const char *>(&nested), sizeof(nested), generation);
+        }
+    }
+    return generation;
+}
+
+void Parser::describe(std::string &out) const {
+    detail::SnapshotWriter writer(out);
+    writer.put(name_);
+    writer.put(strict_);
+    writer.put(reject_unknown_);
+    writer.put(expand_);
+    writer.put(static_cast<uint32_t>(options_->constraints()));
+    writer.put(positionals_);
+    for (std::size_t id = 0; id < options_->size(); id++) {
+        const auto &option = options_->at(id);
+        writer.put(std::string(option.name()));
+        writer.put(option.letter());
+        writer.put(option.type());
+        writer.put(std::string(option.type_name()));
+        writer.put(option.required());
+        writer.put(option.multivalent());
+        writer.put(option.lazy());
+        writer.put(std::string(option.env()));
+        writer.put(option.default_value().has_value() ? option.default_value()->string() : std::string());
+
+        // Allowed values are unordered
+        std::vector<std::string> allowed;
+        for (const auto &value : option.allowed_values()) {
+            allowed.push_back(value.string());
+        }
+        std::sort(allowed.begin(), allowed.end());
+        writer.put(allowed);
+    }
+
+    if (subparser_.has_value()) {
+        writer.put(subparser_group_.value());
+        for (const auto &subparser : subparser_.value()) {
+            writer.put(subparser.first);
+            subparser.second.describe(out);
+        }
+    }
+}
+
+uint64_t Parser::hash_environment(uint64_t hash) {
+    options_->environment().for_each([&](const std::size_t id) {
+        const auto &option = options_->at(id);
+        const auto value = environment().find(option.env(), std::strlen(option.env()));
+        const uint32_t size = value.has_value() ? static_cast<uint32_t>(value->size) : UINT32_MAX;
+        hash = detail::ParseCache::hash(reinterpret_cast<const char *>(&size), sizeof(size), hash);
+        if (value.has_value()) {
+            hash = detail::ParseCache::hash(value->data, value->size, hash);
+        }
+    });
+
+    if (subparser_.has_value()) {
+        for (auto &subparser : subparser_.value()) {
+            hash = subparser.second.hash_environment(hash);
+        }
+    }
+    return hash;
+}
+
+void Parser::cache_key(const std::vector<detail::Token> &tokens) {
+    // The schema is only described again after it changes
+    const uint64_t generation = schema_generation();
+    if (generation != schema_generation_) {
+        std::string description;
+        describe(description);
+        schema_hash_ = detail::ParseCache::hash(description.data(), description.size());
+        schema_generation_ = generation;
     }
 
-    return missings.empty();
+    // Values of environment variables and of the config file go into the key by their hash
+    uint64_t sources = hash_environment(detail::ParseCache::hash(nullptr, 0));
+    if (file_) {
+        for (const auto &entry : file_->entries()) {
+            for (const auto &span : {entry.section, entry.name, entry.value}) {
+                const auto span_size = static_cast<uint32_t>(span.size);
+                sources = detail::ParseCache::hash(reinterpret_cast<const char *>(&span_size), sizeof(span_size), sources);
+                sources = detail::ParseCache::hash(span.data, span.size, sources);
+            }
+            sources = detail::ParseCache::hash(entry.assigned ? "=" : "", entry.assigned ? 1 : 0, sources);
+        }
+    }
+
+    // The program is left out, so the same command line hits from any path
+    key_.clear();
+    detail::SnapshotWriter out(key_);
+    out.put(schema_hash_);
+    out.put(sources);
+    for (std::size_t ii = 1; ii < tokens.size(); ii++) {
+        out.put(detail::Span{tokens[ii].data, tokens[ii].size});
+    }
+}
+
+void Parser::save(detail::SnapshotWriter &out) const {
+    if (subparser_.has_value()) {
+        out.put(selected_subparser_);
+        subparser_->at(selected_subparser_).save(out);
+        return;
+    }
+
+    out.put(static_cast<uint32_t>(present_.count()));
+    present_.for_each([&](const std::size_t id) {
+        out.put(static_cast<uint32_t>(id));
+        options_->at(id).save(out);
+    });
+    out.put(remaining_args_);
+}
+
+const std::vector<std::string> &Parser::restore(detail::SnapshotReader &in) {
+    if (subparser_.has_value()) {
+        in.get(selected_subparser_);
+        const auto selected = subparser_->find(selected_subparser_);
+        if (selected == subparser_->end()) {
+            throw std::invalid_argument("snapshot holds a subparser that does not exist");
+        }
+        return selected->second.restore(in);
+    }
+
+    options_->reset();
+    present_.assign(options_->size());
+    uint32_t count = 0;
+    in.get(count);
+    for (uint32_t ii = 0; ii < count; ii++) {
+        uint32_t id = 0;
+        in.get(id);
+        if (id >= options_->size()) {
+            throw std::invalid_argument("snapshot holds an option that does not exist");
+        }
+        present_.set(id);
+        options_->touch(id);
+        options_->at(id).load(in);
+    }
+    in.get(remaining_args_);
+    return remaining_args_;
+}
+
+bool Parser::failed() const {
+    if (failed_) {
+        return true;
+    }
+    if (subparser_.has_value()) {
+        const auto selected = subparser_->find(selected_subparser_);
+        return (selected == subparser_->end()) || selected->second.failed();
+    }
+    return false;
+}
+
+bool Parser::check_requirements() const {
+    const detail::ScopedPhase phase(Phase::kRequirements);
+    const bool required = options_->check_requirements(present_, [this](const std::string &name) {
+        trace_callback("missing", name, kNoToken);
+        cbs_.missing(name);
+    });
+    const bool constrained = options_->check_constraints(present_, [this](const Constraint constraint, const std::vector<std::string> &names) {
+        trace_callback("constraint", names.front(), kNoToken);
+        cbs_.constraint(constraint, names);
+    });
+
+    return required && constrained;
 }
 
 void Parser::set_default_callbacks() {
     cbs_.exit = [] { throw std::runtime_error("Parsing failed"); };
     cbs_.help = [] { };
+    set_printing_callbacks();
+}
+
+void Parser::set_printing_callbacks() {
+    if (quiet_) {
+        cbs_.missing = [](const auto &) {};
+        cbs_.invalid = [](const auto &, const auto &) {};
+        cbs_.not_allowed = [](const auto &, const auto &) {};
+        cbs_.unknown = [](const auto &, const auto &) {};
+        cbs_.complete = [](const auto &) {};
+        cbs_.constraint = [](const auto, const auto &) {};
+        return;
+    }
+
     cbs_.missing = [](const auto &s) {
         log_error("Missing required argument : ", s);
     };
@@ -448,6 +1619,27 @@ void Parser::set_default_callbacks() {
         const char *v = values.empty() ? "???" : values_combined.c_str();
         log_error("Argument(s) not in allowed list : [ --", name, "=", v, "]");
     };
+    cbs_.unknown = [](const auto &name, const auto &suggestions) {
+        if (suggestions.empty()) {
+            log_error("Unknown argument : [ --", name, "]");
+        } else {
+            log_error("Unknown argument : [ --", name, "], did you mean [ --", suggestions.front(), "]");
+        }
+    };
+    cbs_.complete = [](const auto &candidates) {
+        for (const auto &candidate : candidates) {
+            std::cout << candidate << '\n';
+        }
+        std::cout.flush();
+    };
+    cbs_.constraint = [](const auto constraint, const auto &names) {
+        std::string names_combined = "{";
+        for (const auto &name : names) {
+            names_combined += " --" + name;
+        }
+        names_combined += " }";
+        log_error("Arguments violate constraint : [", enum_to_str(constraint), names_combined, "]");
+    };
 }
 
 /// @{ Explicit Instantiation
@@ -464,6 +1656,12 @@ template ConstPlaceHolder<std::vector<uint8_t>> Parser::add_multivalent(Config<u
 template ConstPlaceHolder<std::vector<int8_t>> Parser::add_multivalent(Config<int8_t> config);
 template ConstPlaceHolder<std::vector<bool>> Parser::add_multivalent(Config<bool> config);
 template ConstPlaceHolder<std::vector<char>> Parser::add_multivalent(Config<char> config);
+template ConstPlaceHolder<std::vector<Bytes>> Parser::add_multivalent(Config<Bytes> config);
+template ConstPlaceHolder<std::vector<Duration>> Parser::add_multivalent(Config<Duration> config);
+template ConstPlaceHolder<std::vector<Rate>> Parser::add_multivalent(Config<Rate> config);
+template ConstPlaceHolder<std::vector<CpuSet>> Parser::add_multivalent(Config<CpuSet> config);
+template ConstPlaceHolder<std::vector<IpAddress>> Parser::add_multivalent(Config<IpAddress> config);
+template ConstPlaceHolder<std::vector<Cidr>> Parser::add_multivalent(Config<Cidr> config);
 template ConstPlaceHolder<std::string> Parser::add(Config<std::string>);
 template ConstPlaceHolder<double> Parser::add(Config<double>);
 template ConstPlaceHolder<float> Parser::add(Config<float>);
@@ -477,6 +1675,12 @@ template ConstPlaceHolder<uint8_t> Parser::add(Config<uint8_t>);
 template ConstPlaceHolder<int8_t> Parser::add(Config<int8_t>);
 template ConstPlaceHolder<bool> Parser::add(Config<bool>);
 template ConstPlaceHolder<char> Parser::add(Config<char>);
+template ConstPlaceHolder<Bytes> Parser::add(Config<Bytes>);
+template ConstPlaceHolder<Duration> Parser::add(Config<Duration>);
+template ConstPlaceHolder<Rate> Parser::add(Config<Rate>);
+template ConstPlaceHolder<CpuSet> Parser::add(Config<CpuSet>);
+template ConstPlaceHolder<IpAddress> Parser::add(Config<IpAddress>);
+template ConstPlaceHolder<Cidr> Parser::add(Config<Cidr>);
 template ConstPlaceHolder<std::string> Parser::add(std::string, std::string, const char, const bool, pstd::optional<std::string>, std::unordered_set<std::string>);
 template ConstPlaceHolder<double> Parser::add(std::string, std::string, const char, const bool, pstd::optional<double>, std::unordered_set<double>);
 template ConstPlaceHolder<float> Parser::add(std::string, std::string, const char, const bool, pstd::optional<float>, std::unordered_set<float>);
@@ -490,6 +1694,12 @@ template ConstPlaceHolder<uint8_t> Parser::add(std::string, std::string, const c
 template ConstPlaceHolder<int8_t> Parser::add(std::string, std::string, const char, const bool, pstd::optional<int8_t>, std::unordered_set<int8_t>);
 template ConstPlaceHolder<bool> Parser::add(std::string, std::string, const char, const bool, pstd::optional<bool>, std::unordered_set<bool>);
 template ConstPlaceHolder<char> Parser::add(std::string, std::string, const char, const bool, pstd::optional<char>, std::unordered_set<char>);
+template ConstPlaceHolder<Bytes> Parser::add(std::string, std::string, const char, const bool, pstd::optional<Bytes>, std::unordered_set<Bytes>);
+template ConstPlaceHolder<Duration> Parser::add(std::string, std::string, const char, const bool, pstd::optional<Duration>, Config<Duration>::AllowedValues);
+template ConstPlaceHolder<Rate> Parser::add(std::string, std::string, const char, const bool, pstd::optional<Rate>, std::unordered_set<Rate>);
+template ConstPlaceHolder<CpuSet> Parser::add(std::string, std::string, const char, const bool, pstd::optional<CpuSet>, std::unordered_set<CpuSet>);
+template ConstPlaceHolder<IpAddress> Parser::add(std::string, std::string, const char, const bool, pstd::optional<IpAddress>, Config<IpAddress>::AllowedValues);
+template ConstPlaceHolder<Cidr> Parser::add(std::string, std::string, const char, const bool, pstd::optional<Cidr>, Config<Cidr>::AllowedValues);
 template ConstPlaceHolder<std::string> Parser::add_leading_positional(Config<std::string>);
 template ConstPlaceHolder<double> Parser::add_leading_positional(Config<double>);
 template ConstPlaceHolder<float> Parser::add_leading_positional(Config<float>);
@@ -503,6 +1713,50 @@ template ConstPlaceHolder<uint8_t> Parser::add_leading_positional(Config<uint8_t
 template ConstPlaceHolder<int8_t> Parser::add_leading_positional(Config<int8_t>);
 template ConstPlaceHolder<bool> Parser::add_leading_positional(Config<bool>);
 template ConstPlaceHolder<char> Parser::add_leading_positional(Config<char>);
+template ConstPlaceHolder<Bytes> Parser::add_leading_positional(Config<Bytes>);
+template ConstPlaceHolder<Duration> Parser::add_leading_positional(Config<Duration>);
+template ConstPlaceHolder<Rate> Parser::add_leading_positional(Config<Rate>);
+template ConstPlaceHolder<CpuSet> Parser::add_leading_positional(Config<CpuSet>);
+template ConstPlaceHolder<IpAddress> Parser::add_leading_positional(Config<IpAddress>);
+template ConstPlaceHolder<Cidr> Parser::add_leading_positional(Config<Cidr>);
+template LazyPlaceHolder<std::string> Parser::add_lazy(Config<std::string>);
+template LazyPlaceHolder<double> Parser::add_lazy(Config<double>);
+template LazyPlaceHolder<float> Parser::add_lazy(Config<float>);
+template LazyPlaceHolder<uint64_t> Parser::add_lazy(Config<uint64_t>);
+template LazyPlaceHolder<int64_t> Parser::add_lazy(Config<int64_t>);
+template LazyPlaceHolder<uint32_t> Parser::add_lazy(Config<uint32_t>);
+template LazyPlaceHolder<int32_t> Parser::add_lazy(Config<int32_t>);
+template LazyPlaceHolder<uint16_t> Parser::add_lazy(Config<uint16_t>);
+template LazyPlaceHolder<int16_t> Parser::add_lazy(Config<int16_t>);
+template LazyPlaceHolder<uint8_t> Parser::add_lazy(Config<uint8_t>);
+template LazyPlaceHolder<int8_t> Parser::add_lazy(Config<int8_t>);
+template LazyPlaceHolder<bool> Parser::add_lazy(Config<bool>);
+template LazyPlaceHolder<char> Parser::add_lazy(Config<char>);
+template LazyPlaceHolder<Bytes> Parser::add_lazy(Config<Bytes>);
+template LazyPlaceHolder<Duration> Parser::add_lazy(Config<Duration>);
+template LazyPlaceHolder<Rate> Parser::add_lazy(Config<Rate>);
+template LazyPlaceHolder<CpuSet> Parser::add_lazy(Config<CpuSet>);
+template LazyPlaceHolder<IpAddress> Parser::add_lazy(Config<IpAddress>);
+template LazyPlaceHolder<Cidr> Parser::add_lazy(Config<Cidr>);
+template LazyPlaceHolder<std::vector<std::string>> Parser::add_lazy_multivalent(Config<std::string>);
+template LazyPlaceHolder<std::vector<double>> Parser::add_lazy_multivalent(Config<double>);
+template LazyPlaceHolder<std::vector<float>> Parser::add_lazy_multivalent(Config<float>);
+template LazyPlaceHolder<std::vector<uint64_t>> Parser::add_lazy_multivalent(Config<uint64_t>);
+template LazyPlaceHolder<std::vector<int64_t>> Parser::add_lazy_multivalent(Config<int64_t>);
+template LazyPlaceHolder<std::vector<uint32_t>> Parser::add_lazy_multivalent(Config<uint32_t>);
+template LazyPlaceHolder<std::vector<int32_t>> Parser::add_lazy_multivalent(Config<int32_t>);
+template LazyPlaceHolder<std::vector<uint16_t>> Parser::add_lazy_multivalent(Config<uint16_t>);
+template LazyPlaceHolder<std::vector<int16_t>> Parser::add_lazy_multivalent(Config<int16_t>);
+template LazyPlaceHolder<std::vector<uint8_t>> Parser::add_lazy_multivalent(Config<uint8_t>);
+template LazyPlaceHolder<std::vector<int8_t>> Parser::add_lazy_multivalent(Config<int8_t>);
+template LazyPlaceHolder<std::vector<bool>> Parser::add_lazy_multivalent(Config<bool>);
+template LazyPlaceHolder<std::vector<char>> Parser::add_lazy_multivalent(Config<char>);
+template LazyPlaceHolder<std::vector<Bytes>> Parser::add_lazy_multivalent(Config<Bytes>);
+template LazyPlaceHolder<std::vector<Duration>> Parser::add_lazy_multivalent(Config<Duration>);
+template LazyPlaceHolder<std::vector<Rate>> Parser::add_lazy_multivalent(Config<Rate>);
+template LazyPlaceHolder<std::vector<CpuSet>> Parser::add_lazy_multivalent(Config<CpuSet>);
+template LazyPlaceHolder<std::vector<IpAddress>> Parser::add_lazy_multivalent(Config<IpAddress>);
+template LazyPlaceHolder<std::vector<Cidr>> Parser::add_lazy_multivalent(Config<Cidr>);
 /// @}
 
 } // namespace argparse
@@ -0,0 +1,227 @@
+#include "classify.h"
+
+#include <cctype>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// The block sweep reads whole aligned chunks, which never cross a page, so bytes around the arguments may be read
+/// These are never used, but the address sanitizer can not know that
+#if defined(__clang__) || defined(__GNUC__)
+#define ARGPARSE_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#define ARGPARSE_NO_SANITIZE_ADDRESS
+#endif
+
+namespace argparse {
+namespace detail {
+
+namespace {
+
+#if defined(__SSE2__)
+
+/// Bytes per chunk, and bits per byte in the masks of a chunk
+constexpr std::size_t kChunkSize = 16;
+constexpr std::size_t kBitsPerByte = 1;
+constexpr bool kCanSweep = true;
+
+/// Finds the NUL terminators and '=' characters of an aligned chunk
+ARGPARSE_NO_SANITIZE_ADDRESS inline void find_in_chunk(const char *chunk, uint64_t &nuls, uint64_t &equals) {
+    const __m128i bytes = _mm_load_si128(reinterpret_cast<const __m128i *>(chunk));
+    nuls = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_setzero_si128())));
+    equals = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('='))));
+}
+
+#elif defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+
+/// Without SSE2, a 64 bit word at a time, where the high bit of each byte marks a match
+constexpr std::size_t kChunkSize = 8;
+constexpr std::size_t kBitsPerByte = 8;
+constexpr bool kCanSweep = true;
+
+/// \return The high bit of each byte set exactly where the byte is zero
+inline uint64_t zero_bytes(const uint64_t word) {
+    constexpr uint64_t kLow7 = 0x7F7F7F7F7F7F7F7FULL;
+    return ~(((word & kLow7) + kLow7) | word | kLow7);
+}
+
+ARGPARSE_NO_SANITIZE_ADDRESS inline void find_in_chunk(const char *chunk, uint64_t &nuls, uint64_t &equals) {
+    constexpr uint64_t kEquals = 0x3D3D3D3D3D3D3D3DULL;
+    uint64_t word = 0;
+    std::memcpy(&word, chunk, sizeof(word));
+    nuls = zero_bytes(word);
+    equals = zero_bytes(word ^ kEquals);
+}
+
+#else
+
+/// Unknown byte order, always scan each argument
+constexpr std::size_t kChunkSize = 1;
+constexpr std::size_t kBitsPerByte = 1;
+constexpr bool kCanSweep = false;
+
+inline void find_in_chunk(const char * /*chunk*/, uint64_t &nuls, uint64_t &equals) {
+    nuls = 0;
+    equals = 0;
+}
+
+#endif
+
+/// \return Index of the lowest set bit, which must exist
+inline std::size_t lowest_bit(const uint64_t bits) {
+#if defined(__clang__) || defined(__GNUC__)
+    return static_cast<std::size_t>(__builtin_ctzll(bits));
+#else
+    std::size_t index = 0;
+    while (((bits >> index) & 1U) == 0) {
+        index++;
+    }
+    return index;
+#endif
+}
+
+} // namespace
+
+const std::vector<Token> &Classifier::classify(const int argc, const char **argv) {
+    const auto count = static_cast<std::size_t>((argc > 0) ? argc : 0);
+    tokens_.clear();
+    tokens_.reserve(count);
+
+    swept_ = kCanSweep && (count > 0) && sweep(argv[0], nullptr, count, argv);
+    if (!swept_) {
+        tokens_.clear();
+        scan(count, argv);
+    }
+
+    return tokens_;
+}
+
+const std::vector<Token> &Classifier::classify(const char *data, const std::size_t size) {
+    tokens_.clear();
+    swept_ = kCanSweep && (size > 0);
+
+    if (swept_) {
+        sweep(data, data + size, 0, nullptr);
+        return tokens_;
+    }
+
+    // Without vectors, one argument at a time
+    const char *end = data + size;
+    while (data < end) {
+        const auto remaining = static_cast<std::size_t>(end - data);
+        const void *terminator = std::memchr(data, '\0', remaining);
+        const std::size_t length = (terminator != nullptr) ? static_cast<std::size_t>(static_cast<const char *>(terminator) - data) : remaining;
+        const void *equals = std::memchr(data, '=', length);
+        add(data, length, (equals != nullptr) ? static_cast<std::size_t>(static_cast<const char *>(equals) - data) : length);
+        data += length + 1;
+    }
+
+    return tokens_;
+}
+
+ARGPARSE_NO_SANITIZE_ADDRESS bool Classifier::sweep(const char *begin, const char *end, const std::size_t argc, const char **argv) {
+    // Start from the chunk holding the first argument, ignoring whatever precedes it
+    const char *start = begin;
+    const auto address = reinterpret_cast<uintptr_t>(start);
+    const char *chunk = reinterpret_cast<const char *>(address & ~static_cast<uintptr_t>(kChunkSize - 1));
+    uint64_t ignore = (uint64_t{1} << ((address & (kChunkSize - 1)) * kBitsPerByte)) - 1;
+
+    const char *equals = nullptr;
+    std::size_t index = 0;
+
+    while (true) {
+        // A bounded block ends with the last argument, terminated or not
+        if ((end != nullptr) && (chunk >= end)) {
+            if (start < end) {
+                const auto size = static_cast<std::size_t>(end - start);
+                add(start, size, (equals != nullptr) ? static_cast<std::size_t>(equals - start) : size);
+            }
+            return true;
+        }
+
+        uint64_t nuls = 0;
+        uint64_t eqs = 0;
+        find_in_chunk(chunk, nuls, eqs);
+
+        // Also ignore whatever follows a bounded block
+        if ((end != nullptr) && (static_cast<std::size_t>(end - chunk) < kChunkSize)) {
+            ignore |= ~((uint64_t{1} << (static_cast<std::size_t>(end - chunk) * kBitsPerByte)) - 1);
+        }
+
+        nuls &= ~ignore;
+        eqs &= ~ignore;
+        ignore = 0;
+
+        // Visit the matches in order, so each '=' is attributed to the argument its chunk position falls in
+        uint64_t matches = nuls | eqs;
+        while (matches != 0) {
+            const uint64_t bit = matches & (~matches + 1);
+            matches ^= bit;
+            const char *position = chunk + (lowest_bit(bit) / kBitsPerByte);
+
+            if ((eqs & bit) != 0) {
+                if (equals == nullptr) {
+                    equals = position;
+                }
+                continue;
+            }
+
+            const auto size = static_cast<std::size_t>(position - start);
+            add(start, size, (equals != nullptr) ? static_cast<std::size_t>(equals - start) : size);
+            equals = nullptr;
+
+            start = position + 1;
+            if (end != nullptr) {
+                continue;
+            }
+
+            // The next argument must begin right after this terminator, otherwise the block ends here
+            if (++index == argc) {
+                return true;
+            }
+            if (argv[index] != start) {
+                return false;
+            }
+        }
+
+        chunk += kChunkSize;
+    }
+}
+
+Token Classifier::classify(const char *arg) {
+    const std::size_t size = std::strlen(arg);
+    const void *equals = std::memchr(arg, '=', size);
+    return make(arg, size, (equals != nullptr) ? static_cast<std::size_t>(static_cast<const char *>(equals) - arg) : size);
+}
+
+void Classifier::scan(const std::size_t argc, const char **argv) {
+    for (std::size_t ii = 0; ii < argc; ii++) {
+        tokens_.push_back(classify(argv[ii]));
+    }
+}
+
+Token Classifier::make(const char *data, const std::size_t size, const std::size_t equals) {
+    Token token;
+    token.data = data;
+    token.size = size;
+    token.equals = equals;
+
+    // Only look within the argument, the last argument of a block may not be terminated
+    const char second = (size > 1) ? data[1] : '\0';
+    if ((size > 0) && (data[0] == '-')) {
+        if (0 != std::isdigit(static_cast<unsigned char>(second))) {
+            token.flags = Token::kNegativeNumber;
+        } else if (second == '-') {
+            token.flags = (size == 2) ? Token::kSplitter : (Token::kOption | Token::kLongPrefix);
+        } else {
+            token.flags = Token::kOption;
+        }
+    }
+
+    return token;
+}
+
+} // namespace detail
+} // namespace argparse
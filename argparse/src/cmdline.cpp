@@ -0,0 +1,81 @@
+#include "cmdline.h"
+
+#include <cerrno>
+#include <cstdio>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace argparse {
+namespace detail {
+
+namespace {
+
+/// Initial size of the buffer, most command lines fit in a page
+constexpr std::size_t kInitialBufferSize = 4096;
+
+} // namespace
+
+CmdlineReader::CmdlineReader() : buffer_(kInitialBufferSize) {
+#if defined(__linux__)
+    proc_ = ::open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    proc_error_ = (proc_ < 0) ? errno : 0;
+#else
+    proc_error_ = ENOSYS;
+#endif
+}
+
+CmdlineReader::~CmdlineReader() {
+#if defined(__linux__)
+    if (proc_ >= 0) {
+        ::close(proc_);
+    }
+#endif
+}
+
+int CmdlineReader::read(const pid_t pid) {
+    size_ = 0;
+    if (proc_ < 0) {
+        return proc_error_;
+    }
+
+#if defined(__linux__)
+    char path[32];
+    std::snprintf(path, sizeof(path), "%d/cmdline", static_cast<int>(pid));
+
+    const int fd = ::openat(proc_, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno;
+    }
+
+    // The length is not known up front, so read until the end, doubling the buffer whenever it fills up
+    int error = 0;
+    while (true) {
+        if (size_ == buffer_.size()) {
+            buffer_.resize(buffer_.size() * 2);
+        }
+
+        const ssize_t count = ::read(fd, buffer_.data() + size_, buffer_.size() - size_);
+        if (count > 0) {
+            size_ += static_cast<std::size_t>(count);
+        } else if (count == 0) {
+            break;
+        } else if (errno != EINTR) {
+            error = errno;
+            size_ = 0;
+            break;
+        }
+    }
+
+    ::close(fd);
+    return error;
+#else
+    (void)pid;
+    return proc_error_;
+#endif
+}
+
+} // namespace detail
+} // namespace argparse
@@ -0,0 +1,132 @@
+#include "completion.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace argparse {
+namespace detail {
+
+namespace {
+
+/// Ranges this short are sorted by comparing, counting 257 buckets costs more than it saves
+constexpr std::ptrdiff_t kInsertionSortSize = 32;
+
+/// Compares text in byte order, a prefix of another text is less than it
+int compare(const char *a, const std::size_t a_size, const char *b, const std::size_t b_size) {
+    const int result = std::memcmp(a, b, std::min(a_size, b_size));
+    if (result != 0) {
+        return result;
+    }
+    return (a_size < b_size) ? -1 : (a_size > b_size) ? 1 : 0;
+}
+
+} // namespace
+
+SortedWords::SortedWords(const std::vector<std::string> &words) {
+    words_.reserve(words.size());
+    for (const auto &word : words) {
+        add("", word.data(), word.size());
+    }
+    sort();
+}
+
+void SortedWords::add(const char *prefix, const char *data, const std::size_t size) {
+    const auto offset = static_cast<uint32_t>(text_.size());
+    text_.append(prefix);
+    text_.append(data, size);
+    words_.push_back(Word{offset, static_cast<uint32_t>(text_.size() - offset)});
+}
+
+void SortedWords::sort() {
+    std::vector<Word> scratch(words_.size());
+    sort(words_.data(), words_.data() + words_.size(), 0, scratch);
+
+    const char *text = text_.data();
+    words_.erase(std::unique(words_.begin(), words_.end(), [text](const Word &a, const Word &b) {
+        return compare(text + a.offset, a.size, text + b.offset, b.size) == 0;
+    }), words_.end());
+}
+
+void SortedWords::sort(Word *begin, Word *end, std::size_t depth, std::vector<Word> &scratch) const {
+    const char *text = text_.data();
+    while (end - begin > 1) {
+        if (end - begin <= kInsertionSortSize) {
+            std::sort(begin, end, [text, depth](const Word &a, const Word &b) {
+                return compare(text + a.offset + depth, a.size - depth, text + b.offset + depth, b.size - depth) < 0;
+            });
+            return;
+        }
+
+        // Bucket 0 holds the words that end at [depth], they come first and are all the same
+        // Only the buckets seen are visited afterwards, most of the 257 are empty
+        auto bucket = [text, depth](const Word &word) -> std::size_t {
+            return (word.size <= depth) ? 0 : static_cast<std::size_t>(static_cast<uint8_t>(text[word.offset + depth])) + 1;
+        };
+        std::array<uint32_t, 257> counts{};
+        std::array<uint16_t, 257> seen{};
+        std::size_t buckets = 0;
+        for (const Word *it = begin; it != end; ++it) {
+            const auto index = bucket(*it);
+            if (counts[index]++ == 0) {
+                seen[buckets++] = static_cast<uint16_t>(index);
+            }
+        }
+
+        // Every word has the same byte here, as for a prefix shared by every word
+        if (buckets == 1) {
+            if (seen[0] == 0) {
+                return;
+            }
+            depth++;
+            continue;
+        }
+
+        std::sort(seen.begin(), seen.begin() + static_cast<std::ptrdiff_t>(buckets));
+        std::array<uint32_t, 257> starts;
+        uint32_t start = 0;
+        std::size_t largest = seen[0];
+        for (std::size_t ii = 0; ii < buckets; ii++) {
+            starts[seen[ii]] = start;
+            start += counts[seen[ii]];
+            if ((seen[ii] != 0) && ((largest == 0) || (counts[seen[ii]] > counts[largest]))) {
+                largest = seen[ii];
+            }
+        }
+
+        auto next = starts;
+        for (const Word *it = begin; it != end; ++it) {
+            scratch[next[bucket(*it)]++] = *it;
+        }
+        std::copy(scratch.begin(), scratch.begin() + (end - begin), begin);
+
+        // Recurse into every bucket but the largest, which continues in this loop so shared prefixes do not recurse
+        for (std::size_t ii = 0; ii < buckets; ii++) {
+            const auto index = seen[ii];
+            if ((index != 0) && (index != largest) && (counts[index] > 1)) {
+                sort(begin + starts[index], begin + starts[index] + counts[index], depth + 1, scratch);
+            }
+        }
+        end = begin + starts[largest] + counts[largest];
+        begin = begin + starts[largest];
+        depth++;
+    }
+}
+
+void SortedWords::complete(const std::string &prefix, const std::string &lead, std::vector<std::string> &out) const {
+    // Words starting with the prefix are contiguous, and start at the first word not less than the prefix
+    const char *text = text_.data();
+    auto it = std::lower_bound(words_.begin(), words_.end(), prefix, [text](const Word &word, const std::string &prefix) {
+        return compare(text + word.offset, word.size, prefix.data(), prefix.size()) < 0;
+    });
+    for (; (it != words_.end()) && (it->size >= prefix.size()); ++it) {
+        if (std::memcmp(text + it->offset, prefix.data(), prefix.size()) != 0) {
+            break;
+        }
+        out.push_back(lead);
+        out.back().append(text + it->offset, it->size);
+    }
+}
+
+} // namespace detail
+} // namespace argparse
@@ -0,0 +1,123 @@
+#include "config_file.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace argparse {
+namespace detail {
+
+namespace {
+
+bool is_space(const char c) {
+    return (c == ' ') || (c == '\t') || (c == '\r');
+}
+
+/// \return [span] without whitespace on either side
+Span trim(const char *begin, const char *end) {
+    while ((begin != end) && is_space(*begin)) {
+        begin++;
+    }
+    while ((end != begin) && is_space(end[-1])) {
+        end--;
+    }
+    return Span{begin, static_cast<std::size_t>(end - begin)};
+}
+
+/// Closes a file descriptor when going out of scope
+struct Descriptor {
+    int fd;
+    ~Descriptor() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+};
+
+} // namespace
+
+ConfigFile::ConfigFile(const std::string &path) {
+    const Descriptor file{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    struct stat status {};
+    if ((file.fd < 0) || (::fstat(file.fd, &status) != 0)) {
+        throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    // Read until the end of the file, which may have grown since [fstat]
+    text_.resize(static_cast<std::size_t>(status.st_size) + 1);
+    std::size_t size = 0;
+    while (true) {
+        if (size == text_.size()) {
+            text_.resize(text_.size() * 2);
+        }
+        const ssize_t count = ::read(file.fd, &text_[size], text_.size() - size);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), path);
+        }
+        if (count == 0) {
+            break;
+        }
+        size += static_cast<std::size_t>(count);
+    }
+    text_.resize(size);
+
+    parse(text_.data(), text_.size());
+}
+
+ConfigFile::ConfigFile(const char *data, const std::size_t size) {
+    parse(data, size);
+}
+
+void ConfigFile::parse(const char *data, const std::size_t size) {
+    const char *const end = data + size;
+    Span section{};
+    std::size_t line = 0;
+
+    for (const char *it = data; it < end;) {
+        const auto *newline = static_cast<const char *>(std::memchr(it, '\n', static_cast<std::size_t>(end - it)));
+        const char *const line_end = (newline == nullptr) ? end : newline;
+        const Span text = trim(it, line_end);
+        it = line_end + 1;
+        line++;
+
+        if ((text.size == 0) || (text.data[0] == '#') || (text.data[0] == ';')) {
+            continue;
+        }
+
+        if (text.data[0] == '[') {
+            if (text.data[text.size - 1] != ']') {
+                throw std::invalid_argument("line " + std::to_string(line) + ": expected ']' at the end of a section");
+            }
+            section = trim(text.data + 1, text.data + text.size - 1);
+            continue;
+        }
+
+        const auto *const equals = static_cast<const char *>(std::memchr(text.data, '=', text.size));
+        Entry entry{section, text, Span{text.data + text.size, 0}, line, equals != nullptr};
+        if (entry.assigned) {
+            entry.name = trim(text.data, equals);
+            entry.value = trim(equals + 1, text.data + text.size);
+
+            // Quotes keep whitespace at the ends of a value
+            if ((entry.value.size >= 2) && (entry.value.data[0] == '"') && (entry.value.data[entry.value.size - 1] == '"')) {
+                entry.value = Span{entry.value.data + 1, entry.value.size - 2};
+            }
+        }
+
+        if (entry.name.size == 0) {
+            throw std::invalid_argument("line " + std::to_string(line) + ": expected a name before '='");
+        }
+        entries_.push_back(entry);
+    }
+}
+
+} // namespace detail
+} // namespace argparse
@@ -0,0 +1,166 @@
+#include "cpu_set.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace argparse {
+namespace detail {
+
+namespace {
+
+/// An item of a list, the numbers from [first] to [last] every [stride]
+struct Item {
+    std::size_t first = 0;
+    std::size_t last = 0;
+    std::size_t stride = 1;
+    bool excluded = false;
+};
+
+bool is_digit(const char c) {
+    return (c >= '0') && (c <= '9');
+}
+
+/// Parses a number starting at [it]
+/// \return The first character after the number
+const char *parse_number(const char *it, const char *const end, std::size_t &number) {
+    const char *const start = it;
+    number = 0;
+    for (; (it != end) && is_digit(*it); it++) {
+        number = number * 10 + static_cast<std::size_t>(*it - '0');
+        if (number > kMaxCpu) {
+            throw std::out_of_range("number is above " + std::to_string(kMaxCpu));
+        }
+    }
+
+    if (it == start) {
+        throw std::invalid_argument("expected a list such as 0-15,32-47");
+    }
+
+    return it;
+}
+
+/// Parses the item starting at [it]
+/// \return The comma after the item, or the end
+const char *parse_item(const char *it, const char *const end, Item &item) {
+    item.excluded = (it != end) && (*it == '^');
+    if (item.excluded) {
+        it++;
+    }
+
+    it = parse_number(it, end, item.first);
+    item.last = item.first;
+    item.stride = 1;
+    if ((it != end) && (*it == '-')) {
+        it = parse_number(it + 1, end, item.last);
+        if (item.last < item.first) {
+            throw std::invalid_argument("range ends before it starts");
+        }
+        if ((it != end) && (*it == ':')) {
+            it = parse_number(it + 1, end, item.stride);
+            if (item.stride == 0) {
+                throw std::invalid_argument("stride of a range must not be zero");
+            }
+        }
+    }
+
+    if ((it != end) && (*it != ',')) {
+        throw std::invalid_argument("expected a list such as 0-15,32-47");
+    }
+
+    return it;
+}
+
+/// Sets the bits of an included item, or clears those of an excluded one
+void apply(std::vector<uint64_t> &words, Item item) {
+    if (item.excluded) {
+        // Only the bits that may be set are cleared
+        if (item.first >= words.size() * 64) {
+            return;
+        }
+        item.last = std::min(item.last, words.size() * 64 - 1);
+    } else if (item.last / 64 >= words.size()) {
+        words.resize(item.last / 64 + 1, 0);
+    }
+
+    if (item.stride != 1) {
+        for (std::size_t n = item.first; n <= item.last; n += item.stride) {
+            const uint64_t bit = uint64_t{1} << (n % 64);
+            words[n / 64] = item.excluded ? (words[n / 64] & ~bit) : (words[n / 64] | bit);
+        }
+        return;
+    }
+
+    // A plain range is a mask of every word it covers
+    for (std::size_t word = item.first / 64; word <= item.last / 64; word++) {
+        const std::size_t low = (word == item.first / 64) ? (item.first % 64) : 0;
+        const std::size_t high = (word == item.last / 64) ? (item.last % 64) : 63;
+        const uint64_t mask = (~uint64_t{0} >> (63 - high)) & (~uint64_t{0} << low);
+        words[word] = item.excluded ? (words[word] & ~mask) : (words[word] | mask);
+    }
+}
+
+} // namespace
+
+CpuSet parse_cpu_set(const char *data, const std::size_t size) {
+    CpuSet cpus;
+    if (size == 0) {
+        return cpus;
+    }
+
+    // The list is read twice, for the included items then the excluded ones, so the order of the items does not matter
+    const char *const end = data + size;
+    for (const bool excluded : {false, true}) {
+        for (const char *it = data;; it++) {
+            Item item;
+            it = parse_item(it, end, item);
+            if (item.excluded == excluded) {
+                apply(cpus.words, item);
+            }
+            if (it == end) {
+                break;
+            }
+        }
+    }
+
+    while (!cpus.words.empty() && (cpus.words.back() == 0)) {
+        cpus.words.pop_back();
+    }
+
+    return cpus;
+}
+
+std::string format(const CpuSet &cpus) {
+    std::string out;
+    bool open = false;
+    std::size_t first = 0;
+    std::size_t last = 0;
+    auto close = [&] {
+        if (!open) {
+            return;
+        }
+        if (!out.empty()) {
+            out += ',';
+        }
+        out += std::to_string(first);
+        if (last != first) {
+            out += '-';
+            out += std::to_string(last);
+        }
+    };
+
+    cpus.for_each([&](const std::size_t n) {
+        if (open && (n == last + 1)) {
+            last = n;
+            return;
+        }
+        close();
+        first = last = n;
+        open = true;
+    });
+    close();
+
+    return out;
+}
+
+} // namespace detail
+} // namespace argparse
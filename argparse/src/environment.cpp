@@ -0,0 +1,112 @@
+#include "environment.h"
+
+#include <cstring>
+
+#include <unistd.h>
+
+namespace argparse {
+namespace detail {
+
+Environment::Environment(const char *const *envp) {
+    std::size_t count = 0;
+    for (const char *const *it = envp; (it != nullptr) && (*it != nullptr); it++) {
+        count++;
+    }
+
+    std::size_t slots = 16;
+    while (slots < count * 2) {
+        slots *= 2;
+    }
+    slots_.assign(slots, 0);
+    variables_.reserve(count);
+
+    for (std::size_t ii = 0; ii < count; ii++) {
+        const char *entry = envp[ii];
+        const char *equals = std::strchr(entry, '=');
+        if ((equals == nullptr) || (equals == entry)) {
+            continue;
+        }
+
+        // The first of repeated names is kept, as [getenv] does
+        const auto name_size = static_cast<std::size_t>(equals - entry);
+        auto &slot = slots_[this->slot(entry, name_size)];
+        if (slot != 0) {
+            continue;
+        }
+
+        const auto value_size = std::strlen(equals + 1);
+        Variable variable{};
+        variable.name = PooledString{static_cast<uint32_t>(text_.size()), static_cast<uint32_t>(name_size)};
+        text_.insert(text_.end(), entry, equals);
+        text_.push_back('\0');
+        variable.value = PooledString{static_cast<uint32_t>(text_.size()), static_cast<uint32_t>(value_size)};
+        text_.insert(text_.end(), equals + 1, equals + 1 + value_size);
+        text_.push_back('\0');
+
+        variables_.push_back(variable);
+        slot = static_cast<uint32_t>(variables_.size());
+    }
+}
+
+const std::shared_ptr<const Environment> &Environment::process() {
+    static const std::shared_ptr<const Environment> snapshot = std::make_shared<const Environment>(environ);
+    return snapshot;
+}
+
+pstd::optional<Span> Environment::find(const char *name, const std::size_t size) const {
+    const auto index = slots_[slot(name, size)];
+    if (index == 0) {
+        return {};
+    }
+
+    const auto &value = variables_[index - 1].value;
+    return Span{text_.data() + value.offset, value.size};
+}
+
+void Environment::expand(const char *data, const std::size_t size, std::string &out) const {
+    out.clear();
+
+    const char *it = data;
+    const char *const end = data + size;
+    while (it != end) {
+        const auto *const dollar = static_cast<const char *>(std::memchr(it, '$', static_cast<std::size_t>(end - it)));
+        if (dollar == nullptr) {
+            break;
+        }
+
+        const char *close = nullptr;
+        if ((dollar + 1 != end) && (dollar[1] == '{')) {
+            close = static_cast<const char *>(std::memchr(dollar + 2, '}', static_cast<std::size_t>(end - dollar - 2)));
+        }
+        if (close == nullptr) {
+            out.append(it, dollar + 1);
+            it = dollar + 1;
+            continue;
+        }
+
+        out.append(it, dollar);
+        const auto value = find(dollar + 2, static_cast<std::size_t>(close - dollar - 2));
+        if (value.has_value()) {
+            out.append(value->data, value->size);
+        }
+        it = close + 1;
+    }
+
+    out.append(it, end);
+}
+
+std::size_t Environment::slot(const char *name, const std::size_t size) const {
+    const std::size_t mask = slots_.size() - 1;
+    std::size_t slot = hash_string(name, size) & mask;
+    while (slots_[slot] != 0) {
+        const auto &existing = variables_[slots_[slot] - 1].name;
+        if ((existing.size == size) && (std::memcmp(text_.data() + existing.offset, name, size) == 0)) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+} // namespace detail
+} // namespace argparse
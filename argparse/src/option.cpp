@@ -1,11 +1,13 @@
 #include "option.h"
 
 #include "convert.h"
+#include "profiler.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <sstream>
+#include <stdexcept>
 
 namespace argparse {
 
@@ -26,10 +28,16 @@ template <> constexpr Type deduce_variant<uint8_t>() { return Type::kUint8; }
 template <> constexpr Type deduce_variant<int8_t>() { return Type::kInt8; }
 template <> constexpr Type deduce_variant<bool>() { return Type::kBool; }
 template <> constexpr Type deduce_variant<char>() { return Type::kChar; }
+template <> constexpr Type deduce_variant<Bytes>() { return Type::kBytes; }
+template <> constexpr Type deduce_variant<Duration>() { return Type::kDuration; }
+template <> constexpr Type deduce_variant<Rate>() { return Type::kRate; }
+template <> constexpr Type deduce_variant<CpuSet>() { return Type::kCpuSet; }
+template <> constexpr Type deduce_variant<IpAddress>() { return Type::kIpAddress; }
+template <> constexpr Type deduce_variant<Cidr>() { return Type::kCidr; }
 /// @}
 
 template <typename T>
-std::unordered_set<Variant, Variant::hash> make_variants(const std::unordered_set<T> &in) {
+std::unordered_set<Variant, Variant::hash> make_variants(const std::unordered_set<T, detail::Hash<T>> &in) {
     std::unordered_set<Variant, Variant::hash> out;
     for (const auto &value : in) {
         out.insert(Variant{value});
@@ -37,54 +45,237 @@ std::unordered_set<Variant, Variant::hash> make_variants(const std::unordered_se
     return out;
 }
 
+/// @{ Puts the allowed blocks of addresses and blocks in a prefix trie, see [detail::AllowedSet], other types have none
+template <typename T>
+std::shared_ptr<const detail::PrefixTrie> make_prefixes(const std::unordered_set<T, detail::Hash<T>> & /*in*/) {
+    return nullptr;
+}
+std::shared_ptr<const detail::PrefixTrie> make_prefixes(const std::unordered_set<Cidr, detail::Hash<Cidr>> &in) {
+    return in.empty() ? nullptr : std::make_shared<const detail::PrefixTrie>(in);
+}
+/// @}
+
+/// Copies the value of a variant that is known to hold [T]
+template <typename T>
+struct CopyValue {
+    T &out;
+    void operator()(const T &value) const { out = value; }
+    template <typename U>
+    void operator()(const U & /*value*/) const { assert(false); }
+};
+
+/// Converts a value only to check it, strings are checked as they are instead of copied
+template <typename T>
+struct Checked {
+    static T convert(const std::string &s) { return detail::convert_helper<T>(s); }
+};
+template <>
+struct Checked<std::string> {
+    static const std::string &convert(const std::string &s) { return s; }
+};
+
+/// \return The value of a variant that is known to hold [T]
+template <typename T>
+T get(const Variant &variant) {
+    T out{};
+    variant.visit(CopyValue<T>{out});
+    return out;
+}
+
 } // namespace
 
 template <typename T>
-Option::Option(const PlaceHolder<T> &placeholder, Config<T> &&config, const pstd::optional<std::size_t> position)
+const Option::Setters Option::kSingleSetters{&Option::set_helper<T>, nullptr, &Option::reset_helper<T>, nullptr, nullptr,
+                                             nullptr, &Option::check_helper<T>, &Option::save_helper<T>, &Option::load_helper<T>};
+
+template <typename T>
+const Option::Setters Option::kMultipleSetters{nullptr, &Option::set_helper<T>, &Option::reset_multiple_helper<T>, nullptr,
+                                               nullptr, nullptr, &Option::check_helper<T>, &Option::save_helper<std::vector<T>>,
+                                               &Option::load_helper<std::vector<T>>};
+
+template <typename T>
+const Option::Setters Option::kLazySetters{nullptr, nullptr, &Option::reset_lazy_helper<T>, &Option::defer_helper<T>,
+                                           &Option::resolve_helper<T>, &Option::detach_helper<T>, &Option::check_helper<T>,
+                                           &Option::save_lazy_helper<T>, &Option::load_lazy_helper<T>};
+
+template <typename T>
+const Option::Setters Option::kLazyMultipleSetters{nullptr, nullptr, &Option::reset_lazy_helper<std::vector<T>>,
+                                                   &Option::defer_helper<std::vector<T>>,
+                                                   &Option::resolve_helper<std::vector<T>>,
+                                                   &Option::detach_helper<std::vector<T>>, &Option::check_helper<T>,
+                                                   &Option::save_lazy_helper<std::vector<T>>,
+                                                   &Option::load_lazy_helper<std::vector<T>>};
+
+const Option::Setters Option::kChoiceSetters{&Option::set_choice, nullptr, &Option::reset_choice, nullptr, nullptr, nullptr,
+                                             &Option::check_choice, &Option::save_choice, &Option::load_choice};
+
+const Option::Setters Option::kTupleSetters{nullptr, &Option::set_tuple, &Option::reset_tuple, nullptr, nullptr, nullptr,
+                                            &Option::check_tuple, &Option::save_tuple, &Option::load_tuple};
+
+template <typename T>
+Option::Option(const PlaceHolder<T> &placeholder, Config<T> &&config, const pstd::optional<std::size_t> position, detail::StringPool &pool)
     : type_(deduce_variant<T>()),
       default_value_(determine_default_value(config.default_value)),
       allowed_values_(make_variants(config.allowed_values)),
-      name_(std::move(config.name)),
-      help_(std::move(config.help)),
+      prefixes_(make_prefixes(config.allowed_values)),
+      name_(pool.intern(config.name)),
+      help_(pool.intern(config.help)),
+      env_(pool.intern(config.env)),
       position_(position),
       letter_(config.letter),
       multivalent_(false),
       required_(config.required),
-      placeholder_(placeholder) {
+      lazy_(false),
+      placeholder_(placeholder),
+      value_(placeholder.get()),
+      setters_(&kSingleSetters<T>),
+      pool_(&pool) {
 
     assert(placeholder_);
 
     // Set default value
     if (config.default_value.has_value()) {
-        auto typed_ptr = std::static_pointer_cast<PlaceHolderType<T>>(placeholder_);
-        *typed_ptr = config.default_value.value();
+        *placeholder = config.default_value.value();
     }
 }
 
 /// Multivalent Constructor
 template <typename T>
-Option::Option(const PlaceHolder<std::vector<T>> &placeholder, Config<T> &&config, const pstd::optional<std::size_t> position)
+Option::Option(const PlaceHolder<std::vector<T>> &placeholder, Config<T> &&config, const pstd::optional<std::size_t> position,
+               detail::StringPool &pool)
     : type_(deduce_variant<T>()),
       default_value_(determine_default_value(config.default_value)),
       allowed_values_(make_variants(config.allowed_values)),
-      name_(std::move(config.name)),
-      help_(std::move(config.help)),
+      prefixes_(make_prefixes(config.allowed_values)),
+      name_(pool.intern(config.name)),
+      help_(pool.intern(config.help)),
+      env_(pool.intern(config.env)),
       position_(position),
       letter_(config.letter),
       multivalent_(true),
       required_(config.required),
-      placeholder_(placeholder) {
+      lazy_(false),
+      placeholder_(placeholder),
+      value_(placeholder.get()),
+      setters_(&kMultipleSetters<T>),
+      pool_(&pool) {
 
     assert(placeholder_);
 
-    // Set default value
+    // Set default value, or keep values aside for when the option is reset
     if (config.default_value.has_value()) {
-        auto typed_ptr = std::static_pointer_cast<PlaceHolderType<std::vector<T>>>(placeholder_);
-        auto &optional = *typed_ptr;
+        auto &optional = *placeholder;
+        optional.emplace();
         optional->push_back(config.default_value.value());
+    } else {
+        spare_ = std::make_shared<std::vector<T>>();
     }
 }
 
+template <typename T>
+Option::Option(const std::shared_ptr<LazyValue<T>> &lazy, Config<T> &&config, const pstd::optional<std::size_t> position,
+               detail::StringPool &pool)
+    : type_(deduce_variant<T>()),
+      default_value_(determine_default_value(config.default_value)),
+      allowed_values_(make_variants(config.allowed_values)),
+      prefixes_(make_prefixes(config.allowed_values)),
+      name_(pool.intern(config.name)),
+      help_(pool.intern(config.help)),
+      env_(pool.intern(config.env)),
+      position_(position),
+      letter_(config.letter),
+      multivalent_(false),
+      required_(config.required),
+      lazy_(true),
+      placeholder_(lazy),
+      value_(lazy.get()),
+      setters_(&kLazySetters<T>),
+      pool_(&pool) {
+
+    assert(placeholder_);
+
+    lazy->option_ = this;
+    lazy->resolve_ = &Option::convert_lazy;
+    assign_default(*this, lazy->value_);
+}
+
+template <typename T>
+Option::Option(const std::shared_ptr<LazyValue<std::vector<T>>> &lazy, Config<T> &&config, const pstd::optional<std::size_t> position,
+               detail::StringPool &pool)
+    : type_(deduce_variant<T>()),
+      default_value_(determine_default_value(config.default_value)),
+      allowed_values_(make_variants(config.allowed_values)),
+      prefixes_(make_prefixes(config.allowed_values)),
+      name_(pool.intern(config.name)),
+      help_(pool.intern(config.help)),
+      env_(pool.intern(config.env)),
+      position_(position),
+      letter_(config.letter),
+      multivalent_(true),
+      required_(config.required),
+      lazy_(true),
+      placeholder_(lazy),
+      value_(lazy.get()),
+      setters_(&kLazyMultipleSetters<T>),
+      pool_(&pool) {
+
+    assert(placeholder_);
+
+    lazy->option_ = this;
+    lazy->resolve_ = &Option::convert_lazy;
+    assign_default(*this, lazy->value_);
+}
+
+Option::Option(const std::shared_ptr<detail::ChoiceIndex> &choices, Config<std::string> &&config, const pstd::optional<std::size_t> position,
+               detail::StringPool &pool)
+    : type_(Type::kChoice),
+      default_value_(determine_default_value(config.default_value)),
+      allowed_values_(make_variants(config.allowed_values)),
+      prefixes_(make_prefixes(config.allowed_values)),
+      name_(pool.intern(config.name)),
+      help_(pool.intern(config.help)),
+      env_(pool.intern(config.env)),
+      position_(position),
+      letter_(config.letter),
+      multivalent_(false),
+      required_(config.required),
+      lazy_(false),
+      placeholder_(choices),
+      value_(choices.get()),
+      setters_(&kChoiceSetters),
+      pool_(&pool) {
+
+    assert(placeholder_);
+    assert(choices->assign);
+
+    reset_choice(*this);
+}
+
+Option::Option(const std::shared_ptr<detail::TupleIndex> &tuple, Config<std::string> &&config, const pstd::optional<std::size_t> position,
+               detail::StringPool &pool)
+    : type_(Type::kTuple),
+      default_value_(determine_default_value(config.default_value)),
+      allowed_values_(make_variants(config.allowed_values)),
+      prefixes_(make_prefixes(config.allowed_values)),
+      name_(pool.intern(config.name)),
+      help_(pool.intern(config.help)),
+      env_(pool.intern(config.env)),
+      position_(position),
+      letter_(config.letter),
+      multivalent_(true),
+      required_(config.required),
+      lazy_(false),
+      placeholder_(tuple),
+      value_(tuple.get()),
+      setters_(&kTupleSetters),
+      pool_(&pool) {
+
+    assert(placeholder_);
+    assert(tuple->assign);
+
+    reset_tuple(*this);
+}
+
 Option::OptionTable::Row Option::to_string() const {
     std::string allowed_values_str;
     if (!allowed_values_.empty()) {
@@ -104,23 +295,71 @@ Option::OptionTable::Row Option::to_string() const {
     return {{
         required_ ? "x" : " ",
         position_.has_value() ? std::to_string(position_.value()) : "",
-        name_,
+        pool_->c_str(name_),
         (letter_ == kUnusedChar) ? "" : std::string(1, letter_),
-        enum_to_str(type_),
+        type_name(),
         default_value_->string(),
-        help_,
+        pool_->c_str(help_),
         allowed_values_str,
     }};
 }
 
 bool Option::set(const std::string &s) {
     assert(!multivalent_);
-    return set_dispatch_helper(s);
+    return setters_->single(*this, s);
 }
 
 bool Option::set(const std::vector<std::string> &s) {
     assert(multivalent_);
-    return set_dispatch_helper(s);
+    return setters_->multiple(*this, s);
+}
+
+Option::~Option() {
+    if (setters_->detach != nullptr) {
+        setters_->detach(*this);
+    }
+}
+
+void Option::reset() {
+    setters_->reset(*this);
+}
+
+void Option::defer(const std::vector<detail::Span> &values) {
+    assert(lazy_);
+    setters_->defer(*this, values);
+}
+
+bool Option::resolve() {
+    assert(lazy_);
+    return setters_->resolve(*this);
+}
+
+bool Option::check(const std::string &s) const {
+    return setters_->check(*this, s);
+}
+
+bool Option::check(const std::string &s, const std::size_t index) const {
+    assert(type_ == Type::kTuple);
+    const auto &tuple = *static_cast<const detail::TupleIndex *>(value_);
+    assert(index < tuple.arity);
+    const detail::ScopedPhase phase(Phase::kConvert);
+    return tuple.check(tuple, index, s);
+}
+
+std::size_t Option::arity() const noexcept {
+    return (type_ == Type::kTuple) ? static_cast<const detail::TupleIndex *>(value_)->arity : 0;
+}
+
+const char *Option::type_name() const noexcept {
+    return (type_ == Type::kTuple) ? static_cast<const detail::TupleIndex *>(value_)->signature.c_str() : enum_to_str(type_);
+}
+
+void Option::save(detail::SnapshotWriter &out) const {
+    setters_->save(*this, out);
+}
+
+void Option::load(detail::SnapshotReader &in) {
+    setters_->load(*this, in);
 }
 
 template <typename T>
@@ -133,97 +372,423 @@ pstd::optional<Variant> Option::determine_default_value(const pstd::optional<T>
 }
 
 template <typename T>
-bool Option::set_dispatch_helper(const T &s) {
-    switch (type_) {
-    case Type::kString : return set_helper<std::string>(s);
-    case Type::kDouble : return set_helper<double>(s);
-    case Type::kFloat  : return set_helper<float>(s);
-    case Type::kUint64 : return set_helper<uint64_t>(s);
-    case Type::kInt64  : return set_helper<int64_t>(s);
-    case Type::kUint32 : return set_helper<uint32_t>(s);
-    case Type::kInt32  : return set_helper<int32_t>(s);
-    case Type::KUint16 : return set_helper<uint16_t>(s);
-    case Type::KInt16  : return set_helper<int16_t>(s);
-    case Type::kUint8  : return set_helper<uint8_t>(s);
-    case Type::kInt8   : return set_helper<int8_t>(s);
-    case Type::kBool   : return set_helper<bool>(s);
-    case Type::kChar   : return set_helper<char>(s);
-    default            : assert(false);
+bool Option::allowed(const T &value) const {
+    if (allowed_values_.empty()) {
+        return true;
+    }
+
+    const detail::ScopedPhase phase(Phase::kAllowedValues);
+    auto comparator = [&value](auto &v) { return v == value; };
+    return std::any_of(allowed_values_.cbegin(), allowed_values_.cend(), comparator);
+}
+
+/// @{ Addresses and blocks are found in the trie of the allowed blocks, instead of compared with each of them
+template <>
+bool Option::allowed(const IpAddress &value) const {
+    if (!prefixes_) {
+        return true;
+    }
+
+    const detail::ScopedPhase phase(Phase::kAllowedValues);
+    return prefixes_->contains(value);
+}
+
+template <>
+bool Option::allowed(const Cidr &value) const {
+    if (!prefixes_) {
+        return true;
     }
 
-    return false;
+    const detail::ScopedPhase phase(Phase::kAllowedValues);
+    return prefixes_->contains(value);
 }
+/// @}
 
 template <typename T>
-bool Option::set_helper(const std::string &s) {
-    const auto value = detail::convert_helper<T>(s);
+bool Option::set_helper(Option &option, const std::string &s) {
+    const auto value = [&s] {
+        const detail::ScopedPhase phase(Phase::kConvert);
+        return detail::convert_helper<T>(s);
+    }();
 
     // Check
-    if (!allowed_values_.empty()) {
-        auto comparator = [&value](auto &v) { return v == value; };
-        const bool matched_any = std::any_of(allowed_values_.cbegin(), allowed_values_.cend(), comparator);
-        if (!matched_any) {
+    if (!option.allowed(value)) {
+        return false;
+    }
+
+    *static_cast<PlaceHolderType<T> *>(option.value_) = value;
+
+    return true;
+}
+
+template <typename T>
+bool Option::set_helper(Option &option, const std::vector<std::string> &s) {
+    auto &optional = *static_cast<PlaceHolderType<std::vector<T>> *>(option.value_);
+    if (!optional.has_value()) {
+        optional.emplace();
+        if (option.spare_) {
+            optional->swap(*static_cast<std::vector<T> *>(option.spare_.get()));
+        }
+    }
+
+    // Exactly as many values as given, elements of earlier parses are assigned over so they keep their capacity
+    auto &values = optional.value();
+    values.reserve(s.size());
+    values.resize(s.size());
+
+    for (std::size_t ii = 0; ii < s.size(); ii++) {
+        const auto &value = [&s, ii]() -> decltype(Checked<T>::convert(s[ii])) {
+            const detail::ScopedPhase phase(Phase::kConvert);
+            return Checked<T>::convert(s[ii]);
+        }();
+
+        // Check
+        if (!option.allowed(value)) {
             return false;
         }
+
+        values[ii] = value;
+    }
+
+    return true;
+}
+
+template <typename T>
+void Option::reset_helper(Option &option) {
+    assign_default(option, *static_cast<PlaceHolderType<T> *>(option.value_));
+}
+
+template <typename T>
+void Option::reset_multiple_helper(Option &option) {
+    auto &optional = *static_cast<PlaceHolderType<std::vector<T>> *>(option.value_);
+
+    // Values that go away are kept aside, so the next values reuse their capacity
+    if (optional.has_value() && option.spare_) {
+        optional->swap(*static_cast<std::vector<T> *>(option.spare_.get()));
+    }
+
+    assign_default(option, optional);
+}
+
+template <typename V>
+void Option::reset_lazy_helper(Option &option) {
+    auto &lazy = *static_cast<LazyValue<V> *>(option.value_);
+    lazy.pending_.clear();
+    assign_default(option, lazy.value_);
+}
+
+template <typename T>
+void Option::assign_default(const Option &option, PlaceHolderType<T> &optional) {
+    if (option.default_value_.has_value()) {
+        optional = get<T>(option.default_value_.value());
+    } else {
+        optional = pstd::nullopt;
+    }
+}
+
+template <typename T>
+void Option::assign_default(const Option &option, PlaceHolderType<std::vector<T>> &optional) {
+    if (option.default_value_.has_value()) {
+        if (!optional.has_value()) {
+            optional.emplace();
+        }
+        optional->assign(1, get<T>(option.default_value_.value()));
+    } else {
+        optional = pstd::nullopt;
+    }
+}
+
+template <typename T>
+bool Option::check_helper(const Option &option, const std::string &s) {
+    const auto &value = [&s]() -> decltype(Checked<T>::convert(s)) {
+        const detail::ScopedPhase phase(Phase::kConvert);
+        return Checked<T>::convert(s);
+    }();
+
+    return option.allowed(value);
+}
+
+bool Option::set_choice(Option &option, const std::string &s) {
+    auto &choices = *static_cast<detail::ChoiceIndex *>(option.value_);
+    const std::size_t index = [&] {
+        const detail::ScopedPhase phase(Phase::kConvert);
+        return choices.spellings.find(s);
+    }();
+
+    if (index == detail::PerfectHash::kNoKey) {
+        return false;
+    }
+
+    choices.chosen = index;
+    choices.assign(choices, index);
+    return true;
+}
+
+void Option::reset_choice(Option &option) {
+    auto &choices = *static_cast<detail::ChoiceIndex *>(option.value_);
+    choices.chosen = choices.default_index;
+    choices.assign(choices, choices.default_index);
+}
+
+bool Option::check_choice(const Option &option, const std::string &s) {
+    const auto &choices = *static_cast<const detail::ChoiceIndex *>(option.value_);
+    return choices.spellings.find(s) != detail::PerfectHash::kNoKey;
+}
+
+bool Option::set_tuple(Option &option, const std::vector<std::string> &s) {
+    auto &tuple = *static_cast<detail::TupleIndex *>(option.value_);
+    if (s.size() != tuple.arity) {
+        return false;
+    }
+
+    const detail::ScopedPhase phase(Phase::kConvert);
+    return tuple.assign(tuple, s);
+}
+
+void Option::reset_tuple(Option &option) {
+    auto &tuple = *static_cast<detail::TupleIndex *>(option.value_);
+    tuple.reset(tuple);
+}
+
+bool Option::check_tuple(const Option &option, const std::string &s) {
+    return option.check(s, 0);
+}
+
+template <typename V>
+void Option::save_helper(const Option &option, detail::SnapshotWriter &out) {
+    const auto &optional = *static_cast<const PlaceHolderType<V> *>(option.value_);
+    out.put(optional.has_value());
+    if (optional.has_value()) {
+        out.put(optional.value());
+    }
+}
+
+template <typename V>
+void Option::load_helper(Option &option, detail::SnapshotReader &in) {
+    auto &optional = *static_cast<PlaceHolderType<V> *>(option.value_);
+    bool has_value = false;
+    in.get(has_value);
+    if (has_value) {
+        in.get(optional.emplace());
+    } else {
+        optional = pstd::nullopt;
+    }
+}
+
+void Option::save_choice(const Option &option, detail::SnapshotWriter &out) {
+    const auto &choices = *static_cast<const detail::ChoiceIndex *>(option.value_);
+    out.put(choices.chosen.has_value());
+    if (choices.chosen.has_value()) {
+        out.put(static_cast<uint32_t>(choices.chosen.value()));
+    }
+}
+
+void Option::load_choice(Option &option, detail::SnapshotReader &in) {
+    auto &choices = *static_cast<detail::ChoiceIndex *>(option.value_);
+    bool has_value = false;
+    in.get(has_value);
+    choices.chosen = pstd::nullopt;
+    if (has_value) {
+        uint32_t index = 0;
+        in.get(index);
+        if (index >= choices.spellings.size()) {
+            throw std::invalid_argument("snapshot holds a choice that does not exist");
+        }
+        choices.chosen = index;
+    }
+    choices.assign(choices, choices.chosen);
+}
+
+void Option::save_tuple(const Option &option, detail::SnapshotWriter &out) {
+    const auto &tuple = *static_cast<const detail::TupleIndex *>(option.value_);
+    tuple.save(tuple, out);
+}
+
+void Option::load_tuple(Option &option, detail::SnapshotReader &in) {
+    auto &tuple = *static_cast<detail::TupleIndex *>(option.value_);
+    tuple.load(tuple, in);
+}
+
+template <typename V>
+void Option::save_lazy_helper(const Option &option, detail::SnapshotWriter &out) {
+    // Values not converted yet are saved as they are, so they are still converted on first access after loading
+    const auto &lazy = *static_cast<const LazyValue<V> *>(option.value_);
+    const bool pending = !lazy.pending_.empty();
+    out.put(pending);
+    if (pending) {
+        out.put(lazy.pending_);
+        return;
+    }
+    out.put(lazy.value_.has_value());
+    if (lazy.value_.has_value()) {
+        out.put(lazy.value_.value());
+    }
+}
+
+template <typename V>
+void Option::load_lazy_helper(Option &option, detail::SnapshotReader &in) {
+    auto &lazy = *static_cast<LazyValue<V> *>(option.value_);
+    bool pending = false;
+    in.get(pending);
+    lazy.pending_.clear();
+    if (pending) {
+        const std::size_t size = in.count();
+        for (std::size_t ii = 0; ii < size; ii++) {
+            lazy.pending_.push_back(in.text());
+        }
+        return;
+    }
+
+    bool has_value = false;
+    in.get(has_value);
+    if (has_value) {
+        in.get(lazy.value_.emplace());
+    } else {
+        lazy.value_ = pstd::nullopt;
     }
+}
 
-    auto typed_ptr = std::static_pointer_cast<PlaceHolderType<T>>(placeholder_);
-    *typed_ptr = value;
+template <typename V>
+void Option::defer_helper(Option &option, const std::vector<detail::Span> &values) {
+    auto &lazy = *static_cast<LazyValue<V> *>(option.value_);
+    lazy.pending_.assign(values.begin(), values.end());
+}
+
+template <typename V>
+bool Option::resolve_helper(Option &option) {
+    const auto &lazy = *static_cast<LazyValue<V> *>(option.value_);
+    return lazy.pending_.empty() || convert_lazy(option, lazy);
+}
+
+template <typename V>
+void Option::detach_helper(Option &option) {
+    auto &lazy = *static_cast<LazyValue<V> *>(option.value_);
+    lazy.pending_.clear();
+    lazy.option_ = nullptr;
+}
+
+template <typename T>
+bool Option::convert_lazy(const Option &option, const LazyValue<T> &lazy) {
+    assert(lazy.pending_.size() == 1);
+    const auto &span = lazy.pending_.front();
+    const auto value = [&span] {
+        const detail::ScopedPhase phase(Phase::kConvert);
+        return detail::convert_helper<T>(span.str());
+    }();
+
+    // Check
+    if (!option.allowed(value)) {
+        return false;
+    }
+
+    lazy.value_ = value;
+    lazy.pending_.clear();
 
     return true;
 }
 
 template <typename T>
-bool Option::set_helper(const std::vector<std::string> &s) {
-    auto typed_ptr = std::static_pointer_cast<PlaceHolderType<std::vector<T>>>(placeholder_);
-    auto &optional = *typed_ptr;
-    optional.emplace();
+bool Option::convert_lazy(const Option &option, const LazyValue<std::vector<T>> &lazy) {
+    std::vector<T> values;
+    values.reserve(lazy.pending_.size());
 
-    for (const auto &each : s) {
-        const auto value = detail::convert_helper<T>(each);
+    for (const auto &span : lazy.pending_) {
+        const auto value = [&span] {
+            const detail::ScopedPhase phase(Phase::kConvert);
+            return detail::convert_helper<T>(span.str());
+        }();
 
         // Check
-        if (!allowed_values_.empty()) {
-            auto comparator = [&value](auto &v) { return v == value; };
-            const bool matched_any = std::any_of(allowed_values_.cbegin(), allowed_values_.cend(), comparator);
-            if (!matched_any) {
-                return false;
-            }
+        if (!option.allowed(value)) {
+            return false;
         }
 
-        optional->push_back(value);
+        values.push_back(value);
     }
 
+    lazy.value_ = std::move(values);
+    lazy.pending_.clear();
+
     return true;
 }
 
 /// @{ Explicit Instantiation
-template Option::Option(const PlaceHolder<std::string> &placeholder, Config<std::string> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<double> &placeholder, Config<double> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<float> &placeholder, Config<float> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<uint64_t> &placeholder, Config<uint64_t> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<int64_t> &placeholder, Config<int64_t> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<uint32_t> &placeholder, Config<uint32_t> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<int32_t> &placeholder, Config<int32_t> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<uint16_t> &placeholder, Config<uint16_t> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<int16_t> &placeholder, Config<int16_t> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<uint8_t> &placeholder, Config<uint8_t> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<int8_t> &placeholder, Config<int8_t> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<bool> &placeholder, Config<bool> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<char> &placeholder, Config<char> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<std::vector<std::string>> &placeholder, Config<std::string> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<std::vector<double>> &placeholder, Config<double> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<std::vector<float>> &placeholder, Config<float> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<std::vector<uint64_t>> &placeholder, Config<uint64_t> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<std::vector<int64_t>> &placeholder, Config<int64_t> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<std::vector<uint32_t>> &placeholder, Config<uint32_t> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<std::vector<int32_t>> &placeholder, Config<int32_t> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<std::vector<uint16_t>> &placeholder, Config<uint16_t> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<std::vector<int16_t>> &placeholder, Config<int16_t> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<std::vector<uint8_t>> &placeholder, Config<uint8_t> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<std::vector<int8_t>> &placeholder, Config<int8_t> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<std::vector<bool>> &placeholder, Config<bool> &&, const pstd::optional<std::size_t>);
-template Option::Option(const PlaceHolder<std::vector<char>> &placeholder, Config<char> &&, const pstd::optional<std::size_t>);
+template Option::Option(const PlaceHolder<std::string> &placeholder, Config<std::string> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<double> &placeholder, Config<double> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<float> &placeholder, Config<float> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<uint64_t> &placeholder, Config<uint64_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<int64_t> &placeholder, Config<int64_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<uint32_t> &placeholder, Config<uint32_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<int32_t> &placeholder, Config<int32_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<uint16_t> &placeholder, Config<uint16_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<int16_t> &placeholder, Config<int16_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<uint8_t> &placeholder, Config<uint8_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<int8_t> &placeholder, Config<int8_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<bool> &placeholder, Config<bool> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<char> &placeholder, Config<char> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<Bytes> &placeholder, Config<Bytes> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<Duration> &placeholder, Config<Duration> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<Rate> &placeholder, Config<Rate> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<CpuSet> &placeholder, Config<CpuSet> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<IpAddress> &placeholder, Config<IpAddress> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<Cidr> &placeholder, Config<Cidr> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<std::string>> &placeholder, Config<std::string> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<double>> &placeholder, Config<double> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<float>> &placeholder, Config<float> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<uint64_t>> &placeholder, Config<uint64_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<int64_t>> &placeholder, Config<int64_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<uint32_t>> &placeholder, Config<uint32_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<int32_t>> &placeholder, Config<int32_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<uint16_t>> &placeholder, Config<uint16_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<int16_t>> &placeholder, Config<int16_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<uint8_t>> &placeholder, Config<uint8_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<int8_t>> &placeholder, Config<int8_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<bool>> &placeholder, Config<bool> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<char>> &placeholder, Config<char> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<Bytes>> &placeholder, Config<Bytes> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<Duration>> &placeholder, Config<Duration> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<Rate>> &placeholder, Config<Rate> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<CpuSet>> &placeholder, Config<CpuSet> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<IpAddress>> &placeholder, Config<IpAddress> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const PlaceHolder<std::vector<Cidr>> &placeholder, Config<Cidr> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::string>> &lazy, Config<std::string> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<double>> &lazy, Config<double> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<float>> &lazy, Config<float> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<uint64_t>> &lazy, Config<uint64_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<int64_t>> &lazy, Config<int64_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<uint32_t>> &lazy, Config<uint32_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<int32_t>> &lazy, Config<int32_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<uint16_t>> &lazy, Config<uint16_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<int16_t>> &lazy, Config<int16_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<uint8_t>> &lazy, Config<uint8_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<int8_t>> &lazy, Config<int8_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<bool>> &lazy, Config<bool> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<char>> &lazy, Config<char> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<Bytes>> &lazy, Config<Bytes> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<Duration>> &lazy, Config<Duration> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<Rate>> &lazy, Config<Rate> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<CpuSet>> &lazy, Config<CpuSet> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<IpAddress>> &lazy, Config<IpAddress> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<Cidr>> &lazy, Config<Cidr> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<std::string>>> &lazy, Config<std::string> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<double>>> &lazy, Config<double> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<float>>> &lazy, Config<float> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<uint64_t>>> &lazy, Config<uint64_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<int64_t>>> &lazy, Config<int64_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<uint32_t>>> &lazy, Config<uint32_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<int32_t>>> &lazy, Config<int32_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<uint16_t>>> &lazy, Config<uint16_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<int16_t>>> &lazy, Config<int16_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<uint8_t>>> &lazy, Config<uint8_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<int8_t>>> &lazy, Config<int8_t> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<bool>>> &lazy, Config<bool> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<char>>> &lazy, Config<char> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<Bytes>>> &lazy, Config<Bytes> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<Duration>>> &lazy, Config<Duration> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<Rate>>> &lazy, Config<Rate> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<CpuSet>>> &lazy, Config<CpuSet> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<IpAddress>>> &lazy, Config<IpAddress> &&, const pstd::optional<std::size_t>, detail::StringPool &);
+template Option::Option(const std::shared_ptr<LazyValue<std::vector<Cidr>>> &lazy, Config<Cidr> &&, const pstd::optional<std::size_t>, detail::StringPool &);
 /// @}
 
 } // namespace argparse
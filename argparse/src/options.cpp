@@ -1,10 +1,24 @@
 #include "options.h"
 
+#include "exceptions.h"
+
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <sstream>
 
 namespace argparse {
 
+namespace {
+
+/// Number of options the tables first make room for
+constexpr std::size_t kInitialCapacity = 8;
+
+/// Number of slots of the first table of names
+constexpr std::size_t kInitialSlots = 16;
+
+} // namespace
+
 template <typename T>
 ConstPlaceHolder<T> Options::add(Config<T> &&config, const pstd::optional<std::size_t> position) {
     auto placeholder = std::make_shared<PlaceHolderType<T>>();
@@ -19,15 +33,37 @@ ConstPlaceHolder<std::vector<T>> Options::add_multivalent(Config<T> &&config) {
     return placeholder;
 }
 
+template <typename T>
+LazyPlaceHolder<T> Options::add_lazy(Config<T> &&config) {
+    auto lazy = std::make_shared<LazyValue<T>>();
+    add_helper<T>(std::move(config), lazy);
+    return lazy;
+}
+
+template <typename T>
+LazyPlaceHolder<std::vector<T>> Options::add_lazy_multivalent(Config<T> &&config) {
+    auto lazy = std::make_shared<LazyValue<std::vector<T>>>();
+    add_helper<T>(std::move(config), lazy);
+    return lazy;
+}
+
+void Options::add_choice(Config<std::string> &&config, const std::shared_ptr<detail::ChoiceIndex> &choices) {
+    auto handle = choices;
+    add_helper<std::string>(std::move(config), handle);
+}
+
+void Options::add_tuple(Config<std::string> &&config, const std::shared_ptr<detail::TupleIndex> &tuple) {
+    auto handle = tuple;
+    add_helper<std::string>(std::move(config), handle);
+}
+
 std::string Options::usage_string() const {
-    auto usage_template = [](const auto &name) { return "[--" + name + "]"; };
+    auto usage_template = [](const char *name) { return "[--" + std::string(name) + "]"; };
 
     std::stringstream ss;
-    for (const auto &pair : options_) {
-        const auto &name = pair.first;
-        const auto &option = pair.second;
+    for (const auto &option : options_) {
         if (!option->positional()) {
-            ss << usage_template(name) << " ";
+            ss << usage_template(option->name()) << " ";
         }
     }
 
@@ -37,58 +73,247 @@ std::string Options::usage_string() const {
 std::string Options::display_string() const {
     OptionTable table(OptionTable::Row{{"Required", "Positional", "Name", "Letter", "Type", "Default", "Help", "Allowed Values"}});
 
-    for (const auto &pair : options_) {
-        const auto &option = pair.second;
+    for (const auto &option : options_) {
         table.add_row(option->to_string());
     }
 
     return table.display();
 }
 
-std::shared_ptr<Option> Options::get(const std::string &name) {
-    const bool is_letter = (name.length() == 1);
+std::size_t Options::find(const char *name, const std::size_t size) const {
+    const bool is_letter = (size == 1);
 
     if (is_letter) {
-        for (const auto &pair : options_) {
-            const auto &option = pair.second;
-            if (option->letter() == name[0]) {
-                return option;
+        return find_letter(name[0]);
+    } else if (!slots_.empty()) {
+        const auto index = slots_[slot(name, size, detail::hash_string(name, size))];
+        if (index != 0) {
+            return index - 1;
+        }
+    }
+
+    return kNoOption;
+}
+
+std::size_t Options::cluster(const char *letters, const std::size_t size) const noexcept {
+    for (std::size_t ii = 0; ii < size; ii++) {
+        const auto id = find_letter(letters[ii]);
+        if (id == kNoOption) {
+            return 0;
+        }
+        if (types_[id] != Type::kBool) {
+            return ii + 1;
+        }
+    }
+
+    return size;
+}
+
+void Options::reserve(const std::size_t count) {
+    options_.reserve(count);
+    hashes_.reserve(count);
+    letters_.reserve(count);
+    types_.reserve(count);
+    flags_.reserve(count);
+
+    // At most half of the slots are used, so probing stays short
+    if (options_.capacity() * 2 > slots_.size()) {
+        grow(options_.capacity());
+    }
+}
+
+std::size_t Options::slot(const char *name, const std::size_t size, const uint32_t hash) const {
+    const std::size_t mask = slots_.size() - 1;
+    std::size_t slot = hash & mask;
+    while (slots_[slot] != 0) {
+        // Only names with the same hash are compared, names in the pool are NUL terminated so a longer name differs at [size]
+        const auto id = slots_[slot] - 1;
+        if (hashes_[id] == hash) {
+            const char *existing = options_[id]->name();
+            if ((std::memcmp(existing, name, size) == 0) && (existing[size] == '\0')) {
+                break;
             }
         }
-    } else {
-        const auto iterator = options_.find(name);
-        if (iterator != options_.end()) {
-            return iterator->second;
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+void Options::grow(const std::size_t count) {
+    std::size_t slots = std::max(kInitialSlots, slots_.size());
+    while (slots < count * 2) {
+        slots *= 2;
+    }
+
+    // Names are unique, so every option goes in the first empty slot
+    slots_.assign(slots, 0);
+    const std::size_t mask = slots - 1;
+    for (std::size_t id = 0; id < hashes_.size(); id++) {
+        std::size_t slot = hashes_[id] & mask;
+        while (slots_[slot] != 0) {
+            slot = (slot + 1) & mask;
         }
+        slots_[slot] = static_cast<uint32_t>(id + 1);
     }
+}
 
-    return nullptr;
+void Options::reset() {
+    touched_->for_each([this](const std::size_t id) { options_[id]->reset(); });
+    touched_->assign(options_.size());
 }
 
-Options::NameLetterVector Options::check_requirements(const std::unordered_set<std::string> &existing_args) const {
-    NameLetterVector missing{};
-    for (const auto &pair : required_options_) {
-        const auto &name = pair.first;
-        const auto &letter = pair.second;
-        const bool name_exists = existing_args.find(name) != existing_args.end();
-        const bool letter_exists = existing_args.find(letter) != existing_args.end();
-        if (!name_exists && !letter_exists) {
-            missing.push_back(pair);
+void Options::add_constraint(const Constraint constraint, const std::vector<std::string> &names, const std::string &subject) {
+    const bool edge = (constraint == Constraint::kRequires) || (constraint == Constraint::kConflicts);
+    if (edge == subject.empty()) {
+        throw InvalidConfig{};
+    }
+
+    Rule rule{constraint, kNoOption, detail::Bitmask(options_.size())};
+    if (edge) {
+        rule.subject = find(subject);
+        if (rule.subject == kNoOption) {
+            throw InvalidConfig{};
         }
     }
 
-    return missing;
+    for (const auto &name : names) {
+        const auto id = find(name);
+        if (id == kNoOption) {
+            throw InvalidConfig{};
+        }
+        rule.members.set(id);
+    }
+
+    rules_.push_back(std::move(rule));
+}
+
+bool Options::check_requirements(const detail::Bitmask &present, const std::function<void(const std::string &)> &missing) const {
+    if (required_.subset_of(present)) {
+        return true;
+    }
+
+    required_.for_each_missing(present, [&](const std::size_t id) { missing(options_[id]->name()); });
+    return false;
+}
+
+bool Options::check_constraints(const detail::Bitmask &present, const ConstraintCallback &violated) const {
+    bool satisfied = true;
+    for (const auto &rule : rules_) {
+        // Constraints are checked with a population count or a subset test of the given options
+        bool ok = true;
+        bool given = true;
+        switch (rule.constraint) {
+        case Constraint::kMutuallyExclusive: {
+            ok = (rule.members.count_and(present) <= 1);
+            break;
+        }
+        case Constraint::kAllOrNone: {
+            const auto count = rule.members.count_and(present);
+            ok = (count == 0) || rule.members.subset_of(present);
+            given = false;
+            break;
+        }
+        case Constraint::kAtLeastOne: {
+            ok = (rule.members.count_and(present) != 0);
+            given = false;
+            break;
+        }
+        case Constraint::kRequires: {
+            ok = !present.test(rule.subject) || rule.members.subset_of(present);
+            given = false;
+            break;
+        }
+        case Constraint::kConflicts: {
+            ok = !present.test(rule.subject) || (rule.members.count_and(present) == 0);
+            break;
+        }
+        }
+
+        if (!ok) {
+            violated(rule.constraint, names(rule.subject, rule.members, present, given));
+            satisfied = false;
+        }
+    }
+
+    return satisfied;
+}
+
+std::vector<std::string> Options::names(const std::size_t subject, const detail::Bitmask &mask, const detail::Bitmask &present, const bool given) const {
+    std::vector<std::string> out;
+    if (subject != kNoOption) {
+        out.push_back(options_[subject]->name());
+    }
+
+    auto add = [&](const std::size_t id) { out.push_back(options_[id]->name()); };
+    if (given) {
+        mask.for_each_common(present, add);
+    } else {
+        mask.for_each_missing(present, add);
+    }
+
+    return out;
 }
 
 template <typename T, typename PlaceholderType>
 void Options::add_helper(Config<T> &&config, PlaceholderType &placeholder, const pstd::optional<std::size_t> position) {
-    const auto name = config.name;
-    auto option = std::make_shared<Option>(placeholder, std::forward<Config<T>>(config), position);
-    options_[name] = option;
+    auto option = std::make_shared<Option>(placeholder, std::forward<Config<T>>(config), position, *pool_);
+
+    // The tables grow together, and by more than one option at a time
+    if (options_.size() == options_.capacity()) {
+        reserve(std::max(kInitialCapacity, options_.size() * 2));
+    }
+
+    uint8_t flags = 0;
+    flags |= option->required() ? kRequired : 0;
+    flags |= option->positional() ? kPositional : 0;
+    flags |= option->multivalent() ? kMultivalent : 0;
+    flags |= option->lazy() ? kLazy : 0;
+
+    // Registering a name again replaces the option, but keeps its id
+    const char *name = option->name();
+    const std::size_t size = std::strlen(name);
+    const uint32_t hash = detail::hash_string(name, size);
+    auto &slot = slots_[this->slot(name, size, hash)];
+    std::size_t id = options_.size();
+    if (slot != 0) {
+        id = slot - 1;
+
+        // The letter of the replaced option goes to the next option registered with it, if any
+        auto &letter_id = letter_ids_[static_cast<uint8_t>(letters_[id])];
+        if ((letters_[id] != kUnusedChar) && (letter_id == id + 1)) {
+            const auto next = std::find(letters_.begin() + static_cast<std::ptrdiff_t>(id) + 1, letters_.end(), letters_[id]);
+            letter_id = (next == letters_.end()) ? 0 : static_cast<uint32_t>(next - letters_.begin() + 1);
+        }
+
+        letters_[id] = option->letter();
+        types_[id] = option->type();
+        flags_[id] = flags;
+        options_[id] = std::move(option);
+    } else {
+        slot = static_cast<uint32_t>(id + 1);
+        hashes_.push_back(hash);
+        letters_.push_back(option->letter());
+        types_.push_back(option->type());
+        flags_.push_back(flags);
+        options_.push_back(std::move(option));
+    }
+
+    auto &letter_id = letter_ids_[static_cast<uint8_t>(letters_[id])];
+    if ((letters_[id] != kUnusedChar) && (letter_id == 0)) {
+        letter_id = static_cast<uint32_t>(id + 1);
+    }
 
-    if (config.required) {
-        const auto letter_to_str = std::string(1, config.letter);
-        required_options_.push_back({name, letter_to_str});
+    if (required(id)) {
+        required_.set(id);
+    } else {
+        required_.reset(id);
+    }
+
+    if (options_[id]->has_env()) {
+        environment_.set(id);
+    } else {
+        environment_.reset(id);
     }
 }
 
@@ -106,6 +331,12 @@ template ConstPlaceHolder<uint8_t> Options::add(Config<uint8_t> &&, const pstd::
 template ConstPlaceHolder<int8_t> Options::add(Config<int8_t> &&, const pstd::optional<std::size_t>);
 template ConstPlaceHolder<bool> Options::add(Config<bool> &&, const pstd::optional<std::size_t>);
 template ConstPlaceHolder<char> Options::add(Config<char> &&, const pstd::optional<std::size_t>);
+template ConstPlaceHolder<Bytes> Options::add(Config<Bytes> &&, const pstd::optional<std::size_t>);
+template ConstPlaceHolder<Duration> Options::add(Config<Duration> &&, const pstd::optional<std::size_t>);
+template ConstPlaceHolder<Rate> Options::add(Config<Rate> &&, const pstd::optional<std::size_t>);
+template ConstPlaceHolder<CpuSet> Options::add(Config<CpuSet> &&, const pstd::optional<std::size_t>);
+template ConstPlaceHolder<IpAddress> Options::add(Config<IpAddress> &&, const pstd::optional<std::size_t>);
+template ConstPlaceHolder<Cidr> Options::add(Config<Cidr> &&, const pstd::optional<std::size_t>);
 template ConstPlaceHolder<std::vector<std::string>> Options::add_multivalent(Config<std::string> &&);
 template ConstPlaceHolder<std::vector<double>> Options::add_multivalent(Config<double> &&);
 template ConstPlaceHolder<std::vector<float>> Options::add_multivalent(Config<float> &&);
@@ -119,6 +350,50 @@ template ConstPlaceHolder<std::vector<uint8_t>> Options::add_multivalent(Config<
 template ConstPlaceHolder<std::vector<int8_t>> Options::add_multivalent(Config<int8_t> &&);
 template ConstPlaceHolder<std::vector<bool>> Options::add_multivalent(Config<bool> &&);
 template ConstPlaceHolder<std::vector<char>> Options::add_multivalent(Config<char> &&);
+template ConstPlaceHolder<std::vector<Bytes>> Options::add_multivalent(Config<Bytes> &&);
+template ConstPlaceHolder<std::vector<Duration>> Options::add_multivalent(Config<Duration> &&);
+template ConstPlaceHolder<std::vector<Rate>> Options::add_multivalent(Config<Rate> &&);
+template ConstPlaceHolder<std::vector<CpuSet>> Options::add_multivalent(Config<CpuSet> &&);
+template ConstPlaceHolder<std::vector<IpAddress>> Options::add_multivalent(Config<IpAddress> &&);
+template ConstPlaceHolder<std::vector<Cidr>> Options::add_multivalent(Config<Cidr> &&);
+template LazyPlaceHolder<std::string> Options::add_lazy(Config<std::string> &&);
+template LazyPlaceHolder<double> Options::add_lazy(Config<double> &&);
+template LazyPlaceHolder<float> Options::add_lazy(Config<float> &&);
+template LazyPlaceHolder<uint64_t> Options::add_lazy(Config<uint64_t> &&);
+template LazyPlaceHolder<int64_t> Options::add_lazy(Config<int64_t> &&);
+template LazyPlaceHolder<uint32_t> Options::add_lazy(Config<uint32_t> &&);
+template LazyPlaceHolder<int32_t> Options::add_lazy(Config<int32_t> &&);
+template LazyPlaceHolder<uint16_t> Options::add_lazy(Config<uint16_t> &&);
+template LazyPlaceHolder<int16_t> Options::add_lazy(Config<int16_t> &&);
+template LazyPlaceHolder<uint8_t> Options::add_lazy(Config<uint8_t> &&);
+template LazyPlaceHolder<int8_t> Options::add_lazy(Config<int8_t> &&);
+template LazyPlaceHolder<bool> Options::add_lazy(Config<bool> &&);
+template LazyPlaceHolder<char> Options::add_lazy(Config<char> &&);
+template LazyPlaceHolder<Bytes> Options::add_lazy(Config<Bytes> &&);
+template LazyPlaceHolder<Duration> Options::add_lazy(Config<Duration> &&);
+template LazyPlaceHolder<Rate> Options::add_lazy(Config<Rate> &&);
+template LazyPlaceHolder<CpuSet> Options::add_lazy(Config<CpuSet> &&);
+template LazyPlaceHolder<IpAddress> Options::add_lazy(Config<IpAddress> &&);
+template LazyPlaceHolder<Cidr> Options::add_lazy(Config<Cidr> &&);
+template LazyPlaceHolder<std::vector<std::string>> Options::add_lazy_multivalent(Config<std::string> &&);
+template LazyPlaceHolder<std::vector<double>> Options::add_lazy_multivalent(Config<double> &&);
+template LazyPlaceHolder<std::vector<float>> Options::add_lazy_multivalent(Config<float> &&);
+template LazyPlaceHolder<std::vector<uint64_t>> Options::add_lazy_multivalent(Config<uint64_t> &&);
+template LazyPlaceHolder<std::vector<int64_t>> Options::add_lazy_multivalent(Config<int64_t> &&);
+template LazyPlaceHolder<std::vector<uint32_t>> Options::add_lazy_multivalent(Config<uint32_t> &&);
+template LazyPlaceHolder<std::vector<int32_t>> Options::add_lazy_multivalent(Config<int32_t> &&);
+template LazyPlaceHolder<std::vector<uint16_t>> Options::add_lazy_multivalent(Config<uint16_t> &&);
+template LazyPlaceHolder<std::vector<int16_t>> Options::add_lazy_multivalent(Config<int16_t> &&);
+template LazyPlaceHolder<std::vector<uint8_t>> Options::add_lazy_multivalent(Config<uint8_t> &&);
+template LazyPlaceHolder<std::vector<int8_t>> Options::add_lazy_multivalent(Config<int8_t> &&);
+template LazyPlaceHolder<std::vector<bool>> Options::add_lazy_multivalent(Config<bool> &&);
+template LazyPlaceHolder<std::vector<char>> Options::add_lazy_multivalent(Config<char> &&);
+template LazyPlaceHolder<std::vector<Bytes>> Options::add_lazy_multivalent(Config<Bytes> &&);
+template LazyPlaceHolder<std::vector<Duration>> Options::add_lazy_multivalent(Config<Duration> &&);
+template LazyPlaceHolder<std::vector<Rate>> Options::add_lazy_multivalent(Config<Rate> &&);
+template LazyPlaceHolder<std::vector<CpuSet>> Options::add_lazy_multivalent(Config<CpuSet> &&);
+template LazyPlaceHolder<std::vector<IpAddress>> Options::add_lazy_multivalent(Config<IpAddress> &&);
+template LazyPlaceHolder<std::vector<Cidr>> Options::add_lazy_multivalent(Config<Cidr> &&);
 /// @}
 
 } // namespace argparse
@@ -0,0 +1,265 @@
+#include "parse_cache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace argparse {
+namespace detail {
+
+namespace {
+
+/// Marks a region that is set up as a cache, "argcache" in little endian
+constexpr uint64_t kMagic = 0x6568636163677261ULL;
+
+/// Layout of the region, changed whenever the layout of the region or of a snapshot changes
+constexpr uint32_t kVersion = 1;
+
+/// Bytes of region per slot of the table
+constexpr std::size_t kBytesPerSlot = 256;
+
+/// Fewest slots of the table
+constexpr std::size_t kMinSlots = 16;
+
+/// Most slots probed for a key, an insert past this many taken slots is dropped
+constexpr std::size_t kMaxProbes = 32;
+
+/// Entries start on 8 byte boundaries
+constexpr std::size_t align(const std::size_t size) {
+    return (size + 7) & ~std::size_t{7};
+}
+
+/// Releases a lock taken on a file descriptor then closes it when going out of scope
+/// The lock is released explicitly, a mapping of the file keeps it held past the close otherwise
+struct Descriptor {
+    int fd;
+    ~Descriptor() {
+        if (fd >= 0) {
+            ::flock(fd, LOCK_UN);
+            ::close(fd);
+        }
+    }
+};
+
+} // namespace
+
+/// Processes that share the region only share its bytes, so only lock free atomics are used
+struct ParseCache::Header {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t slots;             /// Number of slots of the table, a power of 2
+    std::atomic<uint64_t> used; /// Offset of the end of the last entry
+    std::atomic<uint64_t> count; /// Number of entries
+};
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "Atomics are shared as plain words");
+
+struct ParseCache::Entry {
+    uint64_t hash;
+    uint32_t key_size;
+    uint32_t snapshot_size;
+
+    const char *key() const { return reinterpret_cast<const char *>(this + 1); }
+    const char *snapshot() const { return key() + key_size; }
+};
+
+ParseCache::ParseCache(const std::string &path, const std::size_t size) {
+    // The lock keeps another process from setting up the same new file at the same time
+    const Descriptor file{::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600)};
+    struct stat status {};
+    if ((file.fd < 0) || (::flock(file.fd, LOCK_EX) != 0) || (::fstat(file.fd, &status) != 0)) {
+        throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    // A new file is extended with zeros, an existing file keeps its size
+    size_ = static_cast<std::size_t>(status.st_size);
+    if (size_ == 0) {
+        if (::ftruncate(file.fd, static_cast<off_t>(size)) != 0) {
+            throw std::system_error(errno, std::generic_category(), path);
+        }
+        size_ = size;
+    }
+
+    void *map = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, file.fd, 0);
+    if (map == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(), path);
+    }
+    header_ = static_cast<Header *>(map);
+    mapped_ = true;
+
+    try {
+        attach();
+    } catch (...) {
+        ::munmap(map, size_);
+        throw;
+    }
+}
+
+ParseCache::ParseCache(void *region, const std::size_t size) : header_(static_cast<Header *>(region)), size_(size) {
+    attach();
+}
+
+ParseCache::~ParseCache() {
+    if (mapped_) {
+        ::munmap(header_, size_);
+    }
+}
+
+void ParseCache::attach() {
+    if (size_ < sizeof(Header) + kMinSlots * kBytesPerSlot) {
+        throw std::invalid_argument("a parse cache needs at least " + std::to_string(sizeof(Header) + kMinSlots * kBytesPerSlot) + " bytes");
+    }
+
+    // A region of zeros has a table of empty slots already
+    if (header_->magic == 0) {
+        std::size_t slots = kMinSlots;
+        while (slots * 2 <= size_ / kBytesPerSlot) {
+            slots *= 2;
+        }
+        header_->version = kVersion;
+        header_->slots = static_cast<uint32_t>(slots);
+        new (&header_->used) std::atomic<uint64_t>(align(sizeof(Header) + slots * sizeof(uint64_t)));
+        new (&header_->count) std::atomic<uint64_t>(0);
+        header_->magic = kMagic;
+        slots_ = slots;
+        return;
+    }
+
+    // The table is probed with a mask of the number of slots, so that must be a power of 2
+    const std::size_t slots = header_->slots;
+    const bool power_of_2 = (slots != 0) && ((slots & (slots - 1)) == 0);
+    if ((header_->magic != kMagic) || (header_->version != kVersion) || !power_of_2 ||
+        (sizeof(Header) + slots * sizeof(uint64_t) > size_)) {
+        throw std::invalid_argument("the region is not a parse cache of this version");
+    }
+    slots_ = slots;
+}
+
+std::atomic<uint64_t> *ParseCache::slots() const noexcept {
+    return reinterpret_cast<std::atomic<uint64_t> *>(header_ + 1);
+}
+
+const ParseCache::Entry *ParseCache::entry(const uint64_t offset) const noexcept {
+    // Entries are aligned, after the table, and before the end of the entries appended so far
+    const uint64_t table_end = align(sizeof(Header) + slots_ * sizeof(uint64_t));
+    const uint64_t used = std::min<uint64_t>(header_->used.load(std::memory_order_acquire), size_);
+    if ((offset < table_end) || (offset >= used) || (offset % 8 != 0) || (size_ - offset < sizeof(Entry))) {
+        return nullptr;
+    }
+
+    // The sizes are 32 bits, so their sum can not overflow
+    const auto *found = reinterpret_cast<const Entry *>(reinterpret_cast<const char *>(header_) + offset);
+    if (uint64_t{found->key_size} + found->snapshot_size > size_ - offset - sizeof(Entry)) {
+        return nullptr;
+    }
+    return found;
+}
+
+pstd::optional<std::size_t> ParseCache::slot(const std::string &key, const uint64_t hash) const {
+    const std::size_t mask = slots_ - 1;
+    for (std::size_t probe = 0; probe < kMaxProbes; probe++) {
+        const std::size_t index = (hash + probe) & mask;
+        const uint64_t offset = slots()[index].load(std::memory_order_acquire);
+        if (offset == 0) {
+            return index;
+        }
+
+        // A slot of an entry that does not fit is skipped, as taken by another key
+        const auto *found = entry(offset);
+        if ((found != nullptr) && (found->hash == hash) && (found->key_size == key.size()) &&
+            (std::memcmp(found->key(), key.data(), key.size()) == 0)) {
+            return index;
+        }
+    }
+    return {};
+}
+
+pstd::optional<Span> ParseCache::find(const std::string &key) const {
+    const auto index = slot(key, hash(key.data(), key.size()));
+    if (!index.has_value()) {
+        return {};
+    }
+
+    const uint64_t offset = slots()[index.value()].load(std::memory_order_acquire);
+    if (offset == 0) {
+        return {};
+    }
+
+    const auto *found = entry(offset);
+    if (found == nullptr) {
+        return {};
+    }
+    return Span{found->snapshot(), found->snapshot_size};
+}
+
+bool ParseCache::insert(const std::string &key, const std::string &snapshot) {
+    const uint64_t fingerprint = hash(key.data(), key.size());
+    auto index = slot(key, fingerprint);
+    if (!index.has_value()) {
+        return false;
+    }
+    if (slots()[index.value()].load(std::memory_order_acquire) != 0) {
+        return true;
+    }
+
+    // Room for the entry is taken for good, even if another insert of the same key wins the slot
+    // The end of the entries is read from the region, so it is checked against the table and the size of the region
+    // without adding to it, which could wrap around
+    const std::size_t bytes = align(sizeof(Entry) + key.size() + snapshot.size());
+    const uint64_t table_end = align(sizeof(Header) + slots_ * sizeof(uint64_t));
+    const auto fits = [&](const uint64_t offset) { return (offset >= table_end) && (offset <= size_) && (bytes <= size_ - offset); };
+    if (!fits(header_->used.load())) {
+        return false;
+    }
+    const uint64_t offset = header_->used.fetch_add(bytes);
+    if (!fits(offset)) {
+        return false;
+    }
+
+    char *const at = reinterpret_cast<char *>(header_) + offset;
+    const Entry entry{fingerprint, static_cast<uint32_t>(key.size()), static_cast<uint32_t>(snapshot.size())};
+    std::memcpy(at, &entry, sizeof(Entry));
+    std::memcpy(at + sizeof(Entry), key.data(), key.size());
+    std::memcpy(at + sizeof(Entry) + key.size(), snapshot.data(), snapshot.size());
+
+    // Publishes the entry, or finds the slot taken by another insert, which may be of the same key
+    while (true) {
+        uint64_t expected = 0;
+        if (slots()[index.value()].compare_exchange_strong(expected, offset, std::memory_order_release, std::memory_order_acquire)) {
+            header_->count.fetch_add(1);
+            return true;
+        }
+
+        index = slot(key, fingerprint);
+        if (!index.has_value()) {
+            return false;
+        }
+        if (slots()[index.value()].load(std::memory_order_acquire) != 0) {
+            return true;
+        }
+    }
+}
+
+uint64_t ParseCache::hash(const char *data, const std::size_t size, uint64_t seed) {
+    for (std::size_t ii = 0; ii < size; ii++) {
+        seed ^= static_cast<uint8_t>(data[ii]);
+        seed *= 1099511628211ULL;
+    }
+    return seed;
+}
+
+std::size_t ParseCache::size() const noexcept {
+    return static_cast<std::size_t>(header_->count.load());
+}
+
+} // namespace detail
+} // namespace argparse
@@ -1,80 +1,108 @@
 #include "parser.h"
-#include "options.h"
-
-#include <cassert>
+#include "utils.h"
 
 namespace argparse {
 namespace detail {
 
-Args Parser::parse(const int argc, const char **argv) {
-    Args args{};
-    std::string last_option;
-    bool is_splitted_args = false;
+const Args &Parser::parse(const int argc, const char **argv, const Options &options) {
+    const auto &tokens = classify(argc, argv);
+    return parse(tokens.data(), tokens.size(), options);
+}
+
+const Args &Parser::parse(const Token *tokens, const std::size_t count, const Options &options) {
+    args_.reset(options.size());
+    last_option_ = kNoOption;
+    any_option_ = false;
+    is_splitted_args_ = false;
 
-    for (std::size_t ii = 0; ii < static_cast<std::size_t>(argc); ii++) {
-        parse_arg(args, last_option, argv[ii], is_splitted_args);
+    for (std::size_t ii = 0; ii < count; ii++) {
+        parse_arg(options, tokens[ii], ii);
     }
 
-    return args;
+    return args_;
 }
 
-void Parser::parse_arg(Args &args, std::string &last_option, std::string &&s, bool &is_splitted_args) {
-    constexpr char kSplitter[] = "--";
-
-    if (is_splitted_args) {
+void Parser::parse_arg(const Options &options, const Token &token, const std::size_t index) {
+    if (is_splitted_args_) {
         // Rest of arguments go under this category
-        args.insert(kRemainingArgsKey, std::move(s));
-    } else if (s == kSplitter) {
-        is_splitted_args = true;
-    } else if (is_option(s)) {
-        // If this is an option, set it as the option for future token
-        strip_prefix(s);
-
-        // Handle key=value syntax by adding first value
-        if (s.find('=') != std::string::npos) {
-            last_option = s.substr(0, s.find('='));
-            args.create(last_option);
-            args.insert(last_option, s.substr(s.find('=') + 1, s.length()));
+        args_.add_remaining(Span{token.data, token.size});
+    } else if ((token.flags & Token::kSplitter) != 0) {
+        is_splitted_args_ = true;
+    } else if ((token.flags & Token::kOption) != 0) {
+        any_option_ = true;
+
+        // Resolve the option right away, handling key=value syntax by only looking up the key
+        const std::size_t prefix = token.prefix();
+        key_.assign(token.data + prefix, (token.equals > prefix) ? (token.equals - prefix) : 0);
+
+        last_option_ = options.find(key_);
+        if ((last_option_ == kNoOption) && ((token.flags & Token::kLongPrefix) == 0) && (key_.size() > 1)) {
+            // Not a name, so maybe a cluster of letters such as -xvf
+            const std::size_t letters = options.cluster(key_.data(), key_.size());
+            if (letters != 0) {
+                parse_cluster(options, token, letters, index);
+                return;
+            }
+        }
+        if (last_option_ == kNoOption) {
+            args_.add_unknown(index, Span{token.data + prefix, key_.size()});
             return;
         }
 
-        last_option = std::move(s);
-        args.create(last_option);
-    } else {
-        // No last option means an option has not been found yet
-        // It is assumed to be a positional argument
-        if (last_option.empty()) {
-            positional_args_.push_back(std::move(s));
-            return;
+        args_.mark(last_option_, index);
+        if (token.equals != token.size) {
+            const std::size_t offset = token.equals + 1;
+            add_value(options, last_option_, Span{token.data + offset, token.size - offset}, index);
         }
+    } else if (!any_option_) {
+        // No option has been found yet, so it is assumed to be a positional argument
+        args_.add_positional(Span{token.data, token.size});
+    } else if (last_option_ != kNoOption) {
+        // Map the option to this value, values of unknown options are skipped
+        add_value(options, last_option_, Span{token.data, token.size}, index);
+    }
+}
 
-        // Map the option to this value
-        args.insert(last_option, std::move(s));
+void Parser::parse_cluster(const Options &options, const Token &token, const std::size_t letters, const std::size_t index) {
+    const std::size_t prefix = token.prefix();
+    for (std::size_t ii = 0; ii < letters; ii++) {
+        last_option_ = options.find_letter(token.data[prefix + ii]);
+        args_.mark(last_option_, index);
+    }
+
+    // The letters after the last option are its value, as in -ofile
+    const std::size_t attached = prefix + letters;
+    if (attached < token.equals) {
+        add_value(options, last_option_, Span{token.data + attached, token.equals - attached}, index);
+    }
+    if (token.equals != token.size) {
+        const std::size_t offset = token.equals + 1;
+        add_value(options, last_option_, Span{token.data + offset, token.size - offset}, index);
     }
 }
 
-bool Parser::is_option(const std::string &s) {
-    assert(s.length() > 0);
+void Parser::add_value(const Options &options, const std::size_t id, const Span value, const std::size_t index) {
+    auto &slot = args_.mark(id, index);
 
-    if (s[0] == '-') {
-        // Check for signed integers
-        if (s.length() > 1) {
-            if (0 != std::isdigit(s[1])) {
-                return false;
+    if (options.multivalent(id)) {
+        // Options with a fixed number of values flag the first value beyond it, where it appears
+        const std::size_t arity = options.arity(id);
+        for_each_value(value.data, value.size, [&slot, arity, index](const char *data, const std::size_t length) {
+            if ((arity != 0) && (slot.values.size() == arity) && (slot.surplus == kNoIndex)) {
+                slot.surplus = index;
             }
-        }
-        return true;
+            slot.values.push_back(Span{data, length});
+        });
+        return;
     }
 
-    return (s.length() >= 2 && s[0] == '-' && s[1] == '-');
-}
-
-void Parser::strip_prefix(std::string &s) {
-    assert(s[0] == '-');
-    s.erase(0, 1);
-    if (s[0] == '-') {
-        s.erase(0, 1);
+    // Booleans take no values, otherwise a single value, so anything beyond is flagged where it appears
+    const bool accepts = (options.type(id) != Type::kBool) && slot.values.empty();
+    if (!accepts && slot.surplus == kNoIndex) {
+        slot.surplus = index;
     }
+
+    slot.values.push_back(value);
 }
 
 } // namespace detail
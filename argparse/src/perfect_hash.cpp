@@ -0,0 +1,160 @@
+#include "perfect_hash.h"
+
+#include "exceptions.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace argparse {
+namespace detail {
+
+namespace {
+
+/// 64 bit FNV-1a followed by the finalizer of MurmurHash3, so every bit of the result depends on every character
+uint64_t hash_key(const char *data, const std::size_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (std::size_t ii = 0; ii < size; ii++) {
+        hash ^= static_cast<uint8_t>(data[ii]);
+        hash *= 1099511628211ULL;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/// \return The bucket of a key
+uint32_t bucket(const uint64_t hash, const uint32_t mask) {
+    return static_cast<uint32_t>(hash >> 32) & mask;
+}
+
+} // namespace
+
+constexpr std::size_t PerfectHash::kNoKey;
+
+PerfectHash::PerfectHash(const std::vector<std::string> &keys) : size_(keys.size()) {
+    if (keys.empty()) {
+        return;
+    }
+
+    std::vector<uint64_t> hashes;
+    hashes.reserve(keys.size());
+    for (const auto &key : keys) {
+        hashes.push_back(hash_key(key.data(), key.size()));
+    }
+
+    // Keys with the same hash can not be told apart by any displacement, which in practice only happens for repeated keys
+    std::vector<std::size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&hashes](const std::size_t a, const std::size_t b) { return hashes[a] < hashes[b]; });
+    for (std::size_t ii = 1; ii < order.size(); ii++) {
+        if (hashes[order[ii]] == hashes[order[ii - 1]]) {
+            throw InvalidConfig{};
+        }
+    }
+
+    uint32_t mask = 1;
+    while (mask < keys.size() - 1) {
+        mask = (mask << 1) | 1;
+    }
+    while (!build(keys, hashes, mask)) {
+        mask = (mask << 1) | 1;
+    }
+}
+
+std::size_t PerfectHash::find(const char *data, const std::size_t size) const {
+    if (size_ == 0) {
+        return kNoKey;
+    }
+
+    const uint64_t hash = hash_key(data, size);
+    const uint32_t index = slot(hash, displacements_[bucket(hash, mask_)]);
+    const auto &key = keys_[index];
+    if ((indices_[index] == kNoKey) || (key.size != size) || (std::memcmp(text_.data() + key.offset, data, size) != 0)) {
+        return kNoKey;
+    }
+
+    return indices_[index];
+}
+
+uint32_t PerfectHash::slot(const uint64_t hash, const Displacement displacement) const noexcept {
+    const auto base = static_cast<uint32_t>(hash);
+    const auto step = static_cast<uint32_t>((hash * 0x9E3779B97F4A7C15ULL) >> 32) | 1;
+    return (base + displacement.multiplier * step + displacement.offset) & mask_;
+}
+
+bool PerfectHash::build(const std::vector<std::string> &keys, const std::vector<uint64_t> &hashes, const uint32_t mask) {
+    mask_ = mask;
+    const std::size_t slots = std::size_t{mask} + 1;
+
+    std::vector<std::vector<std::size_t>> buckets(slots);
+    for (std::size_t ii = 0; ii < keys.size(); ii++) {
+        buckets[bucket(hashes[ii], mask)].push_back(ii);
+    }
+
+    // The largest buckets are the hardest to place, so they go first while most slots are free
+    std::vector<uint32_t> order(slots);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&buckets](const uint32_t a, const uint32_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    displacements_.assign(slots, Displacement{0, 0});
+    indices_.assign(slots, kNoKey);
+    std::vector<uint32_t> placed;
+    for (const uint32_t b : order) {
+        const auto &members = buckets[b];
+        if (members.empty()) {
+            break;
+        }
+
+        // Every slot is reachable with a multiplier of 0, so a bucket of one key is always placed
+        bool found = false;
+        for (uint32_t multiplier = 0; (multiplier < slots) && !found; multiplier++) {
+            for (uint32_t offset = 0; (offset < slots) && !found; offset++) {
+                const Displacement displacement{multiplier, offset};
+                placed.clear();
+                for (const auto member : members) {
+                    const uint32_t index = slot(hashes[member], displacement);
+                    if ((indices_[index] != kNoKey) || (std::find(placed.begin(), placed.end(), index) != placed.end())) {
+                        break;
+                    }
+                    placed.push_back(index);
+                }
+
+                if (placed.size() == members.size()) {
+                    displacements_[b] = displacement;
+                    for (std::size_t ii = 0; ii < members.size(); ii++) {
+                        indices_[placed[ii]] = members[ii];
+                    }
+                    found = true;
+                }
+            }
+        }
+
+        if (!found) {
+            return false;
+        }
+    }
+
+    // Stores the keys by slot, so a search reads the key next to the slot it lands on
+    keys_.assign(slots, PooledString{});
+    text_.clear();
+    for (std::size_t ii = 0; ii < slots; ii++) {
+        if (indices_[ii] != kNoKey) {
+            const auto &key = keys[indices_[ii]];
+            keys_[ii] = PooledString{static_cast<uint32_t>(text_.size()), static_cast<uint32_t>(key.size())};
+            text_.insert(text_.end(), key.begin(), key.end());
+            text_.push_back('\0');
+        }
+    }
+
+    return true;
+}
+
+} // namespace detail
+} // namespace argparse
@@ -0,0 +1,185 @@
+#include "profiler.h"
+
+#if defined(ARGPARSE_INSTRUMENTATION)
+
+#include <chrono>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace argparse {
+namespace detail {
+
+namespace {
+
+/// The profiler of the session running on this thread
+thread_local Profiler *active_profiler = nullptr;
+
+/// Per thread group of hardware counters, opened once on first use and kept open for the lifetime of the thread
+/// If the counters can not be opened (not Linux, no permission, virtualized PMU), reads return zeros
+class HardwareCounters {
+  public:
+    struct Values {
+        uint64_t cycles = 0;
+        uint64_t instructions = 0;
+    };
+
+    static HardwareCounters &instance() {
+        thread_local HardwareCounters counters;
+        return counters;
+    }
+
+    bool available() const noexcept {
+        return leader_ >= 0;
+    }
+
+    Values read() const noexcept {
+        Values values{};
+#if defined(__linux__)
+        if (!available()) {
+            return values;
+        }
+
+        // Layout of a group read with [PERF_FORMAT_GROUP] : { nr, value[nr] }
+        uint64_t buffer[1 + kNumCounters] = {};
+        if (::read(leader_, buffer, sizeof(buffer)) == static_cast<ssize_t>(sizeof(buffer))) {
+            values.cycles = buffer[1];
+            values.instructions = buffer[2];
+        }
+#endif
+        return values;
+    }
+
+    ~HardwareCounters() {
+#if defined(__linux__)
+        if (member_ >= 0) {
+            close(member_);
+        }
+        if (leader_ >= 0) {
+            close(leader_);
+        }
+#endif
+    }
+
+    HardwareCounters(const HardwareCounters &) = delete;
+    HardwareCounters(HardwareCounters &&) = delete;
+    HardwareCounters &operator=(const HardwareCounters &) = delete;
+    HardwareCounters &operator=(HardwareCounters &&) = delete;
+
+  private:
+    static constexpr std::size_t kNumCounters = 2;
+
+    int leader_ = -1; /// Cycles counter, leader of the group
+    int member_ = -1; /// Instructions counter
+
+    HardwareCounters() {
+#if defined(__linux__)
+        leader_ = open(PERF_COUNT_HW_CPU_CYCLES, -1);
+        if (leader_ < 0) {
+            return;
+        }
+
+        member_ = open(PERF_COUNT_HW_INSTRUCTIONS, leader_);
+        if (member_ < 0) {
+            close(leader_);
+            leader_ = -1;
+            return;
+        }
+
+        ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+#if defined(__linux__)
+    /// Opens a user space only counter for the calling thread on any CPU
+    static int open(const uint64_t config, const int group) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = (group < 0) ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group, 0));
+    }
+#endif
+};
+
+} // namespace
+
+Profiler *Profiler::active() noexcept {
+    return active_profiler;
+}
+
+Phase Profiler::enter(const Phase phase) noexcept {
+    charge();
+    const Phase previous = current_;
+    current_ = phase;
+    profile_[phase].count++;
+    return previous;
+}
+
+void Profiler::exit(const Phase previous) noexcept {
+    charge();
+    current_ = previous;
+}
+
+void Profiler::charge() noexcept {
+    const Sample now = sample();
+    if (current_ != Phase::kCount) {
+        auto &stats = profile_[current_];
+        stats.nanoseconds += now.nanoseconds - mark_.nanoseconds;
+        stats.cycles += now.cycles - mark_.cycles;
+        stats.instructions += now.instructions - mark_.instructions;
+    }
+    mark_ = now;
+}
+
+Profiler::Sample Profiler::sample() const noexcept {
+    using Clock = std::chrono::steady_clock;
+    const auto since_epoch = Clock::now().time_since_epoch();
+
+    Sample s{};
+    s.nanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count());
+    if (profile_.hardware_counters) {
+        const auto values = HardwareCounters::instance().read();
+        s.cycles = values.cycles;
+        s.instructions = values.instructions;
+    }
+    return s;
+}
+
+ProfileSession::ProfileSession(const ProfileCallback &report) {
+    // Only the outermost session with a callback reports
+    if (!report || active_profiler != nullptr) {
+        return;
+    }
+
+    report_ = &report;
+    profiler_.profile_.hardware_counters = HardwareCounters::instance().available();
+    profiler_.mark_ = profiler_.sample();
+    active_profiler = &profiler_;
+}
+
+ProfileSession::~ProfileSession() {
+    if (report_ == nullptr) {
+        return;
+    }
+
+    active_profiler = nullptr;
+    (*report_)(profiler_.profile_);
+}
+
+} // namespace detail
+} // namespace argparse
+
+#endif
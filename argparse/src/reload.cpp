@@ -0,0 +1,152 @@
+#include "reload.h"
+
+#include <cerrno>
+#include <map>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace argparse {
+namespace detail {
+
+namespace {
+
+/// Room for many events at once, each event is at most the header and a file name
+constexpr std::size_t kEventBufferSize = 16 * 1024;
+
+/// Last value of each key of a config file, and if it was assigned
+std::map<std::string, std::pair<bool, std::string>> values(const ConfigFile &file) {
+    std::map<std::string, std::pair<bool, std::string>> values;
+    for (const auto &entry : file.entries()) {
+        std::string key = entry.section.str();
+        if (!key.empty()) {
+            key += '.';
+        }
+        key.append(entry.name.data, entry.name.size);
+        values[key] = std::make_pair(entry.assigned, entry.value.str());
+    }
+    return values;
+}
+
+} // namespace
+
+FileWatch::FileWatch(const std::string &path) {
+    const auto slash = path.rfind('/');
+    const std::string directory = (slash == std::string::npos) ? "." : (slash == 0) ? "/" : path.substr(0, slash);
+    name_ = (slash == std::string::npos) ? path : path.substr(slash + 1);
+
+#if defined(__linux__)
+    fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    // Written in place, or replaced by a rename
+    if (::inotify_add_watch(fd_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        const int error = errno;
+        ::close(fd_);
+        throw std::system_error(error, std::generic_category(), path);
+    }
+    buffer_.resize(kEventBufferSize);
+#endif
+}
+
+FileWatch::~FileWatch() {
+#if defined(__linux__)
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+#endif
+}
+
+bool FileWatch::wait(const std::chrono::milliseconds timeout) {
+#if defined(__linux__)
+    pollfd request{fd_, POLLIN, 0};
+    if (::poll(&request, 1, static_cast<int>(timeout.count())) <= 0) {
+        return false;
+    }
+
+    // Drain every event, any of them may be for the file
+    bool changed = false;
+    ssize_t count = 0;
+    while ((count = ::read(fd_, buffer_.data(), buffer_.size())) > 0) {
+        for (ssize_t offset = 0; offset < count;) {
+            const auto *event = reinterpret_cast<const inotify_event *>(buffer_.data() + offset);
+            changed |= (event->len != 0) && (name_ == event->name);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        }
+    }
+    return changed;
+#else
+    std::this_thread::sleep_for(timeout);
+    return true;
+#endif
+}
+
+constexpr std::size_t Epochs::kSlots;
+constexpr uint64_t Epochs::kIdle;
+
+std::size_t Epochs::claim() {
+    for (std::size_t slot = 0; slot < kSlots; slot++) {
+        bool claimed = false;
+        if (slots_[slot].claimed.compare_exchange_strong(claimed, true)) {
+            return slot;
+        }
+    }
+    throw std::length_error("Every reader slot is taken");
+}
+
+void Epochs::release(const std::size_t slot) noexcept {
+    slots_[slot].epoch.store(kIdle);
+    slots_[slot].claimed.store(false);
+}
+
+uint64_t Epochs::advance() noexcept {
+    return epoch_.fetch_add(1) + 1;
+}
+
+uint64_t Epochs::oldest() const noexcept {
+    uint64_t oldest = epoch_.load();
+    for (const auto &slot : slots_) {
+        const uint64_t epoch = slot.epoch.load();
+        if ((epoch != kIdle) && (epoch < oldest)) {
+            oldest = epoch;
+        }
+    }
+    return oldest;
+}
+
+std::vector<std::string> diff(const ConfigFile &before, const ConfigFile &after) {
+    const auto old_values = values(before);
+    const auto new_values = values(after);
+
+    // Both maps are sorted, so walk them side by side
+    std::vector<std::string> changed;
+    auto old_it = old_values.begin();
+    auto new_it = new_values.begin();
+    while ((old_it != old_values.end()) || (new_it != new_values.end())) {
+        if ((new_it == new_values.end()) || ((old_it != old_values.end()) && (old_it->first < new_it->first))) {
+            changed.push_back(old_it->first);
+            ++old_it;
+        } else if ((old_it == old_values.end()) || (new_it->first < old_it->first)) {
+            changed.push_back(new_it->first);
+            ++new_it;
+        } else {
+            if (old_it->second != new_it->second) {
+                changed.push_back(old_it->first);
+            }
+            ++old_it;
+            ++new_it;
+        }
+    }
+    return changed;
+}
+
+} // namespace detail
+} // namespace argparse
@@ -0,0 +1,58 @@
+#include "string_pool.h"
+
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+namespace argparse {
+namespace detail {
+
+namespace {
+
+/// Number of slots of the first table
+constexpr std::size_t kInitialSlots = 64;
+
+} // namespace
+
+PooledString StringPool::intern(const char *data, const std::size_t size) {
+    if ((strings_.size() + 1) * 2 > slots_.size()) {
+        grow();
+    }
+
+    const std::size_t mask = slots_.size() - 1;
+    std::size_t slot = hash_string(data, size) & mask;
+    while (slots_[slot] != 0) {
+        const auto &existing = strings_[slots_[slot] - 1];
+        if ((existing.size == size) && (std::memcmp(c_str(existing), data, size) == 0)) {
+            return existing;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    // Offsets are 32 bit, schemas are nowhere near 4 GB of text
+    assert(buffer_.size() + size < std::numeric_limits<uint32_t>::max());
+
+    const PooledString added{static_cast<uint32_t>(buffer_.size()), static_cast<uint32_t>(size)};
+    buffer_.insert(buffer_.end(), data, data + size);
+    buffer_.push_back('\0');
+    strings_.push_back(added);
+    slots_[slot] = static_cast<uint32_t>(strings_.size());
+
+    return added;
+}
+
+void StringPool::grow() {
+    slots_.assign(slots_.empty() ? kInitialSlots : slots_.size() * 2, 0);
+
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t ii = 0; ii < strings_.size(); ii++) {
+        std::size_t slot = hash_string(c_str(strings_[ii]), strings_[ii].size) & mask;
+        while (slots_[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        slots_[slot] = static_cast<uint32_t>(ii + 1);
+    }
+}
+
+} // namespace detail
+} // namespace argparse
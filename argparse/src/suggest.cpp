@@ -0,0 +1,154 @@
+#include "suggest.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace argparse {
+namespace detail {
+
+namespace {
+
+/// \return One bit for each byte in [data], modulo 64
+uint64_t signature(const char *data, const std::size_t size) {
+    uint64_t bits = 0;
+    for (std::size_t ii = 0; ii < size; ii++) {
+        bits |= uint64_t{1} << (static_cast<uint8_t>(data[ii]) & 63U);
+    }
+    return bits;
+}
+
+/// \return A lower bound of the edit distance between texts of these signatures
+/// Each edit adds at most one byte to a text and removes at most one, so it changes each difference of the sets by 1
+std::size_t distance_bound(const uint64_t a, const uint64_t b) {
+    const auto missing = static_cast<std::size_t>(__builtin_popcountll(a & ~b));
+    const auto extra = static_cast<std::size_t>(__builtin_popcountll(b & ~a));
+    return std::max(missing, extra);
+}
+
+} // namespace
+
+constexpr std::size_t EditDistance::kMaxPattern;
+constexpr std::size_t Suggestions::kMaxSuggestions;
+
+EditDistance::EditDistance(const char *pattern, const std::size_t size) : size_(size) {
+    for (std::size_t ii = 0; ii < size; ii++) {
+        positions_[static_cast<uint8_t>(pattern[ii])] |= uint64_t{1} << ii;
+    }
+}
+
+std::size_t EditDistance::operator()(const char *text, const std::size_t size, const std::size_t bound) const {
+    if (size_ == 0) {
+        return size;
+    }
+
+    // Vertical deltas of the column, all +1 for the first column, and the distance of the whole pattern
+    const uint64_t last = uint64_t{1} << (size_ - 1);
+    uint64_t positive = (size_ == kMaxPattern) ? ~uint64_t{0} : ((uint64_t{1} << size_) - 1);
+    uint64_t negative = 0;
+    uint64_t diagonal = 0;
+    uint64_t previous = 0;
+    std::size_t score = size_;
+
+    for (std::size_t ii = 0; ii < size; ii++) {
+        const uint64_t equal = positions_[static_cast<uint8_t>(text[ii])];
+
+        // Diagonal cells that do not grow, by a match, by the cells around them, or by swapping with the byte before
+        const uint64_t swapped = (((~diagonal) & equal) << 1U) & previous;
+        diagonal = swapped | (((equal & positive) + positive) ^ positive) | equal | negative;
+        uint64_t horizontal_positive = negative | ~(diagonal | positive);
+        uint64_t horizontal_negative = positive & diagonal;
+
+        if ((horizontal_positive & last) != 0) {
+            score++;
+        } else if ((horizontal_negative & last) != 0) {
+            score--;
+        }
+
+        // The first row is the distance from the empty pattern, which grows by 1 with each byte of the text
+        horizontal_positive = (horizontal_positive << 1U) | 1U;
+        horizontal_negative <<= 1U;
+        positive = horizontal_negative | ~(diagonal | horizontal_positive);
+        negative = horizontal_positive & diagonal;
+        previous = equal;
+
+        // Each remaining byte lowers the distance by at most 1
+        if (score > bound + (size - ii - 1)) {
+            return bound + 1;
+        }
+    }
+
+    return score;
+}
+
+void Suggestions::add(const char *name, const std::size_t size, const std::size_t id) {
+    if (groups_.size() <= size) {
+        groups_.resize(size + 1);
+    }
+
+    auto &group = groups_[size];
+    group.text.append(name, size);
+    group.signatures.push_back(signature(name, size));
+    group.ids.push_back(static_cast<uint32_t>(id));
+    size_++;
+}
+
+std::vector<std::size_t> Suggestions::suggest(const char *name, const std::size_t size) const {
+    std::vector<std::pair<std::size_t, std::size_t>> best;
+    if ((size == 0) || (size > EditDistance::kMaxPattern)) {
+        return {};
+    }
+
+    const EditDistance distance(name, size);
+    const uint64_t bits = signature(name, size);
+    std::size_t bound = std::max<std::size_t>(1, size / 3);
+
+    auto search = [&](const std::size_t length) {
+        if (length >= groups_.size()) {
+            return;
+        }
+
+        const auto &group = groups_[length];
+        for (std::size_t ii = 0; ii < group.ids.size(); ii++) {
+            if (distance_bound(bits, group.signatures[ii]) > bound) {
+                continue;
+            }
+            const std::size_t d = distance(group.text.data() + ii * length, length, bound);
+            if (d > bound) {
+                continue;
+            }
+
+            // Keep the closest, then the first added, whatever order the groups are searched in
+            const std::pair<std::size_t, std::size_t> candidate{d, group.ids[ii]};
+            if ((best.size() == kMaxSuggestions) && !(candidate < best.back())) {
+                continue;
+            }
+            best.insert(std::upper_bound(best.begin(), best.end(), candidate), candidate);
+            if (best.size() > kMaxSuggestions) {
+                best.pop_back();
+            }
+            if (best.size() == kMaxSuggestions) {
+                bound = best.back().first;
+            }
+        }
+    };
+
+    // Lengths closest to the name first, so the bound tightens early, lengths further than the bound can not be within it
+    for (std::size_t offset = 0; offset <= bound; offset++) {
+        if (offset < size) {
+            search(size - offset);
+        }
+        if (offset != 0) {
+            search(size + offset);
+        }
+    }
+
+    std::vector<std::size_t> ids;
+    ids.reserve(best.size());
+    for (const auto &candidate : best) {
+        ids.push_back(candidate.second);
+    }
+    return ids;
+}
+
+} // namespace detail
+} // namespace argparse
@@ -0,0 +1,294 @@
+#include "units.h"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace argparse {
+namespace detail {
+
+namespace {
+
+/// Most digits of a fraction that are kept, so the denominator fits in 64 bits
+constexpr std::size_t kFractionDigits = 18;
+
+/// Nanoseconds per unit of time
+constexpr uint64_t kMicrosecond = 1000;
+constexpr uint64_t kMillisecond = 1000 * kMicrosecond;
+constexpr uint64_t kSecond = 1000 * kMillisecond;
+constexpr uint64_t kMinute = 60 * kSecond;
+constexpr uint64_t kHour = 60 * kMinute;
+
+/// A unit of time and its suffix, from the largest
+struct TimeUnit {
+    const char *suffix;
+    uint64_t nanoseconds;
+};
+constexpr TimeUnit kTimeUnits[] = {
+    {"h", kHour}, {"m", kMinute}, {"s", kSecond}, {"ms", kMillisecond}, {"us", kMicrosecond}, {"\xC2\xB5s", kMicrosecond}, {"ns", 1},
+};
+
+/// Prefixes of SI and IEC multiples, the Nth prefix is 1000^(N+1) or 1024^(N+1)
+constexpr char kPrefixes[] = "KMGTPE";
+
+/// A non negative decimal number, [whole] + [fraction] / [denominator]
+struct Number {
+    uint64_t whole = 0;
+    uint64_t fraction = 0;
+    uint64_t denominator = 1;
+};
+
+bool is_digit(const char c) {
+    return (c >= '0') && (c <= '9');
+}
+
+/// Parses a number such as "12" or "1.5" starting at [it]
+/// \return The first character after the number
+const char *parse_number(const char *it, const char *const end, Number &number) {
+    const char *const start = it;
+    for (; (it != end) && is_digit(*it); it++) {
+        if (__builtin_mul_overflow(number.whole, 10, &number.whole) ||
+            __builtin_add_overflow(number.whole, static_cast<uint64_t>(*it - '0'), &number.whole)) {
+            throw std::out_of_range("number does not fit");
+        }
+    }
+
+    bool digits = (it != start);
+    if ((it != end) && (*it == '.')) {
+        std::size_t count = 0;
+        for (it++; (it != end) && is_digit(*it); it++, count++) {
+            if (count < kFractionDigits) {
+                number.fraction = number.fraction * 10 + static_cast<uint64_t>(*it - '0');
+                number.denominator *= 10;
+            }
+            digits = true;
+        }
+    }
+
+    if (!digits) {
+        throw std::invalid_argument("expected a number");
+    }
+
+    return it;
+}
+
+/// \return [number] * [multiplier]
+/// \throws std::out_of_range if the product does not fit, std::invalid_argument if it is not a whole number
+uint64_t scale(const Number &number, const uint64_t multiplier) {
+    uint64_t result = 0;
+    if (__builtin_mul_overflow(number.whole, multiplier, &result)) {
+        throw std::out_of_range("value does not fit");
+    }
+
+    const auto fraction = static_cast<unsigned __int128>(number.fraction) * multiplier;
+    if (fraction % number.denominator != 0) {
+        throw std::invalid_argument("value is not a whole number of the smallest unit");
+    }
+    if (__builtin_add_overflow(result, static_cast<uint64_t>(fraction / number.denominator), &result)) {
+        throw std::out_of_range("value does not fit");
+    }
+
+    return result;
+}
+
+/// \return 1000^[power] or 1024^[power]
+uint64_t power(const uint64_t base, const std::size_t exponent) {
+    uint64_t result = 1;
+    for (std::size_t ii = 0; ii < exponent; ii++) {
+        result *= base;
+    }
+    return result;
+}
+
+/// \return The position of a SI / IEC prefix in [kPrefixes] plus one, or 0 if [c] is not a prefix
+std::size_t prefix(const char c) {
+    const char upper = (c == 'k') ? 'K' : c;
+    const char *const found = (upper == '\0') ? nullptr : std::strchr(kPrefixes, upper);
+    return (found == nullptr) ? 0 : static_cast<std::size_t>(found - kPrefixes) + 1;
+}
+
+/// \return The unit of time spelled by [size] characters at [data]
+const TimeUnit *find_time_unit(const char *data, const std::size_t size) {
+    for (const auto &unit : kTimeUnits) {
+        if ((std::strlen(unit.suffix) == size) && (std::memcmp(unit.suffix, data, size) == 0)) {
+            return &unit;
+        }
+    }
+    return nullptr;
+}
+
+/// Parses a sum of numbers with units, such as "1h30m" or "250ms"
+/// \return Total nanoseconds
+uint64_t parse_time(const char *it, const char *const end) {
+    uint64_t total = 0;
+    while (it != end) {
+        Number number;
+        it = parse_number(it, end, number);
+
+        const char *const suffix = it;
+        while ((it != end) && !is_digit(*it) && (*it != '.')) {
+            it++;
+        }
+        const auto *const unit = find_time_unit(suffix, static_cast<std::size_t>(it - suffix));
+        if (unit == nullptr) {
+            throw std::invalid_argument("expected a unit of time");
+        }
+
+        if (__builtin_add_overflow(total, scale(number, unit->nanoseconds), &total)) {
+            throw std::out_of_range("duration does not fit");
+        }
+    }
+
+    if (total > static_cast<uint64_t>(std::numeric_limits<Duration::rep>::max())) {
+        throw std::out_of_range("duration does not fit");
+    }
+
+    return total;
+}
+
+/// \return [value] followed by the SI prefix of the largest power of 1000 that divides it
+std::string with_prefix(uint64_t value) {
+    std::size_t index = 0;
+    while ((value != 0) && (value % 1000 == 0) && (index < sizeof(kPrefixes) - 1)) {
+        value /= 1000;
+        index++;
+    }
+
+    std::string out = std::to_string(value);
+    if (index == 1) {
+        out += 'k';
+    } else if (index > 1) {
+        out += kPrefixes[index - 1];
+    }
+    return out;
+}
+
+} // namespace
+
+Bytes parse_bytes(const char *data, const std::size_t size) {
+    const char *const end = data + size;
+    Number number;
+    const char *it = parse_number(data, end, number);
+
+    // Optional prefix, then an optional "i" for IEC, then an optional "B"
+    const std::size_t exponent = (it != end) ? prefix(*it) : 0;
+    uint64_t base = 1000;
+    if (exponent != 0) {
+        it++;
+        if ((it != end) && (*it == 'i')) {
+            base = 1024;
+            it++;
+        }
+    }
+    if ((it != end) && (*it == 'B')) {
+        it++;
+    }
+    if (it != end) {
+        throw std::invalid_argument("expected a size such as 512, 4KB or 4GiB");
+    }
+
+    return Bytes{scale(number, power(base, exponent))};
+}
+
+Duration parse_duration(const char *data, const std::size_t size) {
+    if ((size == 1) && (data[0] == '0')) {
+        return Duration::zero();
+    }
+    if (size == 0) {
+        throw std::invalid_argument("expected a duration such as 250ms or 1h30m");
+    }
+
+    return Duration{static_cast<Duration::rep>(parse_time(data, data + size))};
+}
+
+Rate parse_rate(const char *data, const std::size_t size) {
+    const char *const end = data + size;
+    Number number;
+    const char *it = parse_number(data, end, number);
+
+    // Optional SI prefix of the count
+    const std::size_t exponent = ((it != end) && (*it != '/')) ? prefix(*it) : 0;
+    if (exponent != 0) {
+        it++;
+    }
+    const uint64_t count = scale(number, power(1000, exponent));
+
+    // Optional period, a bare unit is one of that unit
+    Duration period{static_cast<Duration::rep>(kSecond)};
+    if (it != end) {
+        if ((*it != '/') || (++it == end)) {
+            throw std::invalid_argument("expected a rate such as 100, 10k/s or 500/100ms");
+        }
+        const auto *const unit = find_time_unit(it, static_cast<std::size_t>(end - it));
+        period = (unit != nullptr) ? Duration{static_cast<Duration::rep>(unit->nanoseconds)} : parse_duration(it, static_cast<std::size_t>(end - it));
+        if (period == Duration::zero()) {
+            throw std::invalid_argument("period of a rate must not be zero");
+        }
+    }
+
+    return Rate{count, period};
+}
+
+std::string format(const Bytes &bytes) {
+    // Picks the exact IEC or SI form with the fewest digits, IEC on a tie
+    std::string best = std::to_string(bytes.count) + "B";
+    for (const uint64_t base : {uint64_t{1000}, uint64_t{1024}}) {
+        uint64_t value = bytes.count;
+        std::size_t index = 0;
+        while ((value != 0) && (value % base == 0) && (index < sizeof(kPrefixes) - 1)) {
+            value /= base;
+            index++;
+        }
+        if (index == 0) {
+            continue;
+        }
+
+        std::string candidate = std::to_string(value);
+        candidate += (index == 1 && base == 1000) ? 'k' : kPrefixes[index - 1];
+        candidate += (base == 1024) ? "iB" : "B";
+        if (candidate.size() <= best.size()) {
+            best = std::move(candidate);
+        }
+    }
+    return best;
+}
+
+std::string format(const Duration &duration) {
+    if (duration == Duration::zero()) {
+        return "0s";
+    }
+
+    std::string out;
+    uint64_t remaining = static_cast<uint64_t>(duration.count());
+    if (duration < Duration::zero()) {
+        out += '-';
+        remaining = ~remaining + 1;
+    }
+
+    // Whole hours, minutes and seconds, then the rest in the largest unit that keeps it exact
+    for (const auto &unit : kTimeUnits) {
+        const bool exact = (unit.nanoseconds >= kSecond) || (remaining % unit.nanoseconds == 0);
+        if ((remaining >= unit.nanoseconds) && exact) {
+            out += std::to_string(remaining / unit.nanoseconds);
+            out += unit.suffix;
+            remaining %= unit.nanoseconds;
+        }
+        if (remaining == 0) {
+            break;
+        }
+    }
+    return out;
+}
+
+std::string format(const Rate &rate) {
+    std::string out = with_prefix(rate.count) + "/";
+    for (const auto &unit : kTimeUnits) {
+        if (static_cast<uint64_t>(rate.period.count()) == unit.nanoseconds) {
+            return out + unit.suffix;
+        }
+    }
+    return out + format(rate.period);
+}
+
+} // namespace detail
+} // namespace argparse
@@ -47,6 +47,12 @@ std::string Variant::string() const {
     case Type::kInt8   : ss << int8_t_;   break;
     case Type::kBool   : ss << bool_;     break;
     case Type::kChar   : ss << char_;     break;
+    case Type::kBytes    : ss << detail::format(bytes_);    break;
+    case Type::kDuration : ss << detail::format(duration_); break;
+    case Type::kRate     : ss << detail::format(rate_);     break;
+    case Type::kCpuSet   : ss << detail::format(cpu_set_);  break;
+    case Type::kIpAddress : ss << detail::format(ip_address_); break;
+    case Type::kCidr      : ss << detail::format(cidr_);       break;
     case Type::kNone   :
     default            :                  break;
     }
@@ -73,6 +79,12 @@ bool Variant::operator==(const Variant &other) const {
     case Type::kInt8   : return (int8_t_ == other.int8_t_);
     case Type::kBool   : return (bool_ == other.bool_);
     case Type::kChar   : return (char_ == other.char_);
+    case Type::kBytes    : return (bytes_ == other.bytes_);
+    case Type::kDuration : return (duration_ == other.duration_);
+    case Type::kRate     : return (rate_ == other.rate_);
+    case Type::kCpuSet   : return (cpu_set_ == other.cpu_set_);
+    case Type::kIpAddress : return (ip_address_ == other.ip_address_);
+    case Type::kCidr      : return (cidr_ == other.cidr_);
     case Type::kNone   :
     default            : assert(false);
     }
@@ -93,6 +105,12 @@ bool Variant::operator==(const uint8_t &value) const     { return (type_ == Type
 bool Variant::operator==(const int8_t &value) const      { return (type_ == Type::kInt8   && int8_t_ == value);   }
 bool Variant::operator==(const bool &value) const        { return (type_ == Type::kBool   && bool_ == value);     }
 bool Variant::operator==(const char &value) const        { return (type_ == Type::kChar   && char_ == value);     }
+bool Variant::operator==(const Bytes &value) const       { return (type_ == Type::kBytes    && bytes_ == value);    }
+bool Variant::operator==(const Duration &value) const    { return (type_ == Type::kDuration && duration_ == value); }
+bool Variant::operator==(const Rate &value) const        { return (type_ == Type::kRate     && rate_ == value);     }
+bool Variant::operator==(const CpuSet &value) const      { return (type_ == Type::kCpuSet   && cpu_set_ == value);  }
+bool Variant::operator==(const IpAddress &value) const   { return (type_ == Type::kIpAddress && ip_address_ == value); }
+bool Variant::operator==(const Cidr &value) const        { return (type_ == Type::kCidr      && cidr_ == value);       }
 
 void Variant::copy(const Variant &other) {
     switch (other.type_) {
@@ -109,6 +127,12 @@ void Variant::copy(const Variant &other) {
     case Type::kInt8   : set(other.int8_t_);   break;
     case Type::kBool   : set(other.bool_);     break;
     case Type::kChar   : set(other.char_);     break;
+    case Type::kBytes    : set(other.bytes_);    break;
+    case Type::kDuration : set(other.duration_); break;
+    case Type::kRate     : set(other.rate_);     break;
+    case Type::kCpuSet   : set(other.cpu_set_);  break;
+    case Type::kIpAddress : set(other.ip_address_); break;
+    case Type::kCidr      : set(other.cidr_);       break;
     case Type::kNone   :
     default            : assert(false);
     }
@@ -117,6 +141,8 @@ void Variant::copy(const Variant &other) {
 void Variant::destroy() {
     if (type_ == Type::kString) {
         string_.~basic_string<char>();
+    } else if (type_ == Type::kCpuSet) {
+        cpu_set_.~CpuSet();
     }
 }
 
@@ -134,6 +160,12 @@ void Variant::set(uint8_t value)     { destroy(); type_ = Type::kUint8;  ::new (
 void Variant::set(int8_t value)      { destroy(); type_ = Type::kInt8;   ::new (std::addressof(int8_t_))int8_t(value);                 }
 void Variant::set(bool value)        { destroy(); type_ = Type::kBool;   ::new (std::addressof(bool_))bool(value);                     }
 void Variant::set(char value)        { destroy(); type_ = Type::kChar;   ::new (std::addressof(char_))char(value);                     }
+void Variant::set(Bytes value)       { destroy(); type_ = Type::kBytes;    ::new (std::addressof(bytes_))Bytes(value);             }
+void Variant::set(Duration value)    { destroy(); type_ = Type::kDuration; ::new (std::addressof(duration_))Duration(value);       }
+void Variant::set(Rate value)        { destroy(); type_ = Type::kRate;     ::new (std::addressof(rate_))Rate(value);               }
+void Variant::set(CpuSet value)      { destroy(); type_ = Type::kCpuSet;   ::new (std::addressof(cpu_set_))CpuSet(std::move(value)); }
+void Variant::set(IpAddress value)   { destroy(); type_ = Type::kIpAddress; ::new (std::addressof(ip_address_))IpAddress(value); }
+void Variant::set(Cidr value)        { destroy(); type_ = Type::kCidr;      ::new (std::addressof(cidr_))Cidr(value);             }
 
 std::size_t Variant::hash::operator()(const Variant &v) const {
     const auto type_hash = std::hash<std::size_t>{}(static_cast<std::size_t>(v.type_));
@@ -151,6 +183,12 @@ std::size_t Variant::hash::operator()(const Variant &v) const {
     case Type::kInt8   : return type_hash ^ std::hash<int8_t>{}(v.int8_t_);
     case Type::kBool   : return type_hash ^ std::hash<bool>{}(v.bool_);
     case Type::kChar   : return type_hash ^ std::hash<char>{}(v.char_);
+    case Type::kBytes    : return type_hash ^ std::hash<Bytes>{}(v.bytes_);
+    case Type::kDuration : return type_hash ^ detail::Hash<Duration>{}(v.duration_);
+    case Type::kRate     : return type_hash ^ std::hash<Rate>{}(v.rate_);
+    case Type::kCpuSet   : return type_hash ^ std::hash<CpuSet>{}(v.cpu_set_);
+    case Type::kIpAddress : return type_hash ^ std::hash<IpAddress>{}(v.ip_address_);
+    case Type::kCidr      : return type_hash ^ std::hash<Cidr>{}(v.cidr_);
     case Type::kNone   :
     default            : assert(false);
     }
@@ -0,0 +1,166 @@
+#include "allocations.h"
+#include "argparse.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <streambuf>
+#include <string>
+
+using namespace argparse;
+
+namespace {
+
+/// Stream buffer that discards everything, so rendering the help message can be measured without a terminal
+class NullBuffer : public std::streambuf {
+  protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char * /*s*/, std::streamsize n) override { return n; }
+};
+
+/// Runs [f] [iterations] times after one warm up call, then prints the average time and allocations per call
+template <typename Function>
+void run(const std::string &name, const std::string &filter, const uint64_t iterations, Function &&f) {
+    if (name.find(filter) == std::string::npos) {
+        return;
+    }
+
+    f();
+
+    const auto start = std::chrono::steady_clock::now();
+    const allocations::Scope scope;
+    for (uint64_t ii = 0; ii < iterations; ii++) {
+        f();
+    }
+    const auto counts = scope.counts();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+    std::cout << std::left << std::setw(24) << name
+              << std::right << std::setw(12) << (static_cast<double>(ns) / iterations) << " ns/op";
+    if (allocations::enabled()) {
+        std::cout << std::setw(10) << (static_cast<double>(counts.allocations) / iterations) << " allocs/op"
+                  << std::setw(12) << (static_cast<double>(counts.bytes) / iterations) << " B/op";
+    }
+    std::cout << std::endl;
+}
+
+/// Registers the options used by the parse benchmarks
+void add_options(Parser &p) {
+    p.add(Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "day", .help = "Day of the week"});
+    p.add(Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "", .help = "", .required = false, .letter = 'm'});
+    p.add(Config<uint64_t>{.default_value = 5, .allowed_values = {}, .name = "verbose"});
+    p.add(Config<int64_t>{.default_value = {}, .allowed_values = {1234, 9999, 127127127}, .name = "id"});
+    p.add_multivalent(Config<std::string>{
+        .default_value = {},
+        .allowed_values = {"walk", "jog", "skip", "fly", "wade", "swim", "dive"},
+        .name = "mode",
+    });
+}
+
+/// Registers the same options as [add_options], converted on first access instead
+void add_lazy_options(Parser &p) {
+    p.add_lazy(Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "day", .help = "Day of the week"});
+    p.add_lazy(Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "", .help = "", .required = false, .letter = 'm'});
+    p.add_lazy(Config<uint64_t>{.default_value = 5, .allowed_values = {}, .name = "verbose"});
+    p.add_lazy(Config<int64_t>{.default_value = {}, .allowed_values = {1234, 9999, 127127127}, .name = "id"});
+    p.add_lazy_multivalent(Config<std::string>{
+        .default_value = {},
+        .allowed_values = {"walk", "jog", "skip", "fly", "wade", "swim", "dive"},
+        .name = "mode",
+    });
+}
+
+} // namespace
+
+int main(int argc, const char **argv) {
+    Parser args("bench", "Benchmarks of parsing, registering and rendering help");
+    const auto iterations = args.add(Config<uint64_t>{
+        .default_value = 100000,
+        .allowed_values = {},
+        .name = "iterations",
+        .help = "Number of calls per benchmark",
+    });
+    const auto filter = args.add(Config<std::string>{
+        .default_value = "",
+        .allowed_values = {},
+        .name = "filter",
+        .help = "Only run benchmarks containing this string",
+    });
+    args.parse(argc, argv);
+
+    const auto n = iterations->value();
+    const auto &f = filter->value();
+
+    {
+        Parser p;
+        add_options(p);
+        const char *input[] = {"path", "--day=wednesday", "-m", "january", "--verbose", "7", "--id", "9999"};
+        constexpr int kInputSize = sizeof(input) / sizeof(input[0]);
+        run("parse", f, n, [&] { p.parse(kInputSize, input); });
+        run("validate", f, n, [&] { p.validate(kInputSize, input); });
+    }
+
+    {
+        // A large schema, where lookups only touch the compact per option tables
+        Parser p;
+        constexpr std::size_t kLargeSchema = 3000;
+        p.reserve(kLargeSchema);
+        for (std::size_t ii = 0; ii < kLargeSchema; ii++) {
+            p.add(Config<int32_t>{.default_value = {}, .allowed_values = {}, .name = "option-" + std::to_string(ii)});
+        }
+        const char *input[] = {"path", "--option-7=1", "--option-1500", "2", "--option-2999", "3", "--option-42", "4"};
+        constexpr int kInputSize = sizeof(input) / sizeof(input[0]);
+        run("parse_large", f, n, [&] { p.parse(kInputSize, input); });
+    }
+
+    {
+        // Every rule holds for the input, so all of them are evaluated
+        Parser p;
+        add_options(p);
+        for (int ii = 0; ii < 100; ii++) {
+            p.add_group(Constraint::kMutuallyExclusive, {"day", "mode"});
+            p.add_group(Constraint::kAtLeastOne, {"m", "id"});
+            p.add_requires("id", {"verbose", "day"});
+            p.add_conflicts("verbose", {"mode"});
+        }
+        const char *input[] = {"path", "--day=wednesday", "-m", "january", "--verbose", "7", "--id", "9999"};
+        constexpr int kInputSize = sizeof(input) / sizeof(input[0]);
+        run("parse_constraints", f, n, [&] { p.parse(kInputSize, input); });
+    }
+
+    {
+        // None of the values are read, so none are converted
+        Parser p;
+        add_lazy_options(p);
+        const char *input[] = {"path", "--day=wednesday", "-m", "january", "--verbose", "7", "--id", "9999"};
+        constexpr int kInputSize = sizeof(input) / sizeof(input[0]);
+        run("parse_lazy", f, n, [&] { p.parse(kInputSize, input); });
+    }
+
+    {
+        Parser p;
+        add_options(p);
+        const char *input[] = {"path", "--mode", "walk,jog,skip,fly", "swim", "dive", "wade"};
+        constexpr int kInputSize = sizeof(input) / sizeof(input[0]);
+        run("parse_multivalent", f, n, [&] { p.parse(kInputSize, input); });
+    }
+
+    run("add", f, n, [] {
+        Parser p;
+        add_options(p);
+    });
+
+    {
+        Parser p;
+        add_options(p);
+        NullBuffer null;
+        run("help", f, n / 10, [&] {
+            auto *const original = std::cout.rdbuf(&null);
+            p.help();
+            std::cout.rdbuf(original);
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "allocations.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace allocations {
+
+namespace {
+
+/// Per thread so other threads do not disturb the counts
+thread_local Counts counts{};
+
+} // namespace
+
+bool enabled() {
+#if defined(ARGPARSE_COUNT_ALLOCATIONS)
+    return true;
+#else
+    return false;
+#endif
+}
+
+Counts current() {
+    return counts;
+}
+
+#if defined(ARGPARSE_COUNT_ALLOCATIONS)
+
+namespace {
+
+void *allocate(const std::size_t size) {
+    counts.allocations++;
+    counts.bytes += size;
+
+    // Zero sized requests must still return a unique pointer
+    void *pointer = std::malloc((size == 0) ? 1 : size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc{};
+    }
+    return pointer;
+}
+
+void *allocate(const std::size_t size, const std::nothrow_t & /*tag*/) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+} // namespace
+
+#endif
+
+} // namespace allocations
+
+#if defined(ARGPARSE_COUNT_ALLOCATIONS)
+
+/// @{ Replacements of the global allocation functions, the aligned overloads are left to the standard library
+void *operator new(std::size_t size) { return allocations::allocate(size); }
+void *operator new[](std::size_t size) { return allocations::allocate(size); }
+void *operator new(std::size_t size, const std::nothrow_t &tag) noexcept { return allocations::allocate(size, tag); }
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept { return allocations::allocate(size, tag); }
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete[](void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t /*size*/) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, std::size_t /*size*/) noexcept { std::free(pointer); }
+void operator delete(void *pointer, const std::nothrow_t & /*tag*/) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t & /*tag*/) noexcept { std::free(pointer); }
+/// @}
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// Allocation accounting for the test and bench targets
+/// When compiled with [ARGPARSE_COUNT_ALLOCATIONS], the global operator new / delete are replaced with counting versions
+namespace allocations {
+
+/// Number of allocations and bytes requested on the current thread
+struct Counts {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+/// \return If the global operator new is replaced and counting
+bool enabled();
+
+/// \return The counts of the current thread since it started
+Counts current();
+
+/// Counts the allocations made on the current thread during the lifetime of this object
+class Scope {
+  public:
+    Scope() : start_(current()) {}
+
+    /// \return The counts since construction
+    Counts counts() const {
+        const Counts now = current();
+        return {now.allocations - start_.allocations, now.bytes - start_.bytes};
+    }
+
+  private:
+    const Counts start_;
+};
+
+/// Calls [f] and returns the allocations it made
+template <typename Function>
+Counts count(Function &&f) {
+    const Scope scope;
+    f();
+    return scope.counts();
+}
+
+} // namespace allocations
@@ -0,0 +1,202 @@
+#include "catch.hpp"
+
+#include "address.h"
+#include "argparse.h"
+#include "utilities.h"
+using namespace argparse;
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Error = Parser::Diagnostic::Error;
+
+IpAddress parse_ip_address(const std::string &s) { return detail::parse_ip_address(s.data(), s.size()); }
+Cidr parse_cidr(const std::string &s) { return detail::parse_cidr(s.data(), s.size()); }
+
+/// \return An IPv6 address of 8 groups
+IpAddress v6(const std::array<uint16_t, 8> &groups) {
+    IpAddress address;
+    address.v6 = true;
+    for (std::size_t ii = 0; ii < 8; ii++) {
+        address.bytes[ii * 2] = static_cast<uint8_t>(groups[ii] >> 8U);
+        address.bytes[ii * 2 + 1] = static_cast<uint8_t>(groups[ii] & 0xFFU);
+    }
+    return address;
+}
+
+} // namespace
+
+/// Tests parsing and formatting of addresses and blocks
+TEST_CASE("IpAddress", "Parsing") {
+    SECTION("IPv4") {
+        const auto address = parse_ip_address("192.0.2.1");
+        REQUIRE(!address.v6);
+        REQUIRE(address.bits() == 32);
+        REQUIRE(address == IpAddress{{192, 0, 2, 1}, false});
+        REQUIRE(parse_ip_address("0.0.0.0") == IpAddress{});
+        REQUIRE(parse_ip_address("255.255.255.255") == IpAddress{{255, 255, 255, 255}, false});
+    }
+
+    SECTION("IPv6") {
+        REQUIRE(parse_ip_address("2001:db8:0:0:0:0:0:1") == v6({0x2001, 0xdb8, 0, 0, 0, 0, 0, 1}));
+        REQUIRE(parse_ip_address("2001:DB8::1") == v6({0x2001, 0xdb8, 0, 0, 0, 0, 0, 1}));
+        REQUIRE(parse_ip_address("::") == v6({0, 0, 0, 0, 0, 0, 0, 0}));
+        REQUIRE(parse_ip_address("::1") == v6({0, 0, 0, 0, 0, 0, 0, 1}));
+        REQUIRE(parse_ip_address("fe80::") == v6({0xfe80, 0, 0, 0, 0, 0, 0, 0}));
+        REQUIRE(parse_ip_address("1:2:3::6:7:8") == v6({1, 2, 3, 0, 0, 6, 7, 8}));
+        REQUIRE(parse_ip_address("1::3:4:5:6:7:8") == v6({1, 0, 3, 4, 5, 6, 7, 8}));
+        REQUIRE(parse_ip_address("::ffff:192.0.2.1") == v6({0, 0, 0, 0, 0, 0xffff, 0xc000, 0x0201}));
+        REQUIRE(parse_ip_address("1:2:3:4:5:6:1.2.3.4") == v6({1, 2, 3, 4, 5, 6, 0x0102, 0x0304}));
+        REQUIRE(parse_ip_address("::1").v6);
+    }
+
+    SECTION("Malformed") {
+        for (const char *malformed : {"", "1.2.3", "1.2.3.4.5", "1.2.3.256", "1.2.3.04", "1..2.3", "1.2.3.4 ", "a.b.c.d",
+                                      ":", ":::", "1:2", "1::2::3", "1:2:3:4:5:6:7:8:9", "1:2:3:4:5:6:7::8", "12345::",
+                                      ":1::", "1::2:", "g::", "1.2.3.4::", "1:2:3:4:5:6:7:1.2.3.4", "::1/64"}) {
+            INFO(malformed);
+            REQUIRE_THROWS_AS(parse_ip_address(malformed), std::invalid_argument);
+        }
+    }
+
+    SECTION("Blocks") {
+        REQUIRE(parse_cidr("10.0.0.0/8") == Cidr{IpAddress{{10}, false}, 8});
+        REQUIRE(parse_cidr("10.1.2.3/8") == parse_cidr("10.0.0.0/8"));
+        REQUIRE(parse_cidr("192.0.2.255/25") == Cidr{IpAddress{{192, 0, 2, 128}, false}, 25});
+        REQUIRE(parse_cidr("192.0.2.1") == Cidr{IpAddress{{192, 0, 2, 1}, false}, 32});
+        REQUIRE(parse_cidr("0.0.0.0/0") == Cidr{});
+        REQUIRE(parse_cidr("2001:db8:ffff::/32") == Cidr{v6({0x2001, 0xdb8, 0, 0, 0, 0, 0, 0}), 32});
+        REQUIRE(parse_cidr("::1").prefix == 128);
+
+        REQUIRE_THROWS_AS(parse_cidr("10.0.0.0/"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_cidr("10.0.0.0/08"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_cidr("10.0.0.0/8/8"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_cidr("10.0.0.0x8"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_cidr("10.0.0.0/33"), std::out_of_range);
+        REQUIRE_THROWS_AS(parse_cidr("::/129"), std::out_of_range);
+    }
+
+    SECTION("Contains") {
+        const auto block = parse_cidr("192.0.2.0/23");
+        REQUIRE(block.contains(parse_ip_address("192.0.3.255")));
+        REQUIRE(!block.contains(parse_ip_address("192.0.4.0")));
+        REQUIRE(block.contains(parse_cidr("192.0.3.0/24")));
+        REQUIRE(!block.contains(parse_cidr("192.0.0.0/16")));
+        REQUIRE(parse_cidr("::/0").contains(parse_ip_address("2001:db8::1")));
+        REQUIRE(!parse_cidr("::/0").contains(parse_ip_address("192.0.2.1")));
+    }
+
+    SECTION("Format") {
+        for (const char *canonical : {"192.0.2.1", "0.0.0.0", "::", "::1", "1::", "2001:db8::1", "2001:db8:0:1:1:1:1:1",
+                                      "1:0:0:2::3", "fe80::1:0:0:1", "::ffff:192.0.2.1", "1:2:3:4:5:6:7:8"}) {
+            REQUIRE(detail::format(parse_ip_address(canonical)) == canonical);
+        }
+        REQUIRE(detail::format(parse_ip_address("2001:0DB8:0000:0000:0000:0000:0000:0001")) == "2001:db8::1");
+        REQUIRE(detail::format(parse_cidr("10.1.2.3/8")) == "10.0.0.0/8");
+        REQUIRE(detail::format(parse_cidr("2001:db8::/32")) == "2001:db8::/32");
+    }
+}
+
+/// Tests finding addresses and blocks by the longest block that contains them
+TEST_CASE("PrefixTrie", "Parsing") {
+    detail::PrefixTrie trie;
+    REQUIRE(trie.empty());
+    REQUIRE(!trie.contains(parse_ip_address("10.0.0.1")));
+
+    for (const char *block : {"10.0.0.0/8", "10.1.0.0/16", "192.0.2.0/24", "2001:db8::/32", "10.1.0.0/16"}) {
+        trie.insert(parse_cidr(block));
+    }
+    REQUIRE(!trie.empty());
+
+    REQUIRE(trie.longest_match(parse_ip_address("10.1.2.3"), 32) == std::size_t{16});
+    REQUIRE(trie.longest_match(parse_ip_address("10.2.0.0"), 32) == std::size_t{8});
+    REQUIRE(!trie.longest_match(parse_ip_address("11.0.0.0"), 32).has_value());
+    REQUIRE(trie.contains(parse_ip_address("192.0.2.200")));
+    REQUIRE(!trie.contains(parse_ip_address("192.0.3.1")));
+    REQUIRE(trie.contains(parse_ip_address("2001:db8:1::1")));
+    REQUIRE(!trie.contains(parse_ip_address("2001:db9::1")));
+
+    // An IPv4 block does not contain IPv6 addresses with the same leading bits
+    REQUIRE(!trie.contains(parse_ip_address("a00::")));
+
+    // A block is contained only if it is as long as a block of the trie
+    REQUIRE(trie.contains(parse_cidr("10.128.0.0/9")));
+    REQUIRE(!trie.contains(parse_cidr("10.0.0.0/7")));
+
+    // A block of length 0 contains every address of its family
+    trie.insert(parse_cidr("0.0.0.0/0"));
+    REQUIRE(trie.longest_match(parse_ip_address("11.0.0.0"), 32) == std::size_t{0});
+    REQUIRE(!trie.contains(parse_ip_address("2001:db9::1")));
+}
+
+/// Tests options whose values are addresses and blocks
+TEST_CASE("AddressOptions", "Parsing") {
+    Parser p;
+    replace_exit_cb(p);
+
+    std::string not_allowed;
+    Parser::Callbacks cbs;
+    cbs.not_allowed = [&not_allowed](const std::string &name, auto) { not_allowed = name; };
+    p.set_callbacks(std::move(cbs));
+
+    const auto bind = p.add(Config<IpAddress>{.default_value = parse_ip_address("127.0.0.1"),
+                                              .allowed_values = {parse_cidr("127.0.0.0/8"), parse_cidr("10.0.0.0/8"), parse_cidr("::1")},
+                                              .name = "bind"});
+    const auto allow = p.add_multivalent(Config<Cidr>{.default_value = {},
+                                                      .allowed_values = {parse_cidr("10.0.0.0/8"), parse_cidr("fd00::/8")},
+                                                      .name = "allow"});
+    const auto peers = p.add_array<IpAddress, 2>(Config<IpAddress>{.default_value = {}, .allowed_values = {parse_cidr("192.0.2.0/24")}, .name = "peers"});
+    const auto upstream = p.add(Config<IpAddress>{.default_value = {}, .allowed_values = {}, .name = "upstream", .help = "", .required = false, .letter = kUnusedChar, .env = "UPSTREAM"});
+
+    SECTION("Values") {
+        const char *argv[] = {"path", "--bind", "10.2.3.4", "--allow", "10.1.0.0/16,fd12::/16", "--peers", "192.0.2.1,192.0.2.2", "--upstream", "2001:db8::53"};
+        p.parse(9, argv);
+        REQUIRE(bind->value() == parse_ip_address("10.2.3.4"));
+        REQUIRE(allow->value() == std::vector<Cidr>{parse_cidr("10.1.0.0/16"), parse_cidr("fd12::/16")});
+        REQUIRE(peers->value() == std::array<IpAddress, 2>{parse_ip_address("192.0.2.1"), parse_ip_address("192.0.2.2")});
+        REQUIRE(upstream->value() == parse_ip_address("2001:db8::53"));
+        REQUIRE(not_allowed.empty());
+    }
+
+    SECTION("Defaults and the environment") {
+        const char *environment[] = {"UPSTREAM=192.0.2.53", nullptr};
+        p.set_environment(environment);
+
+        const char *argv[] = {"path", "--bind", "::1"};
+        p.parse(3, argv);
+        REQUIRE(bind->value() == parse_ip_address("::1"));
+        REQUIRE(upstream->value() == parse_ip_address("192.0.2.53"));
+
+        const char *argv2[] = {"path"};
+        p.parse(1, argv2);
+        REQUIRE(bind->value() == parse_ip_address("127.0.0.1"));
+    }
+
+    SECTION("Address outside the allowed blocks") {
+        const char *argv[] = {"path", "--bind", "192.0.2.1"};
+        p.parse(3, argv);
+        REQUIRE(not_allowed == "bind");
+    }
+
+    SECTION("Block larger than the allowed blocks") {
+        const char *argv[] = {"path", "--allow", "10.0.0.0/7"};
+        p.parse(3, argv);
+        REQUIRE(not_allowed == "allow");
+    }
+
+    SECTION("Element outside the allowed blocks") {
+        const char *argv[] = {"path", "--peers", "192.0.2.1,192.0.3.1"};
+        p.parse(3, argv);
+        REQUIRE(not_allowed == "peers");
+    }
+
+    SECTION("Validate") {
+        const char *argv[] = {"path", "--bind", "10.0.0.256", "--allow", "fe80::/10"};
+        std::vector<Error> errors;
+        REQUIRE(!p.validate(5, argv, [&errors](const Parser::Diagnostic &d) { errors.push_back(d.error); }));
+        REQUIRE(errors == std::vector<Error>{Error::kInvalid, Error::kNotAllowed});
+    }
+}
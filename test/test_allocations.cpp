@@ -0,0 +1,186 @@
+#include "catch.hpp"
+
+#include "allocations.h"
+#include "argparse.h"
+#include "utilities.h"
+
+#include <array>
+#include <sstream>
+#include <tuple>
+using namespace argparse;
+
+/// These are regression bounds, not targets, and only run when operator new is replaced
+/// The counts are of steady state calls, the first call is made beforehand so lazily grown buffers are excluded
+#if defined(ARGPARSE_COUNT_ALLOCATIONS)
+
+namespace {
+
+/// Parses once to warm up, then returns the allocations of parsing again
+uint64_t steady_state_parse(Parser &p, const int argc, const char **argv) {
+    p.parse(argc, argv);
+    return allocations::count([&] { p.parse(argc, argv); }).allocations;
+}
+
+} // namespace
+
+/// Tests the allocations of parsing the schemas of the parsing tests
+TEST_CASE("ParseAllocations", "Allocations") {
+    Parser p;
+    replace_exit_cb(p);
+
+    SECTION("Name and letter, --key=value") {
+        constexpr int argc = 4;
+        const char *argv[argc] = {
+            "path",
+            "--day=wednesday",
+            "-m=january",
+            "-d",
+        };
+
+        p.add(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "day", .help = ""});
+        p.add(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "", .help = "", .required = false, .letter = 'm'});
+
+        REQUIRE(steady_state_parse(p, argc, argv) == 0);
+    }
+
+    SECTION("Typed and allowed values") {
+        constexpr int argc = 7;
+        const char *argv[argc] = {
+            "path",
+            "--my_name",
+            "JP",
+            "--count",
+            "12",
+            "--id",
+            "9999",
+        };
+
+        p.add<std::string>("my_name", "my_help", 'a', true);
+        p.add(argparse::Config<uint32_t>{.default_value = 5, .allowed_values = {}, .name = "count"});
+        p.add(argparse::Config<int64_t>{.default_value = {}, .allowed_values = {1234, 9999}, .name = "id"});
+
+        REQUIRE(steady_state_parse(p, argc, argv) == 0);
+    }
+
+    SECTION("Multivalent") {
+        constexpr int argc = 6;
+        const char *argv[argc] = {
+            "path",
+            "--mode",
+            "walk,jog,skip,fly",
+            "swim",
+            "dive",
+            "wade",
+        };
+
+        p.add_multivalent(argparse::Config<std::string>{
+            .default_value = {},
+            .allowed_values = {"walk", "jog", "skip", "fly", "wade", "swim", "dive"},
+            .name = "mode",
+            .help = "",
+            .required = true,
+        });
+
+        REQUIRE(steady_state_parse(p, argc, argv) == 0);
+    }
+
+    SECTION("Multivalent numbers and booleans") {
+        constexpr int argc = 5;
+        const char *argv[argc] = {
+            "path",
+            "--numbers",
+            "1,2,3",
+            "--flags",
+            "true,false,true,true",
+        };
+
+        const auto numbers = p.add_multivalent(argparse::Config<int32_t>{.default_value = {}, .allowed_values = {}, .name = "numbers"});
+        const auto flags = p.add_multivalent(argparse::Config<bool>{.default_value = false, .allowed_values = {}, .name = "flags"});
+
+        REQUIRE(steady_state_parse(p, argc, argv) == 0);
+        REQUIRE(numbers->value() == std::vector<int32_t>{1, 2, 3});
+        REQUIRE(flags->value() == std::vector<bool>{true, false, true, true});
+
+        // Fewer values, then none, reuse the same storage
+        const char *fewer[] = {"path", "--numbers", "4"};
+        REQUIRE(steady_state_parse(p, 3, fewer) == 0);
+        REQUIRE(numbers->value() == std::vector<int32_t>{4});
+        REQUIRE(flags->value() == std::vector<bool>{false});
+
+        const char *none[] = {"path"};
+        REQUIRE(allocations::count([&] { p.parse(1, none); }).allocations == 0);
+        REQUIRE(!numbers->has_value());
+        REQUIRE(allocations::count([&] { p.parse(argc, argv); }).allocations == 0);
+        REQUIRE(numbers->value() == std::vector<int32_t>{1, 2, 3});
+    }
+
+    SECTION("Fixed arity") {
+        constexpr int argc = 7;
+        const char *argv[argc] = {
+            "path",
+            "--bbox",
+            "0,0",
+            "640",
+            "480",
+            "--window",
+            "1s,5s,10",
+        };
+
+        const auto bbox = p.add_array<double, 4>(argparse::Config<double>{.default_value = {}, .allowed_values = {}, .name = "bbox"});
+        const auto window = p.add_tuple<Duration, Duration, uint32_t>(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "window"});
+
+        REQUIRE(steady_state_parse(p, argc, argv) == 0);
+        REQUIRE(bbox->value() == std::array<double, 4>{0, 0, 640, 480});
+        REQUIRE(std::get<2>(window->value()) == 10);
+    }
+}
+
+/// Tests that validating allocates nothing once the buffers have grown, even for values that parsing keeps
+TEST_CASE("ValidateAllocations", "Allocations") {
+    Parser p;
+    p.add(argparse::Config<int64_t>{.default_value = {}, .allowed_values = {1234, 9999}, .name = "id"});
+    p.add_multivalent(argparse::Config<std::string>{
+        .default_value = {},
+        .allowed_values = {"walk", "jog", "skip", "fly", "wade", "swim", "dive"},
+        .name = "mode",
+        .help = "",
+        .required = true,
+    });
+
+    constexpr int argc = 7;
+    const char *argv[argc] = {"path", "--id", "9999", "--mode", "walk,jog,skip,fly", "swim", "dive"};
+
+    REQUIRE(p.validate(argc, argv));
+    REQUIRE(allocations::count([&] { p.validate(argc, argv); }).allocations == 0);
+}
+
+/// Tests the allocations of registering options
+TEST_CASE("AddAllocations", "Allocations") {
+    Parser p;
+
+    const auto counts = allocations::count([&p] {
+        p.add(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "day", .help = ""});
+    });
+    REQUIRE(counts.allocations <= 4);
+
+    const auto multivalent_counts = allocations::count([&p] {
+        p.add_multivalent(argparse::Config<int32_t>{.default_value = {}, .allowed_values = {1, 2, 3}, .name = "numbers"});
+    });
+    REQUIRE(multivalent_counts.allocations <= 12);
+}
+
+/// Tests the allocations of rendering the help message
+TEST_CASE("HelpAllocations", "Allocations") {
+    Parser p("Sample Program", "Testing...");
+    p.add(argparse::Config<std::string>{.default_value = "a", .allowed_values = {"a", "b"}, .name = "mode", .help = "Mode"});
+
+    std::stringstream ss;
+    auto *const original = std::cout.rdbuf(ss.rdbuf());
+    p.help();
+    const auto counts = allocations::count([&p] { p.help(); });
+    std::cout.rdbuf(original);
+
+    REQUIRE(counts.allocations <= 24);
+}
+
+#endif
@@ -0,0 +1,110 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "perfect_hash.h"
+#include "utilities.h"
+
+#include <sstream>
+using namespace argparse;
+
+namespace {
+
+enum class Mode { kWalk, kRun, kJog, kSkip };
+
+} // namespace
+
+/// Tests that every key of a perfect hash is found, and nothing else is
+TEST_CASE("PerfectHash", "Parsing") {
+    SECTION("Empty") {
+        const detail::PerfectHash hash(std::vector<std::string>{});
+        REQUIRE(hash.find("anything") == detail::PerfectHash::kNoKey);
+        REQUIRE(hash.find("") == detail::PerfectHash::kNoKey);
+    }
+
+    SECTION("Keys") {
+        for (const std::size_t count : {1, 2, 3, 7, 64, 1000}) {
+            std::vector<std::string> keys;
+            for (std::size_t ii = 0; ii < count; ii++) {
+                keys.push_back("key" + std::to_string(ii));
+            }
+
+            const detail::PerfectHash hash(keys);
+            REQUIRE(hash.size() == count);
+            for (std::size_t ii = 0; ii < count; ii++) {
+                REQUIRE(hash.find(keys[ii]) == ii);
+                REQUIRE(hash.find("other" + std::to_string(ii)) == detail::PerfectHash::kNoKey);
+            }
+            REQUIRE(hash.find("key") == detail::PerfectHash::kNoKey);
+            REQUIRE(hash.find("") == detail::PerfectHash::kNoKey);
+        }
+    }
+
+    SECTION("Repeated") {
+        REQUIRE_THROWS_AS(detail::PerfectHash({"a", "b", "a"}), InvalidConfig);
+    }
+}
+
+/// Tests options whose values are chosen by spelling
+TEST_CASE("Choices", "Parsing") {
+    Parser p;
+    replace_exit_cb(p);
+
+    const std::vector<std::pair<std::string, Mode>> choices{
+        {"walk", Mode::kWalk}, {"run", Mode::kRun}, {"jog", Mode::kJog}, {"skip", Mode::kSkip},
+    };
+    const auto mode = p.add_choice(argparse::Config<Mode>{.default_value = Mode::kJog, .allowed_values = {}, .name = "mode"}, choices);
+    const auto other = p.add_choice(argparse::Config<Mode>{.default_value = {}, .allowed_values = {}, .name = "", .help = "", .required = false, .letter = 'o'}, choices);
+
+    SECTION("Spelling") {
+        const char *argv[] = {"path", "--mode", "run", "-o", "skip"};
+        p.parse(5, argv);
+
+        REQUIRE(mode->value() == Mode::kRun);
+        REQUIRE(other->value() == Mode::kSkip);
+    }
+
+    SECTION("Default") {
+        const char *argv[] = {"path"};
+        p.parse(1, argv);
+
+        REQUIRE(mode->value() == Mode::kJog);
+        REQUIRE(!other->has_value());
+    }
+
+    SECTION("Not a choice") {
+        bool called = false;
+        Parser::Callbacks cbs;
+        cbs.not_allowed = [&called](auto, auto) { called = true; };
+        p.set_callbacks(std::move(cbs));
+
+        const char *argv[] = {"path", "--mode", "sprint"};
+        REQUIRE(!p.validate(3, argv));
+        p.parse(3, argv);
+        REQUIRE(called);
+    }
+
+    SECTION("Help") {
+        std::stringstream ss;
+        auto *const old = std::cout.rdbuf(ss.rdbuf());
+        p.help();
+        std::cout.rdbuf(old);
+
+        const auto help = ss.str();
+        REQUIRE(help.find("choice") != std::string::npos);
+        for (const auto &choice : choices) {
+            REQUIRE(help.find(choice.first) != std::string::npos);
+        }
+    }
+
+    SECTION("Invalid configurations") {
+        REQUIRE_THROWS_AS(p.add_choice(argparse::Config<Mode>{.default_value = {}, .allowed_values = {}, .name = "twice"},
+                                       {{"walk", Mode::kWalk}, {"walk", Mode::kRun}}),
+                          InvalidConfig);
+        REQUIRE_THROWS_AS(p.add_choice(argparse::Config<Mode>{.default_value = Mode::kSkip, .allowed_values = {}, .name = "missing"},
+                                       {{"walk", Mode::kWalk}}),
+                          InvalidConfig);
+        REQUIRE_THROWS_AS(p.add_choice(argparse::Config<Mode>{.default_value = {}, .allowed_values = {Mode::kWalk}, .name = "allowed"},
+                                       {{"walk", Mode::kWalk}}),
+                          InvalidConfig);
+    }
+}
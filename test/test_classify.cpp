@@ -0,0 +1,101 @@
+#include "catch.hpp"
+
+#include "classify.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using argparse::detail::Classifier;
+using argparse::detail::Token;
+
+namespace {
+
+/// Lays out arguments back to back, the same as the kernel does for argv
+struct Block {
+    std::vector<char> buffer;
+    std::vector<const char *> argv;
+
+    Block(const std::vector<std::string> &args, const std::size_t offset) : buffer(offset) {
+        std::vector<std::size_t> starts;
+        for (const auto &arg : args) {
+            starts.push_back(buffer.size());
+            buffer.insert(buffer.end(), arg.begin(), arg.end());
+            buffer.push_back('\0');
+        }
+        for (const auto start : starts) {
+            argv.push_back(buffer.data() + start);
+        }
+    }
+};
+
+} // namespace
+
+/// Tests classifying arguments, whether or not they are laid out back to back
+TEST_CASE("Classify", "Classify") {
+    const std::vector<std::string> args = {
+        "path", "--name=value", "-n", "-5", "--", "-", "--x=a=b", "", "text", "-.5",
+    };
+
+    auto check = [&args](const std::vector<Token> &tokens) {
+        REQUIRE(tokens.size() == args.size());
+        for (std::size_t ii = 0; ii < args.size(); ii++) {
+            REQUIRE(tokens[ii].size == args[ii].size());
+            REQUIRE(std::string(tokens[ii].data, tokens[ii].size) == args[ii]);
+        }
+
+        REQUIRE(tokens[0].flags == 0);
+        REQUIRE(tokens[1].flags == (Token::kOption | Token::kLongPrefix));
+        REQUIRE(tokens[1].equals == 6);
+        REQUIRE(tokens[1].prefix() == 2);
+        REQUIRE(tokens[2].flags == Token::kOption);
+        REQUIRE(tokens[2].equals == tokens[2].size);
+        REQUIRE(tokens[2].prefix() == 1);
+        REQUIRE(tokens[3].flags == Token::kNegativeNumber);
+        REQUIRE(tokens[4].flags == Token::kSplitter);
+        REQUIRE(tokens[5].flags == Token::kOption);
+        REQUIRE(tokens[6].equals == 3);
+        REQUIRE(tokens[7].flags == 0);
+        REQUIRE(tokens[7].equals == 0);
+        REQUIRE(tokens[8].equals == tokens[8].size);
+        REQUIRE(tokens[9].flags == Token::kOption);
+    };
+
+    Classifier classifier;
+
+    SECTION("Contiguous arguments are swept as one block") {
+        // Every alignment of the block against the vector chunks
+        for (std::size_t offset = 0; offset < 16; offset++) {
+            Block block(args, offset);
+            check(classifier.classify(static_cast<int>(block.argv.size()), block.argv.data()));
+#if defined(__SSE2__) || (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+            REQUIRE(classifier.swept());
+#endif
+        }
+    }
+
+    SECTION("Separate arguments are scanned one at a time") {
+        // Break the layout half way through, so the sweep has to give up part way
+        const std::string moved = args[5];
+        Block block(args, 0);
+        block.argv[5] = moved.c_str();
+
+        check(classifier.classify(static_cast<int>(block.argv.size()), block.argv.data()));
+        REQUIRE(!classifier.swept());
+    }
+
+    SECTION("Long arguments span many chunks") {
+        const std::vector<std::string> long_args = {std::string(100, 'a'), "--" + std::string(50, 'b') + "=" + std::string(70, 'c')};
+        Block block(long_args, 3);
+
+        const auto &tokens = classifier.classify(static_cast<int>(block.argv.size()), block.argv.data());
+        REQUIRE(tokens.size() == 2);
+        REQUIRE(tokens[0].size == 100);
+        REQUIRE(tokens[1].size == 123);
+        REQUIRE(tokens[1].equals == 52);
+    }
+
+    SECTION("No arguments") {
+        REQUIRE(classifier.classify(0, nullptr).empty());
+    }
+}
@@ -0,0 +1,90 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "utilities.h"
+using namespace argparse;
+
+#include <string>
+#include <vector>
+
+/// Tests clusters of letters, such as -xvf
+TEST_CASE("Clusters", "Parsing") {
+    Parser p;
+    replace_exit_cb(p);
+
+    auto extract = p.add(Config<bool>{.default_value = false, .allowed_values = {}, .name = "extract", .help = "", .required = false, .letter = 'x'});
+    auto verbose = p.add(Config<bool>{.default_value = false, .allowed_values = {}, .name = "verbose", .help = "", .required = false, .letter = 'v'});
+    auto file = p.add(Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "file", .help = "", .required = false, .letter = 'f'});
+    auto level = p.add(Config<int32_t>{.default_value = 0, .allowed_values = {}, .name = "level", .help = "", .required = false, .letter = 'l'});
+    auto names = p.add_multivalent(Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "names", .help = "", .required = false, .letter = 'n'});
+
+    SECTION("Boolean flags") {
+        const char *argv[] = {"path", "-xv"};
+        p.parse(2, argv);
+        REQUIRE(extract->value());
+        REQUIRE(verbose->value());
+        REQUIRE(!file->has_value());
+    }
+
+    SECTION("The last letter takes the following value") {
+        const char *argv[] = {"path", "-xvf", "archive.tar"};
+        p.parse(3, argv);
+        REQUIRE(extract->value());
+        REQUIRE(verbose->value());
+        REQUIRE(file->value() == "archive.tar");
+    }
+
+    SECTION("The rest of the letters, or after '=', are the value") {
+        const char *attached[] = {"path", "-vfarchive.tar"};
+        p.parse(2, attached);
+        REQUIRE(verbose->value());
+        REQUIRE(file->value() == "archive.tar");
+
+        const char *equals[] = {"path", "-vl=3"};
+        p.parse(2, equals);
+        REQUIRE(level->value() == 3);
+    }
+
+    SECTION("Multivalent last letter") {
+        const char *argv[] = {"path", "-xn", "a,b", "c"};
+        p.parse(4, argv);
+        REQUIRE(names->value() == std::vector<std::string>{"a", "b", "c"});
+    }
+
+    SECTION("A letter that is not registered makes the whole cluster unknown") {
+        const char *argv[] = {"path", "-xq", "--level", "1"};
+        p.parse(4, argv);
+        REQUIRE(!extract->value());
+        REQUIRE(level->value() == 1);
+    }
+
+    SECTION("Validate agrees") {
+        const char *valid[] = {"path", "-xvf", "archive.tar", "-l5"};
+        REQUIRE(p.validate(4, valid));
+
+        const char *invalid[] = {"path", "-xvlabc"};
+        REQUIRE(!p.validate(2, invalid));
+    }
+}
+
+/// Tests that names take precedence over clusters
+TEST_CASE("ClusterNames", "Parsing") {
+    Parser p;
+    replace_exit_cb(p);
+
+    auto all = p.add(Config<bool>{.default_value = false, .allowed_values = {}, .name = "ab", .help = ""});
+    auto a = p.add(Config<bool>{.default_value = false, .allowed_values = {}, .name = "", .help = "", .required = false, .letter = 'a'});
+    auto b = p.add(Config<bool>{.default_value = false, .allowed_values = {}, .name = "", .help = "", .required = false, .letter = 'b'});
+
+    const char *argv[] = {"path", "-ab"};
+    p.parse(2, argv);
+    REQUIRE(all->value());
+    REQUIRE(!a->value());
+    REQUIRE(!b->value());
+
+    const char *cluster[] = {"path", "-ba"};
+    p.parse(2, cluster);
+    REQUIRE(!all->value());
+    REQUIRE(a->value());
+    REQUIRE(b->value());
+}
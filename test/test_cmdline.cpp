@@ -0,0 +1,132 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "cmdline.h"
+#include "utilities.h"
+using namespace argparse;
+
+#include <unistd.h>
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Joins arguments the same way as /proc/<pid>/cmdline, each followed by a NUL
+std::string cmdline(const std::vector<std::string> &args) {
+    std::string out;
+    for (const auto &arg : args) {
+        out += arg;
+        out += '\0';
+    }
+    return out;
+}
+
+} // namespace
+
+/// Tests parsing a NUL separated command line in place
+TEST_CASE("Cmdline", "Cmdline") {
+    Parser p;
+    replace_exit_cb(p);
+
+    auto number = p.add(argparse::Config<int32_t>{.default_value = 7, .allowed_values = {}, .name = "number"});
+    auto words = p.add_multivalent(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "words"});
+
+    SECTION("Options, values and remaining arguments") {
+        const auto buffer = cmdline({"path", "--number=3", "--words", "a,b", "c", "--", "rest"});
+        const auto &remaining = p.parse(buffer.data(), buffer.size());
+
+        REQUIRE(number->value() == 3);
+        REQUIRE(words->value() == std::vector<std::string>{"a", "b", "c"});
+        REQUIRE(remaining == std::vector<std::string>{"rest"});
+    }
+
+    SECTION("The last argument may be missing its terminator") {
+        auto buffer = cmdline({"path", "--number", "42"});
+        buffer.pop_back();
+        p.parse(buffer.data(), buffer.size());
+
+        REQUIRE(number->value() == 42);
+    }
+
+    SECTION("Every parse starts from the defaults") {
+        const auto first = cmdline({"path", "--number", "1", "--words", "x"});
+        p.parse(first.data(), first.size());
+        REQUIRE(number->value() == 1);
+        REQUIRE(words->has_value());
+
+        const auto second = cmdline({"path"});
+        p.parse(second.data(), second.size());
+        REQUIRE(number->value() == 7);
+        REQUIRE(!words->has_value());
+    }
+
+    SECTION("Empty command line") {
+        REQUIRE(p.parse(nullptr, 0).empty());
+        REQUIRE(number->value() == 7);
+    }
+}
+
+/// Tests reading and parsing the command lines of processes in bulk
+TEST_CASE("CmdlineScanner", "Cmdline") {
+    // This process never passes this option, so it always parses to the default
+    CmdlineScanner<int32_t> scanner([](Parser &parser) {
+        auto value = parser.add(argparse::Config<int32_t>{.default_value = 5, .allowed_values = {}, .name = "not-passed-to-tests"});
+        return [value] { return value->value(); };
+    }, 4);
+
+    // The worker parsers do not print completions, the exit callback still ends the parse
+    CmdlineScanner<bool> silent([](Parser &parser) {
+        parser.set_completion(true);
+        std::ostringstream out;
+        auto *const buffer = std::cout.rdbuf(out.rdbuf());
+        const char *argv[] = {"path", "--_complete", "1", "path", "--h"};
+        bool exited = false;
+        try {
+            parser.parse(5, argv);
+        } catch (const std::runtime_error &) {
+            exited = true;
+        }
+        std::cout.rdbuf(buffer);
+        REQUIRE(exited);
+        REQUIRE(out.str().empty());
+        return [] { return true; };
+    }, 1);
+
+    std::vector<pid_t> pids(100, getpid());
+    pids[10] = 0; // There is never a process 0 in /proc
+
+    const auto results = scanner.scan(pids);
+    REQUIRE(results.size() == pids.size());
+    for (std::size_t ii = 0; ii < results.size(); ii++) {
+        REQUIRE(results[ii].pid == pids[ii]);
+        if (ii == 10) {
+            REQUIRE(results[ii].error != 0);
+            REQUIRE(!results[ii].parsed);
+        } else {
+            REQUIRE(results[ii].error == 0);
+            REQUIRE(results[ii].parsed);
+            REQUIRE(results[ii].value == 5);
+        }
+    }
+
+    // A process that fails to parse prints nothing, neither the help message nor the diagnostics
+    CmdlineScanner<bool> failing([](Parser &parser) {
+        parser.set_reject_unknown(true);
+        parser.add(argparse::Config<int32_t>{.default_value = {}, .allowed_values = {}, .name = "not-passed-to-tests", .help = "", .required = true});
+        return [] { return true; };
+    }, 4);
+
+    std::ostringstream out;
+    auto *const buffer = std::cout.rdbuf(out.rdbuf());
+    const auto failures = failing.scan(std::vector<pid_t>(3, getpid()));
+    std::cout.rdbuf(buffer);
+    for (const auto &result : failures) {
+        REQUIRE(result.error == 0);
+        REQUIRE(!result.parsed);
+    }
+    REQUIRE(out.str().empty());
+}
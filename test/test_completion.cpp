@@ -0,0 +1,128 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "completion.h"
+#include "utilities.h"
+using namespace argparse;
+
+namespace {
+
+using Words = std::vector<std::string>;
+
+} // namespace
+
+/// Tests looking up words by prefix
+TEST_CASE("SortedWords", "Completion") {
+    const detail::SortedWords words({"stop", "start", "status", "run", "start"});
+    REQUIRE(words.size() == 4);
+
+    Words out;
+    words.complete("st", "", out);
+    REQUIRE(out == Words{"start", "status", "stop"});
+
+    out.clear();
+    words.complete("sta", "--mode=", out);
+    REQUIRE(out == Words{"--mode=start", "--mode=status"});
+
+    out.clear();
+    words.complete("x", "", out);
+    REQUIRE(out.empty());
+
+    out.clear();
+    words.complete("", "", out);
+    REQUIRE(out.size() == 4);
+}
+
+/// Tests that the radix sort orders words the same as comparing them
+TEST_CASE("SortedWordsOrder", "Completion") {
+    Words words;
+    for (std::size_t ii = 0; ii < 3000; ii++) {
+        words.push_back("option" + std::to_string((ii * 7919) % 1000));
+        words.push_back(std::string(ii % 5, 'a') + std::string(1, static_cast<char>('a' + ii % 26)) + "\xff");
+    }
+    words.push_back("");
+
+    Words expected = words;
+    std::sort(expected.begin(), expected.end());
+    expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+
+    Words out;
+    detail::SortedWords(words).complete("", "", out);
+    REQUIRE(out == expected);
+}
+
+/// Tests completing the words of a command line
+TEST_CASE("Complete", "Completion") {
+    Parser p;
+    replace_exit_cb(p);
+    auto &subparsers = p.add_subparser("command", {"run", "remove", "stop"});
+    auto &run = subparsers["run"];
+    run.add(Config<std::string>{.default_value = {}, .allowed_values = {"fast", "slow", "safe"}, .name = "mode", .help = "", .required = false, .letter = 'm'});
+    run.add(Config<bool>{.default_value = false, .allowed_values = {}, .name = "verbose", .help = "", .required = false, .letter = 'v'});
+    run.add_multivalent(Config<std::string>{.default_value = {}, .allowed_values = {"a", "b"}, .name = "names"});
+    run.add_leading_positional(Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "target"});
+
+    SECTION("Subparsers") {
+        REQUIRE(p.complete({"path", "r"}, 1) == Words{"remove", "run"});
+        REQUIRE(p.complete({"path"}, 1) == Words{"remove", "run", "stop"});
+        REQUIRE(p.complete({"path", "x"}, 1).empty());
+    }
+
+    SECTION("Options") {
+        REQUIRE(p.complete({"path", "run", "--"}, 2) == Words{"--help", "--mode", "--names", "--verbose"});
+        REQUIRE(p.complete({"path", "run", "--m"}, 2) == Words{"--mode"});
+        REQUIRE(p.complete({"path", "run", "-"}, 2) == Words{"--help", "--mode", "--names", "--verbose", "-h", "-m", "-v"});
+        REQUIRE(p.complete({"path", "run", "--verbose"}, 3).size() == 7);
+        REQUIRE(p.complete({"path", "run", "target"}, 2).empty());
+        REQUIRE(p.complete({"path", "walk", "--"}, 2).empty());
+    }
+
+    SECTION("Values") {
+        REQUIRE(p.complete({"path", "run", "--mode", "s"}, 3) == Words{"safe", "slow"});
+        REQUIRE(p.complete({"path", "run", "-m"}, 3) == Words{"fast", "safe", "slow"});
+        REQUIRE(p.complete({"path", "run", "--mode=f"}, 2) == Words{"--mode=fast"});
+        REQUIRE(p.complete({"path", "run", "--names", "a,"}, 3) == Words{"a,a", "a,b"});
+    }
+
+    SECTION("Hidden argument") {
+        Words received;
+        bool exited = false;
+        Parser::Callbacks cbs;
+        cbs.complete = [&received](const Words &candidates) { received = candidates; };
+        cbs.exit = [&exited] { exited = true; };
+        p.set_callbacks(std::move(cbs));
+
+        // Only answered once enabled, otherwise it is parsed as any other argument
+        const char *argv[] = {"path", "--_complete", "2", "path", "run", "--v"};
+        p.parse(6, argv);
+        REQUIRE(received.empty());
+
+        exited = false;
+        p.set_completion(true);
+        REQUIRE(p.parse(6, argv).empty());
+        REQUIRE(received == Words{"--verbose"});
+        REQUIRE(exited);
+
+        // Never answered for a command line buffer
+        received.clear();
+        const char cmdline[] = "path\0--_complete\0" "2\0path\0run\0--v";
+        p.parse(cmdline, sizeof(cmdline));
+        REQUIRE(received.empty());
+    }
+}
+
+/// Tests that a large schema still completes from its indexes
+TEST_CASE("CompleteMany", "Completion") {
+    Parser p;
+    for (std::size_t ii = 0; ii < 5000; ii++) {
+        p.add(Config<uint32_t>{.default_value = {}, .allowed_values = {}, .name = "option" + std::to_string(ii)});
+    }
+
+    REQUIRE(p.complete({"path", "--option499"}, 1) == Words{"--option499", "--option4990", "--option4991", "--option4992",
+                                                            "--option4993", "--option4994", "--option4995", "--option4996",
+                                                            "--option4997", "--option4998", "--option4999"});
+
+    // Options registered after the first completion are indexed too
+    p.add(Config<uint32_t>{.default_value = {}, .allowed_values = {}, .name = "option4999x"});
+    REQUIRE(p.complete({"path", "--option4999"}, 1) == Words{"--option4999", "--option4999x"});
+}
@@ -0,0 +1,202 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "config_file.h"
+#include "utilities.h"
+using namespace argparse;
+
+#include <cstdio>
+#include <cstdlib>
+#include <system_error>
+
+#include <unistd.h>
+
+namespace {
+
+/// Writes [text] to a temporary file, removed when going out of scope
+struct TemporaryFile {
+    std::string path;
+
+    explicit TemporaryFile(const std::string &text) {
+        char name[] = "/tmp/argparse_XXXXXX";
+        const int fd = ::mkstemp(name);
+        REQUIRE(fd >= 0);
+        REQUIRE(::write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size()));
+        ::close(fd);
+        path = name;
+    }
+
+    ~TemporaryFile() {
+        std::remove(path.c_str());
+    }
+};
+
+} // namespace
+
+/// Tests splitting a config file into entries
+TEST_CASE("ConfigFile", "Parsing") {
+    SECTION("Entries") {
+        const std::string text =
+            "# comment\n"
+            "port = 8080\n"
+            "\n"
+            "  verbose  \n"
+            "name=\"  spaced  \"\n"
+            "; comment\n"
+            "[ run ]\n"
+            "threads =4\r\n"
+            "empty =";
+        const detail::ConfigFile file(text.data(), text.size());
+        const auto &entries = file.entries();
+
+        REQUIRE(entries.size() == 5);
+        REQUIRE(entries[0].section.size == 0);
+        REQUIRE(entries[0].name.str() == "port");
+        REQUIRE(entries[0].value.str() == "8080");
+        REQUIRE(entries[0].line == 2);
+        REQUIRE(entries[0].assigned);
+
+        REQUIRE(entries[1].name.str() == "verbose");
+        REQUIRE(entries[1].value.size == 0);
+        REQUIRE(!entries[1].assigned);
+
+        REQUIRE(entries[2].value.str() == "  spaced  ");
+
+        REQUIRE(entries[3].section.str() == "run");
+        REQUIRE(entries[3].name.str() == "threads");
+        REQUIRE(entries[3].value.str() == "4");
+        REQUIRE(entries[3].line == 8);
+
+        REQUIRE(entries[4].name.str() == "empty");
+        REQUIRE(entries[4].value.size == 0);
+        REQUIRE(entries[4].assigned);
+    }
+
+    SECTION("Malformed") {
+        const std::string section = "[run\n";
+        REQUIRE_THROWS_AS(detail::ConfigFile(section.data(), section.size()), std::invalid_argument);
+
+        const std::string name = "port = 1\n = 2\n";
+        REQUIRE_THROWS_AS(detail::ConfigFile(name.data(), name.size()), std::invalid_argument);
+    }
+
+    SECTION("Files") {
+        const TemporaryFile file("port = 8080\n");
+        REQUIRE(detail::ConfigFile(file.path).entries().size() == 1);
+
+        const TemporaryFile empty("");
+        REQUIRE(detail::ConfigFile(empty.path).entries().empty());
+
+        REQUIRE_THROWS_AS(detail::ConfigFile("/nonexistent/argparse.conf"), std::system_error);
+    }
+}
+
+/// Tests options that take their value from a config file when not given
+TEST_CASE("ConfigFileOptions", "Parsing") {
+    Parser p;
+    replace_exit_cb(p);
+    const char *environment[] = {"PORT=9090", nullptr};
+    p.set_environment(environment);
+
+    const auto port = p.add(argparse::Config<uint32_t>{.default_value = 80, .allowed_values = {}, .name = "port", .help = "", .required = false, .letter = kUnusedChar, .env = "PORT"});
+    const auto threads = p.add(argparse::Config<uint32_t>{.default_value = 1, .allowed_values = {}, .name = "threads", .help = "", .required = true});
+    const auto verbose = p.add(argparse::Config<bool>{.default_value = false, .allowed_values = {}, .name = "verbose"});
+    const auto names = p.add_multivalent(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "names"});
+    const auto mode = p.add_lazy(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "mode"});
+
+    const TemporaryFile file(
+        "port = 1234\n"
+        "threads = 8\n"
+        "verbose\n"
+        "names = a,b\n"
+        "mode = fast\n"
+        "unknown = ignored\n"
+        "threads = 16\n"
+        "[run]\n"
+        "threads = 4\n"
+    );
+    p.set_config_file(file.path);
+
+    SECTION("Fallback") {
+        const char *argv[] = {"path"};
+        REQUIRE(p.validate(1, argv));
+        p.parse(1, argv);
+
+        // The environment variable takes precedence over the file, and the last of repeated keys wins
+        REQUIRE(port->value() == 9090);
+        REQUIRE(threads->value() == 16);
+        REQUIRE(verbose->value() == true);
+        REQUIRE(names->value() == std::vector<std::string>{"a", "b"});
+        REQUIRE((*mode)->value() == "fast");
+    }
+
+    SECTION("Arguments first") {
+        const char *argv[] = {"path", "--threads", "2", "--names", "c"};
+        p.parse(5, argv);
+
+        REQUIRE(threads->value() == 2);
+        REQUIRE(names->value() == std::vector<std::string>{"c"});
+        REQUIRE(port->value() == 9090);
+    }
+
+    SECTION("Subparsers") {
+        Parser q;
+        replace_exit_cb(q);
+        auto &subparsers = q.add_subparser("command", {"run", "stop"});
+        const auto run = subparsers["run"].add(argparse::Config<uint32_t>{.default_value = 1, .allowed_values = {}, .name = "threads"});
+        const auto stop = subparsers["stop"].add(argparse::Config<uint32_t>{.default_value = 1, .allowed_values = {}, .name = "threads"});
+        q.set_config_file(file.path);
+
+        // Each subparser reads the section of its name
+        const char *argv[] = {"path", "run"};
+        q.parse(2, argv);
+        REQUIRE(run->value() == 4);
+
+        const char *other[] = {"path", "stop"};
+        q.parse(2, other);
+        REQUIRE(stop->value() == 1);
+    }
+
+    SECTION("Invalid") {
+        const TemporaryFile invalid("threads = many\n");
+        p.set_config_file(invalid.path);
+
+        const char *argv[] = {"path"};
+        REQUIRE(!p.validate(1, argv));
+        REQUIRE_THROWS_AS(p.parse(1, argv), std::invalid_argument);
+    }
+
+    SECTION("Missing value") {
+        const TemporaryFile missing("threads\n");
+        p.set_config_file(missing.path);
+
+        bool missed = false;
+        Parser::Callbacks cbs;
+        cbs.missing = [&missed](const std::string &) { missed = true; };
+        p.set_callbacks(std::move(cbs));
+
+        const char *argv[] = {"path"};
+        REQUIRE(!p.validate(1, argv));
+        p.parse(1, argv);
+        REQUIRE(missed);
+    }
+
+    SECTION("The file changes after it is read") {
+        // Writing or truncating the file in place changes nothing, the parser keeps what it read
+        FILE *rewrite = std::fopen(file.path.c_str(), "r+");
+        REQUIRE(rewrite != nullptr);
+        std::fputs("port = 4321\nthreads = 2\n", rewrite);
+        std::fclose(rewrite);
+        REQUIRE(::truncate(file.path.c_str(), 4) == 0);
+
+        const char *argv[] = {"path"};
+        p.parse(1, argv);
+        REQUIRE(threads->value() == 16);
+        REQUIRE(names->value() == std::vector<std::string>{"a", "b"});
+        REQUIRE((*mode)->value() == "fast");
+    }
+
+    SECTION("Unreadable") {
+        REQUIRE_THROWS_AS(p.set_config_file("/nonexistent/argparse.conf"), std::system_error);
+    }
+}
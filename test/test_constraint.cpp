@@ -0,0 +1,117 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "utilities.h"
+using namespace argparse;
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Tests constraints between options
+TEST_CASE("Constraints", "Constraint") {
+    Parser p;
+
+    bool exited = false;
+    std::vector<std::pair<Constraint, std::vector<std::string>>> violated;
+    Parser::Callbacks cbs;
+    cbs.exit = [&exited] { exited = true; };
+    cbs.constraint = [&violated](const Constraint constraint, const std::vector<std::string> &names) { violated.push_back({constraint, names}); };
+    p.set_callbacks(std::move(cbs));
+
+    p.add(argparse::Config<bool>{.default_value = false, .allowed_values = {}, .name = "json"});
+    p.add(argparse::Config<bool>{.default_value = false, .allowed_values = {}, .name = "yaml"});
+    p.add(argparse::Config<bool>{.default_value = false, .allowed_values = {}, .name = "xml"});
+    p.add(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "user"});
+    p.add(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "password"});
+    p.add(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "", .help = "", .required = false, .letter = 'k'});
+    p.add(argparse::Config<bool>{.default_value = false, .allowed_values = {}, .name = "dry-run"});
+    p.add(argparse::Config<bool>{.default_value = false, .allowed_values = {}, .name = "force"});
+
+    p.add_group(Constraint::kMutuallyExclusive, {"json", "yaml", "xml"});
+    p.add_group(Constraint::kAllOrNone, {"user", "password"});
+    p.add_group(Constraint::kAtLeastOne, {"user", "k"});
+    p.add_requires("force", {"user", "password"});
+    p.add_conflicts("dry-run", {"force", "xml"});
+
+    SECTION("Satisfied") {
+        const char *argv[] = {"path", "--json", "--user", "a", "--password", "b", "--force"};
+        p.parse(7, argv);
+        REQUIRE(violated.empty());
+        REQUIRE(!exited);
+
+        const char *key[] = {"path", "-k", "secret", "--dry-run"};
+        p.parse(4, key);
+        REQUIRE(violated.empty());
+        REQUIRE(!exited);
+    }
+
+    SECTION("Mutually exclusive reports the options given") {
+        const char *argv[] = {"path", "-k", "secret", "--json", "--xml"};
+        p.parse(5, argv);
+        REQUIRE(exited);
+        REQUIRE(violated.size() == 1);
+        REQUIRE(violated[0].first == Constraint::kMutuallyExclusive);
+        REQUIRE(violated[0].second == std::vector<std::string>{"json", "xml"});
+    }
+
+    SECTION("All or none reports the options missing") {
+        const char *argv[] = {"path", "--user", "a"};
+        p.parse(3, argv);
+        REQUIRE(exited);
+        REQUIRE(violated.size() == 1);
+        REQUIRE(violated[0].first == Constraint::kAllOrNone);
+        REQUIRE(violated[0].second == std::vector<std::string>{"password"});
+    }
+
+    SECTION("At least one reports every option of the group") {
+        const char *argv[] = {"path"};
+        p.parse(1, argv);
+        REQUIRE(exited);
+        REQUIRE(violated.size() == 1);
+        REQUIRE(violated[0].first == Constraint::kAtLeastOne);
+        REQUIRE(violated[0].second == std::vector<std::string>{"user", "k"});
+    }
+
+    SECTION("Requires and conflicts report the subject first") {
+        const char *argv[] = {"path", "-k", "secret", "--force", "--dry-run"};
+        p.parse(5, argv);
+        REQUIRE(exited);
+        REQUIRE(violated.size() == 2);
+        REQUIRE(violated[0].first == Constraint::kRequires);
+        REQUIRE(violated[0].second == std::vector<std::string>{"force", "user", "password"});
+        REQUIRE(violated[1].first == Constraint::kConflicts);
+        REQUIRE(violated[1].second == std::vector<std::string>{"dry-run", "force"});
+    }
+
+    SECTION("Options without a value are not given") {
+        const char *argv[] = {"path", "-k", "secret", "--user", "--password", "b"};
+        p.parse(6, argv);
+        REQUIRE(violated.size() == 1);
+        REQUIRE(violated[0].second == std::vector<std::string>{"user"});
+    }
+
+    SECTION("Validate checks the same constraints") {
+        std::vector<std::string> names;
+        const char *argv[] = {"path", "-k", "secret", "--json", "--yaml"};
+        REQUIRE(!p.validate(5, argv, [&names](const Parser::Diagnostic &d) {
+            REQUIRE(d.error == Parser::Diagnostic::Error::kConstraint);
+            names.push_back(d.name);
+        }));
+        REQUIRE(names == std::vector<std::string>{"json"});
+        REQUIRE(violated.empty());
+    }
+}
+
+/// Tests that constraints are only added between registered options
+TEST_CASE("ConstraintConfig", "Constraint") {
+    Parser p;
+    p.add(argparse::Config<bool>{.default_value = false, .allowed_values = {}, .name = "alpha"});
+    p.add(argparse::Config<bool>{.default_value = false, .allowed_values = {}, .name = "beta"});
+
+    REQUIRE_THROWS_AS(p.add_group(Constraint::kMutuallyExclusive, {"alpha", "gamma"}), InvalidConfig);
+    REQUIRE_THROWS_AS(p.add_group(Constraint::kRequires, {"alpha", "beta"}), InvalidConfig);
+    REQUIRE_THROWS_AS(p.add_requires("gamma", {"alpha"}), InvalidConfig);
+    REQUIRE_THROWS_AS(p.add_conflicts("alpha", {"delta"}), InvalidConfig);
+    REQUIRE_NOTHROW(p.add_conflicts("alpha", {"beta"}));
+}
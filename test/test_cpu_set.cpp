@@ -0,0 +1,115 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "cpu_set.h"
+#include "utilities.h"
+using namespace argparse;
+
+#include <string>
+#include <vector>
+
+namespace {
+
+CpuSet parse_cpu_set(const std::string &s) { return detail::parse_cpu_set(s.data(), s.size()); }
+
+/// \return The numbers of the set, in increasing order
+std::vector<std::size_t> numbers(const CpuSet &cpus) {
+    std::vector<std::size_t> out;
+    cpus.for_each([&out](const std::size_t n) { out.push_back(n); });
+    return out;
+}
+
+} // namespace
+
+/// Tests parsing and formatting of lists of CPUs
+TEST_CASE("CpuSet", "Parsing") {
+    SECTION("Numbers and ranges") {
+        REQUIRE(parse_cpu_set("").empty());
+        REQUIRE(numbers(parse_cpu_set("3")) == std::vector<std::size_t>{3});
+        REQUIRE(numbers(parse_cpu_set("0,2,5-7")) == std::vector<std::size_t>{0, 2, 5, 6, 7});
+        REQUIRE(parse_cpu_set("0-3") == parse_cpu_set("3,2,1,0"));
+
+        // The words are the mask of cpu_set_t
+        const auto cpus = parse_cpu_set("0-15,32-47");
+        REQUIRE(cpus.words == std::vector<uint64_t>{0x0000FFFF0000FFFFULL});
+        REQUIRE(cpus.count() == 32);
+        REQUIRE(cpus.bytes() == 8);
+        REQUIRE(parse_cpu_set("0-127").words == std::vector<uint64_t>{~0ULL, ~0ULL});
+        REQUIRE(parse_cpu_set("63-64").words == std::vector<uint64_t>{1ULL << 63U, 1});
+        REQUIRE(parse_cpu_set("200").words.size() == 4);
+        REQUIRE(parse_cpu_set("200").test(200));
+        REQUIRE(!parse_cpu_set("200").test(199));
+        REQUIRE(!parse_cpu_set("200").test(1000));
+    }
+
+    SECTION("Strides") {
+        REQUIRE(parse_cpu_set("0-63:2").words == std::vector<uint64_t>{0x5555555555555555ULL});
+        REQUIRE(numbers(parse_cpu_set("1-10:4")) == std::vector<std::size_t>{1, 5, 9});
+        REQUIRE(numbers(parse_cpu_set("4-4:3")) == std::vector<std::size_t>{4});
+    }
+
+    SECTION("Exclusions") {
+        REQUIRE(numbers(parse_cpu_set("0-7,^3")) == std::vector<std::size_t>{0, 1, 2, 4, 5, 6, 7});
+        REQUIRE(parse_cpu_set("^3,0-7") == parse_cpu_set("0-7,^3"));
+        REQUIRE(parse_cpu_set("0-127,^64-127").words == std::vector<uint64_t>{~0ULL});
+        REQUIRE(numbers(parse_cpu_set("0-7,^0-7:2")) == std::vector<std::size_t>{1, 3, 5, 7});
+        REQUIRE(parse_cpu_set("0-3,^100").words == std::vector<uint64_t>{0xF});
+        REQUIRE(parse_cpu_set("^5").empty());
+    }
+
+    SECTION("Malformed") {
+        REQUIRE_THROWS_AS(parse_cpu_set(","), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_cpu_set("0,"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_cpu_set("0,,1"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_cpu_set("a"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_cpu_set("-1"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_cpu_set("3-"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_cpu_set("7-3"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_cpu_set("0-7:0"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_cpu_set("0 1"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_cpu_set("65536"), std::out_of_range);
+        REQUIRE_THROWS_AS(parse_cpu_set("0-99999999999999999999"), std::out_of_range);
+    }
+
+    SECTION("Format") {
+        REQUIRE(detail::format(CpuSet{}).empty());
+        REQUIRE(detail::format(parse_cpu_set("3,0-1")) == "0-1,3");
+        REQUIRE(detail::format(parse_cpu_set("0-15,32-47")) == "0-15,32-47");
+        REQUIRE(detail::format(parse_cpu_set("0-7:2")) == "0,2,4,6");
+        REQUIRE(detail::format(parse_cpu_set("60-70,^64")) == "60-63,65-70");
+    }
+}
+
+/// Tests options whose values are lists of CPUs
+TEST_CASE("CpuSetOptions", "Parsing") {
+    Parser p;
+    replace_exit_cb(p);
+
+    const auto cpus = p.add(Config<CpuSet>{.default_value = parse_cpu_set("0"), .allowed_values = {}, .name = "cpus"});
+    const auto nodes = p.add(Config<CpuSet>{.default_value = {}, .allowed_values = {}, .name = "numa-nodes", .help = "", .required = false, .letter = kUnusedChar, .env = "NODES"});
+
+    SECTION("Values") {
+        const char *argv[] = {"path", "--cpus", "0-15,32-47,^8", "--numa-nodes=0,2"};
+        p.parse(4, argv);
+        REQUIRE(cpus->value().count() == 31);
+        REQUIRE(!cpus->value().test(8));
+        REQUIRE(nodes->value().words == std::vector<uint64_t>{0x5});
+    }
+
+    SECTION("Defaults and the environment") {
+        const char *environment[] = {"NODES=1-3", nullptr};
+        p.set_environment(environment);
+
+        const char *argv[] = {"path"};
+        p.parse(1, argv);
+        REQUIRE(cpus->value() == parse_cpu_set("0"));
+        REQUIRE(nodes->value() == parse_cpu_set("1-3"));
+    }
+
+    SECTION("Validate") {
+        const char *argv[] = {"path", "--cpus", "0-3:"};
+        std::vector<Parser::Diagnostic::Error> errors;
+        REQUIRE(!p.validate(3, argv, [&errors](const Parser::Diagnostic &d) { errors.push_back(d.error); }));
+        REQUIRE(errors == std::vector<Parser::Diagnostic::Error>{Parser::Diagnostic::Error::kInvalid});
+    }
+}
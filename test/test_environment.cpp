@@ -0,0 +1,174 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "environment.h"
+#include "utilities.h"
+using namespace argparse;
+
+namespace {
+
+const char *kEnvironment[] = {
+    "HOME=/home/user",
+    "PORT=8080",
+    "VERBOSE=0",
+    "NAMES=a,b,c",
+    "PORT=9090",
+    "EMPTY=",
+    "MODE=fast",
+    nullptr,
+};
+
+} // namespace
+
+/// Tests the snapshot of environment variables
+TEST_CASE("Environment", "Parsing") {
+    const detail::Environment environment(kEnvironment);
+
+    SECTION("Find") {
+        REQUIRE(environment.size() == 6);
+        REQUIRE(environment.find("HOME")->str() == "/home/user");
+        REQUIRE(environment.find("EMPTY")->str().empty());
+        REQUIRE(!environment.find("MISSING").has_value());
+        REQUIRE(!environment.find("HOM").has_value());
+
+        // The first of repeated names is kept
+        REQUIRE(environment.find("PORT")->str() == "8080");
+    }
+
+    SECTION("Expand") {
+        std::string out;
+        auto expand = [&](const std::string &in) {
+            environment.expand(in.data(), in.size(), out);
+            return out;
+        };
+
+        REQUIRE(expand("plain") == "plain");
+        REQUIRE(expand("${HOME}/.config") == "/home/user/.config");
+        REQUIRE(expand("${HOME}:${PORT}") == "/home/user:8080");
+        REQUIRE(expand("[${MISSING}]") == "[]");
+        REQUIRE(expand("$HOME ${HOME") == "$HOME ${HOME");
+        REQUIRE(expand("cost $5") == "cost $5");
+        REQUIRE(expand("${}") == "");
+    }
+
+    SECTION("Process") {
+        REQUIRE(detail::Environment::process() == detail::Environment::process());
+    }
+}
+
+/// Tests options that take their value from an environment variable when not given
+TEST_CASE("EnvironmentOptions", "Parsing") {
+    Parser p;
+    replace_exit_cb(p);
+    p.set_environment(kEnvironment);
+
+    const auto port = p.add(argparse::Config<uint32_t>{.default_value = 80, .allowed_values = {}, .name = "port", .help = "", .required = true, .letter = kUnusedChar, .env = "PORT"});
+    const auto verbose = p.add(argparse::Config<bool>{.default_value = true, .allowed_values = {}, .name = "verbose", .help = "", .required = false, .letter = kUnusedChar, .env = "VERBOSE"});
+    const auto names = p.add_multivalent(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "names", .help = "", .required = false, .letter = kUnusedChar, .env = "NAMES"});
+    const auto user = p.add(argparse::Config<std::string>{.default_value = "nobody", .allowed_values = {}, .name = "user", .help = "", .required = false, .letter = kUnusedChar, .env = "USER_NAME"});
+    const auto mode = p.add_lazy(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "mode", .help = "", .required = false, .letter = kUnusedChar, .env = "MODE"});
+
+    SECTION("Fallback") {
+        const char *argv[] = {"path"};
+        REQUIRE(p.validate(1, argv));
+        p.parse(1, argv);
+
+        REQUIRE(port->value() == 8080);
+        REQUIRE(verbose->value() == false);
+        REQUIRE(names->value() == std::vector<std::string>{"a", "b", "c"});
+        REQUIRE(user->value() == "nobody");
+        REQUIRE((*mode)->value() == "fast");
+    }
+
+    SECTION("Arguments first") {
+        const char *argv[] = {"path", "--port", "1234", "--verbose", "--names", "d", "--mode", "slow"};
+        p.parse(8, argv);
+
+        REQUIRE(port->value() == 1234);
+        REQUIRE(verbose->value() == true);
+        REQUIRE(names->value() == std::vector<std::string>{"d"});
+        REQUIRE((*mode)->value() == "slow");
+    }
+
+    SECTION("Repeated parses") {
+        const char *given[] = {"path", "--port", "1234"};
+        p.parse(3, given);
+        REQUIRE(port->value() == 1234);
+
+        const char *absent[] = {"path"};
+        p.parse(1, absent);
+        REQUIRE(port->value() == 8080);
+    }
+
+    SECTION("Invalid") {
+        const char *environment[] = {"PORT=eighty", nullptr};
+        p.set_environment(environment);
+
+        const char *argv[] = {"path"};
+        REQUIRE(!p.validate(1, argv));
+        REQUIRE_THROWS_AS(p.parse(1, argv), std::invalid_argument);
+    }
+
+    SECTION("Missing") {
+        const char *environment[] = {nullptr};
+        p.set_environment(environment);
+
+        bool missing = false;
+        Parser::Callbacks cbs;
+        cbs.missing = [&missing](const std::string &) { missing = true; };
+        p.set_callbacks(std::move(cbs));
+
+        const char *argv[] = {"path"};
+        REQUIRE(!p.validate(1, argv));
+        p.parse(1, argv);
+        REQUIRE(missing);
+    }
+}
+
+/// Tests expanding environment variables in values
+TEST_CASE("EnvironmentExpand", "Parsing") {
+    Parser p;
+    replace_exit_cb(p);
+    p.set_environment(kEnvironment);
+
+    auto &subparsers = p.add_subparser("command", {"run"});
+    const auto config = subparsers["run"].add(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "config"});
+    const auto port = subparsers["run"].add(argparse::Config<uint32_t>{.default_value = {}, .allowed_values = {}, .name = "port", .help = "", .required = false, .letter = kUnusedChar, .env = "PORT"});
+
+    const char *argv[] = {"path", "run", "--config", "${HOME}/app.yaml"};
+
+    SECTION("Off") {
+        p.parse(4, argv);
+        REQUIRE(config->value() == "${HOME}/app.yaml");
+        REQUIRE(port->value() == 8080);
+    }
+
+    SECTION("On") {
+        p.set_expand(true);
+        p.parse(4, argv);
+        REQUIRE(config->value() == "/home/user/app.yaml");
+        REQUIRE(port->value() == 8080);
+    }
+
+    SECTION("Lazy options") {
+        const char *environment[] = {"HOME=/home/user", "PORT=8080", "WHO=${HOME}", nullptr};
+        p.set_environment(environment);
+        p.set_expand(true);
+        auto &run = subparsers["run"];
+        const auto greeting = run.add_lazy(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "greeting"});
+        const auto who = run.add_lazy(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "who", .help = "", .required = false, .letter = kUnusedChar, .env = "WHO"});
+        const auto ports = run.add_lazy_multivalent(argparse::Config<uint32_t>{.default_value = {}, .allowed_values = {}, .name = "ports"});
+
+        const char *lazy_argv[] = {"path", "run", "--greeting", "hi ${HOME}", "--ports", "${PORT},9090"};
+        p.parse(6, lazy_argv);
+        REQUIRE(greeting->get().value() == "hi /home/user");
+        REQUIRE(who->get().value() == "/home/user");
+        REQUIRE(ports->get().value() == std::vector<uint32_t>{8080, 9090});
+
+        // The expanded values are kept until the next parse
+        p.parse(4, argv);
+        REQUIRE(!greeting->get().has_value());
+        REQUIRE(who->get().value() == "/home/user");
+        REQUIRE(config->value() == "/home/user/app.yaml");
+    }
+}
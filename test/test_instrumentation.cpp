@@ -0,0 +1,92 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "utilities.h"
+using namespace argparse;
+
+/// Tests the per phase measurements reported after parsing
+TEST_CASE("Instrumentation", "Instrumentation") {
+    std::vector<Profile> profiles;
+
+    Parser p;
+    replace_exit_cb(p);
+
+    Parser::Callbacks cbs;
+    cbs.profile = [&profiles](const Profile &profile) { profiles.push_back(profile); };
+    p.set_callbacks(std::move(cbs));
+
+    p.add(argparse::Config<int32_t>{
+        .default_value = {},
+        .allowed_values = {1, 2, 3},
+        .name = "number",
+    });
+    p.add_multivalent(argparse::Config<std::string>{
+        .default_value = {},
+        .allowed_values = {},
+        .name = "words",
+    });
+
+    SECTION("Parse") {
+        constexpr int argc = 6;
+        const char *argv[argc] = {
+            "path",
+            "--number",
+            "2",
+            "--words",
+            "a",
+            "b",
+        };
+
+        p.parse(argc, argv);
+
+#if defined(ARGPARSE_INSTRUMENTATION)
+        REQUIRE(profiles.size() == 1);
+        const auto &profile = profiles[0];
+        REQUIRE(profile[Phase::kTokenize].count == 2); // Classifying, then parsing the tokens
+        REQUIRE(profile[Phase::kResolve].count == 1);
+        REQUIRE(profile[Phase::kConvert].count == 3);
+        REQUIRE(profile[Phase::kAllowedValues].count == 1);
+        REQUIRE(profile[Phase::kRequirements].count == 1);
+        REQUIRE(profile[Phase::kHelp].count == 0);
+        if (!profile.hardware_counters) {
+            REQUIRE(profile[Phase::kResolve].cycles == 0);
+        }
+#else
+        REQUIRE(profiles.empty());
+#endif
+    }
+
+    SECTION("Help") {
+        p.help();
+
+#if defined(ARGPARSE_INSTRUMENTATION)
+        REQUIRE(profiles.size() == 1);
+        REQUIRE(profiles[0][Phase::kHelp].count == 1);
+        REQUIRE(profiles[0][Phase::kTokenize].count == 0);
+#else
+        REQUIRE(profiles.empty());
+#endif
+    }
+
+    SECTION("Subparser reports once through the parent") {
+        auto &subparsers = p.add_subparser("mode", {"run"});
+        subparsers["run"].add(argparse::Config<int32_t>{.default_value = {}, .allowed_values = {}, .name = "count"});
+
+        constexpr int argc = 4;
+        const char *argv[argc] = {
+            "path",
+            "run",
+            "--count",
+            "5",
+        };
+
+        p.parse(argc, argv);
+
+#if defined(ARGPARSE_INSTRUMENTATION)
+        REQUIRE(profiles.size() == 1);
+        REQUIRE(profiles[0][Phase::kConvert].count == 1);
+#else
+        REQUIRE(profiles.empty());
+#endif
+    }
+}
@@ -0,0 +1,134 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "utilities.h"
+using namespace argparse;
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/// Tests options that are converted on first access
+TEST_CASE("Lazy", "Lazy") {
+    Parser p;
+    replace_exit_cb(p);
+
+    auto number = p.add_lazy(argparse::Config<int32_t>{
+        .default_value = 7,
+        .allowed_values = {1, 2, 3, 7},
+        .name = "number",
+    });
+    auto words = p.add_lazy_multivalent(argparse::Config<std::string>{
+        .default_value = {},
+        .allowed_values = {},
+        .name = "words",
+    });
+    auto flag = p.add_lazy(argparse::Config<bool>{.default_value = false, .allowed_values = {}, .name = "flag"});
+
+    SECTION("Values are converted on first access") {
+        std::string number_arg = "2";
+        const char *argv[] = {"path", "--number", number_arg.c_str(), "--words", "a,b", "c", "--flag"};
+        p.parse(7, argv);
+
+        REQUIRE((*number)->value() == 2);
+        REQUIRE((*words)->value() == std::vector<std::string>{"a", "b", "c"});
+        REQUIRE((*flag)->value());
+
+        // The converted value is kept, the input argument is not read again
+        number_arg[0] = '9';
+        REQUIRE(number->get().value() == 2);
+    }
+
+    SECTION("Defaults when not given") {
+        const char *argv[] = {"path"};
+        p.parse(1, argv);
+
+        REQUIRE((*number)->value() == 7);
+        REQUIRE(!(*words)->has_value());
+        REQUIRE(!(*flag)->value());
+    }
+
+    SECTION("Invalid values only fail when accessed") {
+        const char *argv[] = {"path", "--number", "5", "--words", "x"};
+        p.parse(5, argv);
+
+        REQUIRE((*words)->value() == std::vector<std::string>{"x"});
+        REQUIRE_THROWS_AS(number->get(), NotAllowed);
+        REQUIRE_THROWS_AS(number->get(), NotAllowed);
+
+        const char *unconvertible[] = {"path", "--number", "abc"};
+        p.parse(3, unconvertible);
+        REQUIRE_THROWS_AS(number->get(), std::invalid_argument);
+    }
+
+    SECTION("Every parse starts from the defaults") {
+        const char *first[] = {"path", "--number", "3"};
+        p.parse(3, first);
+
+        const char *second[] = {"path"};
+        p.parse(1, second);
+        REQUIRE((*number)->value() == 7);
+    }
+
+    SECTION("Structure is still checked while parsing") {
+        bool exited = false;
+        Parser::Callbacks cbs;
+        cbs.exit = [&exited] { exited = true; };
+        p.set_callbacks(std::move(cbs));
+
+        const char *argv[] = {"path", "--number", "1", "2"};
+        p.parse(4, argv);
+        REQUIRE(exited);
+    }
+
+    SECTION("Registering a name again detaches the replaced value") {
+        const char *argv[] = {"path", "--number", "2", "--words", "a,b"};
+        p.parse(5, argv);
+        REQUIRE((*words)->value() == std::vector<std::string>{"a", "b"});
+
+        // The replaced options are destroyed with values that are not converted yet, or already converted
+        const auto replaced = p.add_lazy(argparse::Config<int32_t>{.default_value = 1, .allowed_values = {}, .name = "number"});
+        const auto replaced_words = p.add_lazy_multivalent(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "words"});
+        REQUIRE((*number)->value() == 7);
+        REQUIRE((*words)->value() == std::vector<std::string>{"a", "b"});
+
+        p.parse(5, argv);
+        REQUIRE((*replaced)->value() == 2);
+        REQUIRE((*replaced_words)->value() == std::vector<std::string>{"a", "b"});
+        REQUIRE((*number)->value() == 7);
+    }
+}
+
+/// Tests converting required lazy options while parsing
+TEST_CASE("LazyStrict", "Lazy") {
+    Parser p;
+
+    std::vector<std::string> not_allowed;
+    Parser::Callbacks cbs;
+    cbs.exit = [] {};
+    cbs.not_allowed = [&not_allowed](const std::string &name, const std::vector<std::string> &) { not_allowed.push_back(name); };
+    p.set_callbacks(std::move(cbs));
+
+    auto required = p.add_lazy(argparse::Config<int32_t>{
+        .default_value = {},
+        .allowed_values = {1},
+        .name = "required",
+        .help = "",
+        .required = true,
+    });
+    auto optional = p.add_lazy(argparse::Config<int32_t>{.default_value = {}, .allowed_values = {1}, .name = "optional"});
+
+    const char *argv[] = {"path", "--required", "2", "--optional", "2"};
+
+    SECTION("Lazy by default") {
+        p.parse(5, argv);
+        REQUIRE(not_allowed.empty());
+    }
+
+    SECTION("Strict converts required options while parsing") {
+        p.set_strict(true);
+        p.parse(5, argv);
+        REQUIRE(not_allowed == std::vector<std::string>{"required"});
+        REQUIRE_THROWS_AS(optional->get(), NotAllowed);
+    }
+}
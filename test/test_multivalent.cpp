@@ -68,3 +68,30 @@ TEST_CASE("MultivalentOption", "Parsing") {
         test(mode, p);
     }
 }
+
+/// Tests that values of repeated parses replace each other, and lists of booleans
+TEST_CASE("MultivalentReuse", "Parsing") {
+    Parser p;
+    replace_exit_cb(p);
+    const auto names = p.add_multivalent(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "names"});
+    const auto flags = p.add_multivalent(argparse::Config<bool>{.default_value = true, .allowed_values = {}, .name = "flags"});
+
+    const char *many[] = {"path", "--names", "a long name that does not fit inline,b,c", "--flags", "false,true,0"};
+    p.parse(5, many);
+    REQUIRE(names->value() == std::vector<std::string>{"a long name that does not fit inline", "b", "c"});
+    REQUIRE(flags->value() == std::vector<bool>{false, true, false});
+
+    const char *fewer[] = {"path", "--names", "d"};
+    p.parse(3, fewer);
+    REQUIRE(names->value() == std::vector<std::string>{"d"});
+    REQUIRE(flags->value() == std::vector<bool>{true});
+
+    const char *none[] = {"path"};
+    REQUIRE(p.validate(1, none));
+    p.parse(1, none);
+    REQUIRE(!names->has_value());
+
+    REQUIRE(p.validate(5, many));
+    p.parse(5, many);
+    REQUIRE(names->value() == std::vector<std::string>{"a long name that does not fit inline", "b", "c"});
+}
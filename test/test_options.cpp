@@ -0,0 +1,79 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "options.h"
+
+#include <string>
+
+using namespace argparse;
+
+/// Tests the per option data kept next to each other by id
+TEST_CASE("OptionTable", "Options") {
+    Options options;
+
+    options.add(Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "name", .help = "", .required = true, .letter = 'n'});
+    options.add_multivalent(Config<int32_t>{.default_value = {}, .allowed_values = {}, .name = "numbers"});
+    options.add_lazy(Config<bool>{.default_value = {}, .allowed_values = {}, .name = "flag", .help = "", .required = false, .letter = 'f'});
+    options.add(Config<double>{.default_value = {}, .allowed_values = {}, .name = "ratio"}, 1);
+
+    SECTION("Configuration by id") {
+        REQUIRE(options.type(0) == Type::kString);
+        REQUIRE(options.required(0));
+        REQUIRE(!options.multivalent(0));
+        REQUIRE(options.letter(0) == 'n');
+
+        REQUIRE(options.type(1) == Type::kInt32);
+        REQUIRE(options.multivalent(1));
+        REQUIRE(!options.lazy(1));
+
+        REQUIRE(options.type(2) == Type::kBool);
+        REQUIRE(options.lazy(2));
+
+        REQUIRE(options.positional(3));
+        REQUIRE(!options.positional(2));
+    }
+
+    SECTION("Lookup by name and letter") {
+        REQUIRE(options.find("name") == 0);
+        REQUIRE(options.find("n") == 0);
+        REQUIRE(options.find("f") == 2);
+        REQUIRE(options.find("ratio") == 3);
+        REQUIRE(options.find("x") == kNoOption);
+        REQUIRE(options.find("names") == kNoOption);
+    }
+
+    SECTION("Registering a name again updates the table") {
+        options.add(Config<int64_t>{.default_value = {}, .allowed_values = {}, .name = "name"});
+        REQUIRE(options.size() == 4);
+        REQUIRE(options.type(0) == Type::kInt64);
+        REQUIRE(!options.required(0));
+        REQUIRE(options.find("n") == kNoOption);
+    }
+
+    SECTION("Reserving keeps every option") {
+        options.reserve(1000);
+        for (int ii = 0; ii < 1000; ii++) {
+            options.add(Config<int32_t>{.default_value = {}, .allowed_values = {}, .name = "option-" + std::to_string(ii)});
+        }
+        REQUIRE(options.size() == 1004);
+        REQUIRE(options.find("name") == 0);
+        REQUIRE(options.find("option-999") == 1003);
+    }
+}
+
+/// Tests that only the options set by previous parses are restored, including by parses of copies sharing the options
+TEST_CASE("OptionReset", "Options") {
+    Parser p;
+    auto number = p.add(Config<int32_t>{.default_value = 7, .allowed_values = {}, .name = "number"});
+    auto word = p.add(Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "word"});
+    Parser copy = p;
+
+    const char *set[] = {"path", "--number", "1", "--word", "a"};
+    copy.parse(5, set);
+    REQUIRE(number->value() == 1);
+
+    const char *none[] = {"path"};
+    p.parse(1, none);
+    REQUIRE(number->value() == 7);
+    REQUIRE(!word->has_value());
+}
@@ -0,0 +1,462 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "parse_cache.h"
+#include "snapshot.h"
+#include "units.h"
+#include "utilities.h"
+using namespace argparse;
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+enum class Mode { kRead, kWrite };
+
+/// Placeholders of a schema with one option of each kind
+struct Schema {
+    ConstPlaceHolder<std::string> input;
+    ConstPlaceHolder<uint32_t> port;
+    ConstPlaceHolder<bool> verbose;
+    ConstPlaceHolder<std::vector<int32_t>> values;
+    ConstPlaceHolder<Duration> timeout;
+    ConstPlaceHolder<Mode> mode;
+    LazyPlaceHolder<double> ratio;
+    ConstPlaceHolder<std::string> home;
+
+    explicit Schema(Parser &p) {
+        input = p.add_leading_positional(Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "input"});
+        port = p.add(Config<uint32_t>{.default_value = 80, .allowed_values = {}, .name = "port"});
+        verbose = p.add(Config<bool>{.default_value = false, .allowed_values = {}, .name = "verbose", .help = "", .required = false, .letter = 'v'});
+        values = p.add_multivalent(Config<int32_t>{.default_value = {}, .allowed_values = {}, .name = "values"});
+        timeout = p.add(Config<Duration>{.default_value = std::chrono::seconds(1), .allowed_values = {}, .name = "timeout"});
+        mode = p.add_choice(Config<Mode>{.default_value = Mode::kRead, .allowed_values = {}, .name = "mode"},
+                            {{"read", Mode::kRead}, {"write", Mode::kWrite}});
+        ratio = p.add_lazy(Config<double>{.default_value = 0.5, .allowed_values = {}, .name = "ratio"});
+        home = p.add(Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "home", .help = "", .required = false, .letter = kUnusedChar, .env = "HOME"});
+    }
+
+    /// Checks every value against those of the arguments of the tests
+    void check() const {
+        REQUIRE(input->value() == "file.txt");
+        REQUIRE(port->value() == 8080);
+        REQUIRE(verbose->value() == true);
+        REQUIRE(values->value() == std::vector<int32_t>{1, -2, 3});
+        REQUIRE(timeout->value() == std::chrono::milliseconds(250));
+        REQUIRE(mode->value() == Mode::kWrite);
+        REQUIRE((*ratio)->value() == 0.25);
+        REQUIRE(home->value() == "/home/user");
+    }
+};
+
+const char *kEnvironment[] = {"HOME=/home/user", nullptr};
+
+const char *kArgv[] = {"path", "file.txt", "--port", "8080", "-v", "--values", "1,-2,3", "--timeout", "250ms",
+                       "--mode", "write", "--ratio", "0.25", "--", "rest"};
+constexpr int kArgc = sizeof(kArgv) / sizeof(kArgv[0]);
+
+/// Size of the regions of the tests
+constexpr std::size_t kRegionSize = 64 * 1024;
+
+/// An anonymous mapping shared with forked processes
+struct SharedRegion {
+    void *data = ::mmap(nullptr, kRegionSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    ~SharedRegion() { ::munmap(data, kRegionSize); }
+};
+
+/// @{ Parts of the layout of a region, written over by the tests as another process could
+/// The header holds the magic, the version, the number of slots, the end of the entries and the number of entries, then
+/// comes the table of offsets, and each entry starts with its hash, the size of its key and the size of its snapshot
+constexpr std::size_t kSlotsOffset = 12;
+constexpr std::size_t kTableOffset = 32;
+constexpr std::size_t kEntrySize = 16;
+
+uint32_t &slot_count(void *region) { return *reinterpret_cast<uint32_t *>(static_cast<char *>(region) + kSlotsOffset); }
+
+/// \return The slots of the table that hold an offset
+std::vector<uint64_t *> taken_slots(void *region) {
+    std::vector<uint64_t *> taken;
+    auto *const table = reinterpret_cast<uint64_t *>(static_cast<char *>(region) + kTableOffset);
+    for (std::size_t ii = 0; ii < slot_count(region); ii++) {
+        if (table[ii] != 0) {
+            taken.push_back(&table[ii]);
+        }
+    }
+    return taken;
+}
+
+/// \return The snapshot of the entry at [offset]
+char *snapshot_of(void *region, const uint64_t offset) {
+    char *const entry = static_cast<char *>(region) + offset;
+    uint32_t key_size = 0;
+    std::memcpy(&key_size, entry + 8, sizeof(key_size));
+    return entry + kEntrySize + key_size;
+}
+/// @}
+
+} // namespace
+
+/// Tests the region of snapshots
+TEST_CASE("ParseCacheRegion", "Parsing") {
+    SharedRegion region;
+    REQUIRE(region.data != MAP_FAILED);
+    detail::ParseCache cache(region.data, kRegionSize);
+
+    SECTION("Insert and find") {
+        REQUIRE(!cache.find("a").has_value());
+        REQUIRE(cache.insert("a", "first"));
+        REQUIRE(cache.insert("b", ""));
+        REQUIRE(cache.find("a")->str() == "first");
+        REQUIRE(cache.find("b")->str().empty());
+        REQUIRE(!cache.find("c").has_value());
+
+        // The first snapshot of a key stays
+        REQUIRE(cache.insert("a", "second"));
+        REQUIRE(cache.find("a")->str() == "first");
+        REQUIRE(cache.size() == 2);
+    }
+
+    SECTION("Attach") {
+        REQUIRE(cache.insert("key", "value"));
+        const detail::ParseCache other(region.data, kRegionSize);
+        REQUIRE(other.find("key")->str() == "value");
+    }
+
+    SECTION("Full") {
+        const std::string snapshot(1024, 'x');
+        std::size_t stored = 0;
+        while (cache.insert(std::to_string(stored), snapshot)) {
+            stored++;
+        }
+        REQUIRE(stored > 0);
+        REQUIRE(stored < kRegionSize / snapshot.size());
+        REQUIRE(cache.find("0")->str() == snapshot);
+    }
+
+    SECTION("Not a cache") {
+        std::vector<char> garbage(kRegionSize, 'x');
+        REQUIRE_THROWS_AS(detail::ParseCache(garbage.data(), garbage.size()), std::invalid_argument);
+        REQUIRE_THROWS_AS(detail::ParseCache(garbage.data(), 64), std::invalid_argument);
+
+        // The table must be probed with a mask
+        for (const uint32_t slots : {0U, 3U, 1U << 30U}) {
+            slot_count(region.data) = slots;
+            REQUIRE_THROWS_AS(detail::ParseCache(region.data, kRegionSize), std::invalid_argument);
+        }
+    }
+
+    SECTION("Snapshots") {
+        std::string snapshot;
+        detail::SnapshotWriter out(snapshot);
+        out.put(true);
+        out.put(std::string("text"));
+        out.put(Cidr{IpAddress{{10}, false}, 8});
+
+        detail::SnapshotReader in(snapshot.data(), snapshot.size());
+        bool flag = false;
+        std::string text;
+        Cidr block;
+        in.get(flag);
+        in.get(text);
+        in.get(block);
+        REQUIRE(flag);
+        REQUIRE(text == "text");
+        REQUIRE(block == Cidr{IpAddress{{10}, false}, 8});
+        REQUIRE_THROWS_AS(in.get(flag), std::out_of_range);
+
+        // Values their types can not hold
+        const char not_bool = 2;
+        REQUIRE_THROWS_AS(detail::SnapshotReader(&not_bool, 1).get(flag), std::invalid_argument);
+        std::string long_prefix = snapshot.substr(snapshot.size() - 18);
+        long_prefix.back() = 33;
+        REQUIRE_THROWS_AS(detail::SnapshotReader(long_prefix.data(), long_prefix.size()).get(block), std::invalid_argument);
+
+        // Sizes past the end of the snapshot
+        REQUIRE_THROWS_AS(detail::SnapshotReader(snapshot.data(), 6).get(text), std::out_of_range);
+        const uint32_t many = 1000;
+        std::vector<uint64_t> values;
+        REQUIRE_THROWS_AS(detail::SnapshotReader(reinterpret_cast<const char *>(&many), sizeof(many)).get(values), std::out_of_range);
+    }
+
+    SECTION("Corrupted") {
+        REQUIRE(cache.insert("a", "first"));
+        const auto taken = taken_slots(region.data);
+        REQUIRE(taken.size() == 1);
+        const uint64_t offset = *taken[0];
+
+        // Offsets into the header or the table, past the entries, past the region, or not aligned, are misses
+        for (const uint64_t corrupted : {uint64_t{8}, uint64_t{kTableOffset}, offset + 4096, uint64_t{kRegionSize} - 8,
+                                         ~uint64_t{0}, offset + 1}) {
+            *taken[0] = corrupted;
+            REQUIRE(!cache.find("a").has_value());
+        }
+
+        // So is an entry whose key and snapshot run past the region
+        *taken[0] = offset;
+        uint32_t huge = 0xFFFFFFFF;
+        std::memcpy(static_cast<char *>(region.data) + offset + 12, &huge, sizeof(huge));
+        REQUIRE(!cache.find("a").has_value());
+    }
+}
+
+/// Tests parses that are stored in and loaded from the cache
+TEST_CASE("ParseCache", "Parsing") {
+    SharedRegion region;
+    REQUIRE(region.data != MAP_FAILED);
+    const auto cache = std::make_shared<detail::ParseCache>(region.data, kRegionSize);
+
+    Parser first;
+    first.set_environment(kEnvironment);
+    first.set_cache(cache);
+    const Schema a(first);
+
+    SECTION("Hit") {
+        REQUIRE(first.parse(kArgc, kArgv) == std::vector<std::string>{"rest"});
+        a.check();
+        REQUIRE(cache->size() == 1);
+
+        // Another parser of the same schema loads the values instead of parsing
+        Parser second;
+        second.set_environment(kEnvironment);
+        second.set_cache(cache);
+        const Schema b(second);
+        REQUIRE(second.parse(kArgc, kArgv) == std::vector<std::string>{"rest"});
+        b.check();
+        REQUIRE(cache->size() == 1);
+
+        // Values of a previous parse do not carry over a hit
+        const char *argv[] = {"other", "file.txt"};
+        REQUIRE(second.parse(2, argv).empty());
+        REQUIRE(second.parse(kArgc, kArgv) == std::vector<std::string>{"rest"});
+        b.check();
+        REQUIRE(second.parse(2, argv).empty());
+        REQUIRE(b.port->value() == 80);
+        REQUIRE(b.values->has_value() == false);
+        REQUIRE(b.mode->value() == Mode::kRead);
+        REQUIRE((*b.ratio)->value() == 0.5);
+        REQUIRE(cache->size() == 2);
+    }
+
+    SECTION("Keys") {
+        first.parse(kArgc, kArgv);
+
+        // Another schema
+        Parser other;
+        other.set_environment(kEnvironment);
+        other.set_cache(cache);
+        const Schema b(other);
+        other.add(Config<bool>{.default_value = false, .allowed_values = {}, .name = "extra"});
+        other.parse(kArgc, kArgv);
+        REQUIRE(cache->size() == 2);
+
+        // Another value of an environment variable
+        const char *environment[] = {"HOME=/root", nullptr};
+        first.set_environment(environment);
+        first.parse(kArgc, kArgv);
+        REQUIRE(a.home->value() == "/root");
+        REQUIRE(cache->size() == 3);
+
+        // Expanding variables is not cached
+        first.set_expand(true);
+        first.parse(kArgc, kArgv);
+        REQUIRE(cache->size() == 3);
+    }
+
+    SECTION("Settings") {
+        bool exited = false;
+        Parser::Callbacks cbs;
+        cbs.exit = [&exited] { exited = true; };
+        first.set_quiet(true);
+        first.set_callbacks(std::move(cbs));
+
+        // Settings change the schema as options do, even between two parses of the same arguments
+        const char *argv[] = {"path", "file.txt", "--unknown"};
+        first.parse(3, argv);
+        REQUIRE(!exited);
+        REQUIRE(cache->size() == 1);
+
+        first.set_reject_unknown(true);
+        first.parse(3, argv);
+        REQUIRE(exited);
+        REQUIRE(cache->size() == 1);
+
+        exited = false;
+        first.set_reject_unknown(false);
+        first.parse(3, argv);
+        REQUIRE(!exited);
+        REQUIRE(cache->size() == 1);
+
+        first.set_strict(true);
+        first.parse(3, argv);
+        REQUIRE(cache->size() == 2);
+    }
+
+    SECTION("Failures") {
+        replace_exit_cb(first);
+
+        const char *invalid[] = {"path", "file.txt", "--mode", "append"};
+        first.parse(4, invalid);
+        const char *help[] = {"path", "file.txt", "--help"};
+        first.parse(3, help);
+        REQUIRE(cache->size() == 0);
+
+        Parser::Callbacks cbs;
+        cbs.exit = [] { throw std::runtime_error("exit"); };
+        first.set_callbacks(std::move(cbs));
+        REQUIRE_THROWS_AS(first.parse(4, invalid), std::runtime_error);
+        REQUIRE(cache->size() == 0);
+    }
+
+    SECTION("Subparsers") {
+        Parser p;
+        replace_exit_cb(p);
+        p.set_cache(cache);
+        auto &subparsers = p.add_subparser("command", {"run", "stop"});
+        const auto run = subparsers["run"].add(Config<uint32_t>{.default_value = 1, .allowed_values = {}, .name = "threads"});
+        const auto stop = subparsers["stop"].add(Config<uint32_t>{.default_value = 2, .allowed_values = {}, .name = "threads"});
+
+        const char *argv[] = {"path", "run", "--threads", "4"};
+        p.parse(4, argv);
+        REQUIRE(run->value() == 4);
+        p.parse(4, argv);
+        REQUIRE(p.subparser() == "run");
+        REQUIRE(run->value() == 4);
+        REQUIRE(cache->size() == 1);
+
+        // A missing subparser is not stored
+        const char *missing[] = {"path"};
+        p.parse(1, missing);
+        REQUIRE(cache->size() == 1);
+        REQUIRE(stop->value() == 2);
+
+        // Options registered on a subparser after a parse change the schema of the parser the cache is used by
+        const auto verbose = subparsers["run"].add(Config<bool>{.default_value = false, .allowed_values = {}, .name = "verbose"});
+        p.parse(4, argv);
+        REQUIRE(run->value() == 4);
+        REQUIRE(cache->size() == 2);
+        REQUIRE(verbose->value() == false);
+    }
+
+    SECTION("Corrupted snapshots") {
+        first.parse(kArgc, kArgv);
+        const auto taken = taken_slots(region.data);
+        REQUIRE(taken.size() == 1);
+        char *const snapshot = snapshot_of(region.data, *taken[0]);
+
+        // Option ids that do not exist, and snapshots cut short, are misses, parsed again with the same result
+        const uint32_t option_ids[] = {1, 100000};
+        const uint32_t everything[] = {0xFFFFFFFF};
+        const uint32_t truncated = 4;
+        for (std::size_t run = 0; run < 3; run++) {
+            if (run == 0) {
+                std::memcpy(snapshot, option_ids, sizeof(option_ids));
+            } else if (run == 1) {
+                std::memcpy(snapshot, everything, sizeof(everything));
+            } else {
+                std::memcpy(static_cast<char *>(region.data) + *taken[0] + 12, &truncated, sizeof(truncated));
+            }
+            Parser p;
+            p.set_environment(kEnvironment);
+            p.set_cache(cache);
+            const Schema schema(p);
+            REQUIRE(p.parse(kArgc, kArgv) == std::vector<std::string>{"rest"});
+            schema.check();
+        }
+    }
+
+    SECTION("Forked processes") {
+        // A child stores its parse, the parent loads it
+        const pid_t child = ::fork();
+        REQUIRE(child >= 0);
+        if (child == 0) {
+            Parser p;
+            p.set_environment(kEnvironment);
+            p.set_cache(std::make_shared<detail::ParseCache>(region.data, kRegionSize));
+            const Schema schema(p);
+            p.parse(kArgc, kArgv);
+            ::_exit(cache->size() == 1 ? 0 : 1);
+        }
+
+        int status = 0;
+        REQUIRE(::waitpid(child, &status, 0) == child);
+        REQUIRE(WIFEXITED(status));
+        REQUIRE(WEXITSTATUS(status) == 0);
+        REQUIRE(cache->size() == 1);
+
+        first.parse(kArgc, kArgv);
+        a.check();
+        REQUIRE(cache->size() == 1);
+    }
+}
+
+/// Tests a cache in a file, kept between processes
+TEST_CASE("ParseCacheFile", "Parsing") {
+    char name[] = "/tmp/argparse_cache_XXXXXX";
+    const int fd = ::mkstemp(name);
+    REQUIRE(fd >= 0);
+    ::close(fd);
+
+    {
+        Parser p;
+        p.set_environment(kEnvironment);
+        p.set_cache(name);
+        const Schema schema(p);
+        p.parse(kArgc, kArgv);
+        schema.check();
+    }
+
+    // The file is mapped again, as by the next run of the program
+    const auto cache = std::make_shared<detail::ParseCache>(name);
+    REQUIRE(cache->size() == 1);
+    {
+        Parser p;
+        p.set_environment(kEnvironment);
+        p.set_cache(cache);
+        const Schema schema(p);
+        p.parse(kArgc, kArgv);
+        schema.check();
+        REQUIRE(cache->size() == 1);
+    }
+
+    // Offsets written over in the file are misses, the arguments are parsed again, and the file is mapped again while
+    // [cache] still maps it
+    {
+        const int file = ::open(name, O_RDWR);
+        REQUIRE(file >= 0);
+        void *const region = ::mmap(nullptr, detail::ParseCache::kDefaultSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+        ::close(file);
+        REQUIRE(region != MAP_FAILED);
+        for (uint64_t *slot : taken_slots(region)) {
+            *slot = 0x4141414141414141ULL;
+        }
+        ::munmap(region, detail::ParseCache::kDefaultSize);
+
+        Parser p;
+        p.set_environment(kEnvironment);
+        p.set_cache(name);
+        const Schema schema(p);
+        p.parse(kArgc, kArgv);
+        schema.check();
+    }
+
+    std::remove(name);
+
+    // A new file is only readable and writable by its owner
+    {
+        Parser p;
+        p.set_cache(name);
+    }
+    struct stat status {};
+    REQUIRE(::stat(name, &status) == 0);
+    REQUIRE((status.st_mode & 0777) == 0600);
+    std::remove(name);
+}
@@ -1,6 +1,7 @@
 #include "catch.hpp"
 
 #include "argparse.h"
+#include "options.h"
 #include "parser.h"
 #include "utilities.h"
 using namespace argparse;
@@ -9,6 +10,22 @@ using namespace argparse;
 TEST_CASE("BasicArgument", "Parsing") {
     argparse::detail::Parser p;
 
+    // Registers a letter option that can take any number of values without splitting
+    Options options;
+    auto add = [&options](const char letter) {
+        options.add(argparse::Config<std::string>{.default_value = {}, .allowed_values = {}, .name = std::string(1, letter), .help = "", .required = false, .letter = letter});
+        return options.find(std::string(1, letter));
+    };
+
+    // Copies the values of an option
+    auto values = [](const Args &args, const std::size_t id) {
+        std::vector<std::string> strings;
+        for (const auto &value : args.slot(id).values) {
+            strings.push_back(value.str());
+        }
+        return strings;
+    };
+
     SECTION("One option no value") {
         constexpr int argc = 2;
         const char *argv[argc] = {
@@ -16,10 +33,13 @@ TEST_CASE("BasicArgument", "Parsing") {
             "-d"
         };
 
-        const auto args = p.parse(argc, argv);
-        REQUIRE(args.size() == 1);
-        REQUIRE(args.exists("d"));
-        REQUIRE(args.get("d").empty());
+        const auto d = add('d');
+        const auto &args = p.parse(argc, argv, options);
+        REQUIRE(args.order().size() == 1);
+        REQUIRE(args.slot(d).present);
+        REQUIRE(args.slot(d).index == 1);
+        REQUIRE(args.slot(d).values.empty());
+        REQUIRE(args.positionals().size() == 1);
     }
 
     SECTION("One option one value") {
@@ -30,11 +50,12 @@ TEST_CASE("BasicArgument", "Parsing") {
             "value",
         };
 
-        const auto args = p.parse(argc, argv);
-        REQUIRE(args.size() == 1);
-        REQUIRE(args.exists("d"));
-        REQUIRE(args.get("d").size() == 1);
-        REQUIRE(args.get("d")[0] == "value");
+        const auto d = add('d');
+        const auto &args = p.parse(argc, argv, options);
+        REQUIRE(args.order().size() == 1);
+        REQUIRE(args.slot(d).present);
+        REQUIRE(values(args, d).size() == 1);
+        REQUIRE(values(args, d)[0] == "value");
     }
 
     SECTION("One option 5 values") {
@@ -50,14 +71,18 @@ TEST_CASE("BasicArgument", "Parsing") {
             "value5",
         };
 
-        const auto args = p.parse(argc, argv);
-        REQUIRE(args.size() == 1);
-        REQUIRE(args.exists("d"));
-        REQUIRE(args.get("d").size() == kNumValues);
-        const auto &vec = args.get("d");
+        const auto d = add('d');
+        const auto &args = p.parse(argc, argv, options);
+        REQUIRE(args.order().size() == 1);
+        REQUIRE(args.slot(d).present);
+        REQUIRE(values(args, d).size() == kNumValues);
+        const auto vec = values(args, d);
         for (std::size_t ii = 0; ii < kNumValues; ii++) {
             REQUIRE(vec[ii] == argv[ii + 2]);
         }
+
+        // The option takes a single value, so the second value is flagged
+        REQUIRE(args.slot(d).surplus == 3);
     }
 
     SECTION("3 options with {1, 2, 3} values respectively") {
@@ -75,23 +100,51 @@ TEST_CASE("BasicArgument", "Parsing") {
             "value3",
         };
 
-        const auto args = p.parse(argc, argv);
-        REQUIRE(args.size() == 3);
-        REQUIRE(args.exists("a"));
-        REQUIRE(args.exists("b"));
-        REQUIRE(args.exists("c"));
-        REQUIRE(args.get("a").size() == 1);
-        REQUIRE(args.get("b").size() == 2);
-        REQUIRE(args.get("c").size() == 3);
-        const auto &a = args.get("a");
-        const auto &b = args.get("b");
-        const auto &c = args.get("c");
+        const auto a_id = add('a');
+        const auto b_id = add('b');
+        const auto c_id = add('c');
+        const auto &args = p.parse(argc, argv, options);
+        REQUIRE(args.order().size() == 3);
+        REQUIRE(args.slot(a_id).present);
+        REQUIRE(args.slot(b_id).present);
+        REQUIRE(args.slot(c_id).present);
+        REQUIRE(values(args, a_id).size() == 1);
+        REQUIRE(values(args, b_id).size() == 2);
+        REQUIRE(values(args, c_id).size() == 3);
+        const auto a = values(args, a_id);
+        const auto b = values(args, b_id);
+        const auto c = values(args, c_id);
         REQUIRE(a[0] == "value1");
         REQUIRE(b[0] == "value1");
         REQUIRE(b[1] == "value2");
         REQUIRE(c[0] == "value1");
         REQUIRE(c[1] == "value2");
         REQUIRE(c[2] == "value3");
+
+        // Options are recorded in the order they appeared
+        REQUIRE(args.order()[0] == a_id);
+        REQUIRE(args.order()[1] == b_id);
+        REQUIRE(args.order()[2] == c_id);
+    }
+
+    SECTION("Unknown options are detected where they appear") {
+        constexpr int argc = 6;
+        const char *argv[argc] = {
+            "path",
+            "--a",
+            "value1",
+            "--unknown",
+            "value2",
+            "-z",
+        };
+
+        const auto a = add('a');
+        const auto &args = p.parse(argc, argv, options);
+        REQUIRE(args.order().size() == 1);
+        REQUIRE(values(args, a).size() == 1);
+        REQUIRE(args.unknown().size() == 2);
+        REQUIRE(args.unknown()[0] == 3);
+        REQUIRE(args.unknown()[1] == 5);
     }
 }
 
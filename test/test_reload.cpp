@@ -0,0 +1,193 @@
+#include "catch.hpp"
+
+#include "reload.h"
+using namespace argparse;
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include <unistd.h>
+
+namespace {
+
+/// Values extracted after each parse, [threads] and [copy] are always the same within a snapshot
+struct Flags {
+    uint32_t threads;
+    uint32_t copy;
+    std::string mode;
+};
+
+/// A config file in a directory of its own, removed when going out of scope
+struct TemporaryConfig {
+    std::string directory;
+    std::string path;
+
+    explicit TemporaryConfig(const std::string &text) {
+        char name[] = "/tmp/argparse_XXXXXX";
+        REQUIRE(::mkdtemp(name) != nullptr);
+        directory = name;
+        path = directory + "/app.conf";
+        write(text);
+    }
+
+    ~TemporaryConfig() {
+        std::remove(path.c_str());
+        ::rmdir(directory.c_str());
+    }
+
+    /// Replaces the file by renaming a new one over it, as editors do
+    void write(const std::string &text) const {
+        const std::string next = directory + "/next.conf";
+        FILE *file = std::fopen(next.c_str(), "w");
+        REQUIRE(file != nullptr);
+        std::fwrite(text.data(), 1, text.size(), file);
+        std::fclose(file);
+        REQUIRE(std::rename(next.c_str(), path.c_str()) == 0);
+    }
+
+    /// Rewrites the same file in place, truncating it to [text], as `cp` does
+    void rewrite(const std::string &text) const {
+        FILE *file = std::fopen(path.c_str(), "w");
+        REQUIRE(file != nullptr);
+        std::fwrite(text.data(), 1, text.size(), file);
+        std::fclose(file);
+    }
+};
+
+Reloader<Flags>::Schema schema() {
+    return [](Parser &parser) {
+        const auto threads = parser.add(Config<uint32_t>{.default_value = 1, .allowed_values = {}, .name = "threads"});
+        const auto mode = parser.add(Config<std::string>{.default_value = "slow", .allowed_values = {}, .name = "mode"});
+        return [threads, mode] { return Flags{threads->value(), threads->value(), mode->value()}; };
+    };
+}
+
+} // namespace
+
+/// Tests comparing config files
+TEST_CASE("ConfigFileDiff", "Reload") {
+    const std::string before = "threads = 1\nmode = fast\nverbose\n[run]\njobs = 2\n";
+    const std::string after = "threads = 1\nmode = slow\nverbose =\n[run]\njobs = 2\nextra = 3\n";
+    const detail::ConfigFile old_file(before.data(), before.size());
+    const detail::ConfigFile new_file(after.data(), after.size());
+
+    REQUIRE(detail::diff(old_file, old_file).empty());
+    REQUIRE(detail::diff(old_file, new_file) == std::vector<std::string>{"mode", "run.extra", "verbose"});
+    REQUIRE(detail::diff(new_file, old_file) == std::vector<std::string>{"mode", "run.extra", "verbose"});
+}
+
+/// Tests the epochs that decide when a replaced snapshot is freed
+TEST_CASE("Epochs", "Reload") {
+    detail::Epochs epochs;
+    const auto first = epochs.claim();
+    const auto second = epochs.claim();
+    REQUIRE(first != second);
+
+    REQUIRE(epochs.oldest() == 1);
+    epochs.enter(first);
+    REQUIRE(epochs.advance() == 2);
+    epochs.enter(second);
+    REQUIRE(epochs.oldest() == 1);
+    epochs.leave(first);
+    REQUIRE(epochs.oldest() == 2);
+    epochs.leave(second);
+    REQUIRE(epochs.advance() == 3);
+    REQUIRE(epochs.oldest() == 3);
+
+    epochs.release(first);
+    REQUIRE(epochs.claim() == first);
+
+    for (std::size_t ii = 2; ii < detail::Epochs::kSlots; ii++) {
+        epochs.claim();
+    }
+    REQUIRE_THROWS_AS(epochs.claim(), std::length_error);
+}
+
+/// Tests publishing a new snapshot when the config file changes
+TEST_CASE("Reloader", "Reload") {
+    const TemporaryConfig config("threads = 2\n");
+    Reloader<Flags> reloader(schema(), {"path", "--mode", "fast"}, config.path);
+    auto reader = reloader.reader();
+
+    SECTION("Initial") {
+        const auto flags = reader.read();
+        REQUIRE(flags->threads == 2);
+        REQUIRE(flags->mode == "fast");
+        REQUIRE(reloader.reload().empty());
+    }
+
+    SECTION("Reload") {
+        // A view keeps seeing the snapshot it was given
+        auto old_view = std::make_unique<Reloader<Flags>::View>(reader.read());
+
+        config.write("threads = 4\nmode = ignored\n");
+        REQUIRE(reloader.reload() == std::vector<std::string>{"mode", "threads"});
+        REQUIRE((*old_view)->threads == 2);
+        old_view.reset();
+
+        // The input arguments still take precedence
+        const auto flags = reader.read();
+        REQUIRE(flags->threads == 4);
+        REQUIRE(flags->mode == "fast");
+    }
+
+    SECTION("Rewritten in place") {
+        // The same length, then shorter, the file read before is compared as it was read
+        config.rewrite("threads = 4\n");
+        REQUIRE(reloader.reload() == std::vector<std::string>{"threads"});
+        REQUIRE(reader.read()->threads == 4);
+
+        config.rewrite("\n");
+        REQUIRE(reloader.reload() == std::vector<std::string>{"threads"});
+        REQUIRE(reader.read()->threads == 1);
+    }
+
+    SECTION("Failed reload") {
+        config.write("threads = many\n");
+        REQUIRE_THROWS(reloader.reload());
+        REQUIRE(reader.read()->threads == 2);
+
+        config.write("threads = 3\n");
+        REQUIRE(reloader.reload() == std::vector<std::string>{"threads"});
+        REQUIRE(reader.read()->threads == 3);
+    }
+
+    SECTION("Poll") {
+        REQUIRE(reloader.poll(std::chrono::milliseconds(0)).empty());
+
+        config.write("threads = 5\n");
+        REQUIRE(reloader.poll(std::chrono::seconds(5)) == std::vector<std::string>{"threads"});
+        REQUIRE(reader.read()->threads == 5);
+    }
+
+    SECTION("Concurrent readers") {
+        std::atomic<bool> done{false};
+        std::atomic<bool> consistent{true};
+        std::vector<std::thread> threads;
+        for (std::size_t ii = 0; ii < 4; ii++) {
+            threads.emplace_back([&] {
+                auto own = reloader.reader();
+                while (!done.load()) {
+                    const auto flags = own.read();
+                    if ((flags->threads != flags->copy) || (flags->threads < 2)) {
+                        consistent = false;
+                    }
+                }
+            });
+        }
+
+        for (uint32_t threads_value = 10; threads_value < 50; threads_value++) {
+            config.write("threads = " + std::to_string(threads_value) + "\n");
+            reloader.reload();
+        }
+        done = true;
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        REQUIRE(consistent.load());
+        REQUIRE(reader.read()->threads == 49);
+    }
+}
@@ -0,0 +1,88 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "options.h"
+#include "string_pool.h"
+#include "utilities.h"
+
+#include <string>
+#include <vector>
+
+using argparse::detail::PooledString;
+using argparse::detail::StringPool;
+
+/// Tests interning strings into one contiguous pool
+TEST_CASE("StringPool", "StringPool") {
+    StringPool pool;
+
+    SECTION("The same string is stored once") {
+        const auto first = pool.intern("verbose");
+        const auto bytes = pool.bytes();
+        const auto second = pool.intern(std::string("verbose"));
+
+        REQUIRE(first.offset == second.offset);
+        REQUIRE(first.size == 7);
+        REQUIRE(pool.bytes() == bytes);
+        REQUIRE(std::string(pool.c_str(first)) == "verbose");
+    }
+
+    SECTION("Prefixes and empty strings are distinct") {
+        const auto long_name = pool.intern("verbose");
+        const auto prefix = pool.intern("verb");
+        const auto empty = pool.intern("");
+
+        REQUIRE(long_name.offset != prefix.offset);
+        REQUIRE(std::string(pool.c_str(prefix)) == "verb");
+        REQUIRE(empty.size == 0);
+        REQUIRE(std::string(pool.c_str(empty)).empty());
+    }
+
+    SECTION("Strings keep their offsets as the pool grows") {
+        std::vector<PooledString> strings;
+        for (int ii = 0; ii < 1000; ii++) {
+            strings.push_back(pool.intern("option-" + std::to_string(ii)));
+        }
+        for (int ii = 0; ii < 1000; ii++) {
+            REQUIRE(pool.c_str(strings[ii]) == "option-" + std::to_string(ii));
+            REQUIRE(pool.intern("option-" + std::to_string(ii)).offset == strings[ii].offset);
+        }
+    }
+}
+
+/// Tests looking up options whose names are held in the pool
+TEST_CASE("PooledOptions", "StringPool") {
+    argparse::Options options;
+    for (int ii = 0; ii < 100; ii++) {
+        options.add(argparse::Config<int32_t>{.default_value = ii, .allowed_values = {}, .name = "option-" + std::to_string(ii)});
+    }
+
+    REQUIRE(options.size() == 100);
+    for (std::size_t ii = 0; ii < 100; ii++) {
+        REQUIRE(options.find("option-" + std::to_string(ii)) == ii);
+    }
+    REQUIRE(options.find("option-") == argparse::kNoOption);
+    REQUIRE(options.find("option-1000") == argparse::kNoOption);
+
+    // Registering a name again keeps its id, and the name is not stored again
+    const auto bytes = options.pool()->bytes();
+    options.add(argparse::Config<int32_t>{.default_value = 5, .allowed_values = {}, .name = "option-42"});
+    REQUIRE(options.size() == 100);
+    REQUIRE(options.find("option-42") == 42);
+    REQUIRE(options.pool()->bytes() == bytes);
+}
+
+/// Tests that subparsers with the same options parse independently while sharing text
+TEST_CASE("PooledSubparsers", "StringPool") {
+    argparse::Parser p;
+    replace_exit_cb(p);
+
+    auto &subparsers = p.add_subparser("mode", {"play", "stop"});
+    auto play = subparsers["play"].add(argparse::Config<int32_t>{.default_value = 1, .allowed_values = {}, .name = "speed", .help = "Speed"});
+    auto stop = subparsers["stop"].add(argparse::Config<int32_t>{.default_value = 2, .allowed_values = {}, .name = "speed", .help = "Speed"});
+
+    const char *argv[] = {"path", "stop", "--speed", "9"};
+    p.parse(4, argv);
+
+    REQUIRE(play->value() == 1);
+    REQUIRE(stop->value() == 9);
+}
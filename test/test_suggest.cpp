@@ -0,0 +1,172 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "suggest.h"
+#include "utilities.h"
+using namespace argparse;
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace {
+
+/// Edit distance with swaps of adjacent bytes by the full table, to check the bit-parallel one against
+std::size_t reference_distance(const std::string &a, const std::string &b) {
+    std::vector<std::vector<std::size_t>> d(a.size() + 1, std::vector<std::size_t>(b.size() + 1));
+    for (std::size_t ii = 0; ii <= a.size(); ii++) {
+        for (std::size_t jj = 0; jj <= b.size(); jj++) {
+            if ((ii == 0) || (jj == 0)) {
+                d[ii][jj] = ii + jj;
+                continue;
+            }
+            d[ii][jj] = std::min({d[ii - 1][jj] + 1, d[ii][jj - 1] + 1, d[ii - 1][jj - 1] + ((a[ii - 1] == b[jj - 1]) ? 0 : 1)});
+            if ((ii > 1) && (jj > 1) && (a[ii - 1] == b[jj - 2]) && (a[ii - 2] == b[jj - 1])) {
+                d[ii][jj] = std::min(d[ii][jj], d[ii - 2][jj - 2] + 1);
+            }
+        }
+    }
+    return d[a.size()][b.size()];
+}
+
+std::size_t distance(const std::string &pattern, const std::string &text, const std::size_t bound = 1000) {
+    return detail::EditDistance(pattern.data(), pattern.size())(text.data(), text.size(), bound);
+}
+
+} // namespace
+
+/// Tests the bit-parallel edit distance
+TEST_CASE("EditDistance", "Suggestions") {
+    SECTION("Known distances") {
+        REQUIRE(distance("kitten", "sitting") == 3);
+        REQUIRE(distance("verbose", "verbose") == 0);
+        REQUIRE(distance("verbose", "verbsoe") == 1);
+        REQUIRE(distance("ca", "abc") == 3);
+        REQUIRE(distance("name", "") == 4);
+        REQUIRE(distance("", "name") == 4);
+        REQUIRE(distance("port", "sport") == 1);
+        REQUIRE(distance(std::string(64, 'a'), std::string(63, 'a') + "b") == 1);
+    }
+
+    SECTION("Bound") {
+        REQUIRE(distance("abcdef", "uvwxyz", 2) == 3);
+        REQUIRE(distance("abcdef", "abcdxf", 2) == 1);
+    }
+
+    SECTION("Same as the full table") {
+        std::mt19937 rng(7);
+        auto random = [&rng](const std::size_t size) {
+            std::string s;
+            for (std::size_t ii = 0; ii < size; ii++) {
+                s.push_back(static_cast<char>('a' + rng() % 4));
+            }
+            return s;
+        };
+        for (std::size_t ii = 0; ii < 500; ii++) {
+            const auto a = random(1 + rng() % 64);
+            const auto b = random(rng() % 70);
+            REQUIRE(distance(a, b) == reference_distance(a, b));
+        }
+    }
+}
+
+/// Tests finding the closest names
+TEST_CASE("Suggestions", "Suggestions") {
+    detail::Suggestions suggestions;
+    const std::vector<std::string> names{"verbose", "version", "port", "sport", "threads", "thread-count", "help"};
+    for (std::size_t id = 0; id < names.size(); id++) {
+        suggestions.add(names[id].data(), names[id].size(), id);
+    }
+
+    auto suggest = [&](const std::string &name) {
+        std::vector<std::string> out;
+        for (const auto id : suggestions.suggest(name.data(), name.size())) {
+            out.push_back(names[id]);
+        }
+        return out;
+    };
+
+    REQUIRE(suggest("verbos") == std::vector<std::string>{"verbose"});
+    REQUIRE(suggest("verison") == std::vector<std::string>{"version"});
+    REQUIRE(suggest("prot") == std::vector<std::string>{"port"});
+    REQUIRE(suggest("thread") == std::vector<std::string>{"threads"});
+    REQUIRE(suggest("xyz").empty());
+    REQUIRE(suggest("").empty());
+    REQUIRE(suggest(std::string(65, 'a')).empty());
+}
+
+/// Tests rejecting unknown options
+TEST_CASE("RejectUnknown", "Suggestions") {
+    Parser p;
+    replace_exit_cb(p);
+    p.add(Config<uint32_t>{.default_value = {}, .allowed_values = {}, .name = "port"});
+    p.add(Config<bool>{.default_value = false, .allowed_values = {}, .name = "verbose"});
+
+    std::string unknown;
+    std::vector<std::string> suggested;
+    Parser::Callbacks cbs;
+    cbs.unknown = [&](const std::string &name, const std::vector<std::string> &suggestions) {
+        unknown = name;
+        suggested = suggestions;
+    };
+    p.set_callbacks(std::move(cbs));
+
+    const char *argv[] = {"path", "--prot", "80", "--verbose"};
+
+    SECTION("Ignored by default") {
+        REQUIRE(p.validate(4, argv));
+        p.parse(4, argv);
+        REQUIRE(unknown.empty());
+    }
+
+    SECTION("Parse") {
+        p.set_reject_unknown(true);
+        p.parse(4, argv);
+        REQUIRE(unknown == "prot");
+        REQUIRE(suggested == std::vector<std::string>{"port"});
+    }
+
+    SECTION("Validate") {
+        p.set_reject_unknown(true);
+        std::vector<Parser::Diagnostic> diagnostics;
+        REQUIRE(!p.validate(4, argv, [&](const Parser::Diagnostic &d) { diagnostics.push_back(d); }));
+        REQUIRE(diagnostics.size() == 1);
+        REQUIRE(diagnostics[0].error == Parser::Diagnostic::Error::kUnknown);
+        REQUIRE(std::string(diagnostics[0].name) == "--prot");
+        REQUIRE(diagnostics[0].index == std::size_t{1});
+        REQUIRE(std::string(diagnostics[0].suggestion) == "port");
+    }
+
+    SECTION("Subparsers") {
+        Parser q;
+        replace_exit_cb(q);
+        auto &subparsers = q.add_subparser("command", {"run"});
+        subparsers["run"].add(Config<uint32_t>{.default_value = {}, .allowed_values = {}, .name = "jobs"});
+        q.set_reject_unknown(true);
+
+        const char *args[] = {"path", "run", "--jbos", "2"};
+        REQUIRE(!q.validate(4, args));
+    }
+}
+
+/// Tests that a large schema still suggests quickly
+TEST_CASE("SuggestMany", "Suggestions") {
+    detail::Suggestions suggestions;
+    std::mt19937 rng(3);
+    std::vector<std::string> names;
+    for (std::size_t id = 0; id < 100000; id++) {
+        std::string name;
+        const std::size_t size = 6 + rng() % 20;
+        for (std::size_t ii = 0; ii < size; ii++) {
+            name.push_back(static_cast<char>('a' + rng() % 26));
+        }
+        suggestions.add(name.data(), name.size(), id);
+        names.push_back(std::move(name));
+    }
+
+    std::string typo = names[4242];
+    std::swap(typo[1], typo[2]);
+    const auto found = suggestions.suggest(typo.data(), typo.size());
+    REQUIRE(!found.empty());
+    REQUIRE(found.front() == 4242);
+}
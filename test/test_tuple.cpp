@@ -0,0 +1,191 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "parse_cache.h"
+#include "units.h"
+#include "utilities.h"
+using namespace argparse;
+
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+using Error = Parser::Diagnostic::Error;
+
+using Window = std::tuple<Duration, Duration, uint32_t>;
+
+} // namespace
+
+/// Tests options that take a fixed number of values
+TEST_CASE("FixedArity", "Parsing") {
+    Parser p;
+    replace_exit_cb(p);
+
+    std::string invalid;
+    std::vector<std::string> invalid_values;
+    std::string not_allowed;
+    Parser::Callbacks cbs;
+    cbs.invalid = [&](const std::string &name, const std::vector<std::string> &values) {
+        invalid = name;
+        invalid_values = values;
+    };
+    cbs.not_allowed = [&not_allowed](const std::string &name, auto) { not_allowed = name; };
+    p.set_callbacks(std::move(cbs));
+
+    const auto bbox = p.add_array<double, 4>(Config<double>{.default_value = {}, .allowed_values = {}, .name = "bbox"});
+    const auto window = p.add_tuple<Duration, Duration, uint32_t>(
+        Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "window", .help = "", .required = false, .letter = 'w'},
+        Window{std::chrono::seconds(1), std::chrono::seconds(5), 10});
+    const auto pair = p.add_array<uint8_t, 2>(Config<uint8_t>{.default_value = {}, .allowed_values = {1, 2, 3}, .name = "pair"});
+    const auto label = p.add_tuple<std::string, int32_t>(Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "label"});
+
+    SECTION("Values following the option") {
+        const char *argv[] = {"path", "--bbox", "0", "0.5", "640", "480", "-w", "2s", "1m", "30", "--label", "x", "-7"};
+        p.parse(13, argv);
+
+        REQUIRE(bbox->value() == std::array<double, 4>{0, 0.5, 640, 480});
+        REQUIRE(std::get<0>(window->value()) == std::chrono::seconds(2));
+        REQUIRE(std::get<1>(window->value()) == std::chrono::minutes(1));
+        REQUIRE(std::get<2>(window->value()) == 30);
+        REQUIRE(label->value() == std::make_tuple(std::string("x"), -7));
+        REQUIRE(invalid.empty());
+    }
+
+    SECTION("Values split by comma") {
+        const char *argv[] = {"path", "--bbox=1,2", "3,4", "--pair", "3,1"};
+        p.parse(5, argv);
+
+        REQUIRE(bbox->value() == std::array<double, 4>{1, 2, 3, 4});
+        REQUIRE(pair->value() == std::array<uint8_t, 2>{3, 1});
+    }
+
+    SECTION("Defaults") {
+        const char *argv[] = {"path", "--bbox", "1,2,3,4"};
+        p.parse(3, argv);
+        REQUIRE(!pair->has_value());
+        REQUIRE(window->value() == Window{std::chrono::seconds(1), std::chrono::seconds(5), 10});
+
+        // Values of the previous parse do not carry over
+        const char *argv2[] = {"path", "-w", "1ms,2ms,3"};
+        p.parse(3, argv2);
+        REQUIRE(!bbox->has_value());
+        REQUIRE(std::get<2>(window->value()) == 3);
+        const char *argv3[] = {"path"};
+        p.parse(1, argv3);
+        REQUIRE(std::get<2>(window->value()) == 10);
+    }
+
+    SECTION("Too many values") {
+        const char *argv[] = {"path", "--bbox", "1,2,3", "4", "5", "--pair", "1,2"};
+        p.parse(7, argv);
+        REQUIRE(invalid == "bbox");
+        REQUIRE(invalid_values == std::vector<std::string>{"1", "2", "3", "4", "5"});
+    }
+
+    SECTION("Too few values") {
+        const char *argv[] = {"path", "--pair", "1"};
+        p.parse(3, argv);
+        REQUIRE(invalid == "pair");
+        REQUIRE(invalid_values == std::vector<std::string>{"1"});
+    }
+
+    SECTION("Allowed values of every element") {
+        const char *argv[] = {"path", "--pair", "1,4"};
+        p.parse(3, argv);
+        REQUIRE(invalid.empty());
+        REQUIRE(not_allowed == "pair");
+        REQUIRE(!pair->has_value());
+    }
+
+    SECTION("A value that fails part way is not kept") {
+        const char *argv[] = {"path", "-w", "2s,3s,x"};
+        REQUIRE_THROWS_AS(p.parse(3, argv), std::invalid_argument);
+        REQUIRE(window->value() == Window{std::chrono::seconds(1), std::chrono::seconds(5), 10});
+
+        // The converted value starts from the elements of the last one swapped out, every element is assigned again
+        const char *argv2[] = {"path", "-w", "4s,5s,6", "--label", "z,2"};
+        p.parse(5, argv2);
+        REQUIRE(window->value() == Window{std::chrono::seconds(4), std::chrono::seconds(5), 6});
+        REQUIRE(label->value() == std::make_tuple(std::string("z"), 2));
+    }
+
+    SECTION("Environment") {
+        Parser q;
+        const auto from_env = q.add_array<int32_t, 3>(
+            Config<int32_t>{.default_value = {}, .allowed_values = {}, .name = "rgb", .help = "", .required = false, .letter = kUnusedChar, .env = "RGB"});
+        const char *environment[] = {"RGB=255,128,0", nullptr};
+        q.set_environment(environment);
+
+        const char *argv[] = {"path"};
+        q.parse(1, argv);
+        REQUIRE(from_env->value() == std::array<int32_t, 3>{255, 128, 0});
+    }
+
+    SECTION("Configuration") {
+        REQUIRE_THROWS_AS((p.add_array<int32_t, 2>(Config<int32_t>{.default_value = 1, .allowed_values = {}, .name = "a"})), InvalidConfig);
+        REQUIRE_THROWS_AS(p.add_tuple<int32_t>(Config<std::string>{.default_value = "1", .allowed_values = {}, .name = "b"}), InvalidConfig);
+        REQUIRE_THROWS_AS(p.add_tuple<int32_t>(Config<std::string>{.default_value = {}, .allowed_values = {"1"}, .name = "c"}), InvalidConfig);
+    }
+}
+
+/// Tests checking the number and the types of the values without setting them
+TEST_CASE("FixedArityValidate", "Validate") {
+    Parser p;
+    std::vector<std::pair<Error, pstd::optional<std::size_t>>> reported;
+    const auto report = [&reported](const Parser::Diagnostic &d) { reported.emplace_back(d.error, d.index); };
+
+    p.add_array<double, 2>(Config<double>{.default_value = {}, .allowed_values = {}, .name = "range"});
+    p.add_tuple<std::string, uint32_t>(Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "host"});
+
+    SECTION("Valid") {
+        const char *argv[] = {"path", "--range", "0.5,1.5", "--host", "localhost", "80"};
+        REQUIRE(p.validate(6, argv, report));
+        REQUIRE(reported.empty());
+    }
+
+    SECTION("Too many values, flagged once where the first appears") {
+        const char *argv[] = {"path", "--range", "1", "2", "3", "4"};
+        REQUIRE(!p.validate(6, argv, report));
+        REQUIRE(reported.size() == 1);
+        REQUIRE(reported[0].first == Error::kInvalid);
+        REQUIRE(reported[0].second == std::size_t{4});
+    }
+
+    SECTION("Too few values") {
+        const char *argv[] = {"path", "--host", "localhost"};
+        REQUIRE(!p.validate(3, argv, report));
+        REQUIRE(reported.size() == 1);
+        REQUIRE(reported[0].first == Error::kInvalid);
+    }
+
+    SECTION("Each value is checked as its own type") {
+        const char *argv[] = {"path", "--host", "80", "localhost"};
+        REQUIRE(!p.validate(4, argv, report));
+        REQUIRE(reported.size() == 1);
+        REQUIRE(reported[0].first == Error::kInvalid);
+        REQUIRE(reported[0].second == std::size_t{3});
+    }
+}
+
+/// Tests values stored in and loaded from the parse cache
+TEST_CASE("FixedArityCache", "Parsing") {
+    std::vector<char> region(64 * 1024, 0);
+    const auto cache = std::make_shared<detail::ParseCache>(region.data(), region.size());
+
+    const char *argv[] = {"path", "--bbox", "0,0,640,480", "--label", "first", "1"};
+    for (std::size_t run = 0; run < 2; run++) {
+        Parser p;
+        p.set_cache(cache);
+        const auto bbox = p.add_array<double, 4>(Config<double>{.default_value = {}, .allowed_values = {}, .name = "bbox"});
+        const auto label = p.add_tuple<std::string, int32_t>(Config<std::string>{.default_value = {}, .allowed_values = {}, .name = "label"});
+        p.parse(6, argv);
+
+        REQUIRE(bbox->value() == std::array<double, 4>{0, 0, 640, 480});
+        REQUIRE(label->value() == std::make_tuple(std::string("first"), 1));
+        REQUIRE(cache->size() == 1);
+    }
+}
@@ -0,0 +1,165 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "units.h"
+#include "utilities.h"
+
+#include <sstream>
+using namespace argparse;
+
+namespace {
+
+Bytes parse_bytes(const std::string &s) { return detail::parse_bytes(s.data(), s.size()); }
+Duration parse_duration(const std::string &s) { return detail::parse_duration(s.data(), s.size()); }
+Rate parse_rate(const std::string &s) { return detail::parse_rate(s.data(), s.size()); }
+
+} // namespace
+
+/// Tests parsing and formatting of sizes, durations and rates
+TEST_CASE("Units", "Parsing") {
+    using namespace std::chrono;
+
+    SECTION("Bytes") {
+        REQUIRE(parse_bytes("512").count == 512);
+        REQUIRE(parse_bytes("512B").count == 512);
+        REQUIRE(parse_bytes("4k").count == 4000);
+        REQUIRE(parse_bytes("4KB").count == 4000);
+        REQUIRE(parse_bytes("4KiB").count == 4096);
+        REQUIRE(parse_bytes("4GiB").count == (uint64_t{4} << 30));
+        REQUIRE(parse_bytes("1.5MB").count == 1500000);
+        REQUIRE(parse_bytes("0.5Ki").count == 512);
+        REQUIRE(parse_bytes("15EiB").count == (uint64_t{15} << 60));
+
+        REQUIRE_THROWS_AS(parse_bytes(""), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_bytes("GiB"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_bytes("4XB"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_bytes("1.5"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_bytes("-4KB"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_bytes("16EiB"), std::out_of_range);
+        REQUIRE_THROWS_AS(parse_bytes("99999999999999999999"), std::out_of_range);
+
+        REQUIRE(detail::format(Bytes{0}) == "0B");
+        REQUIRE(detail::format(Bytes{512}) == "512B");
+        REQUIRE(detail::format(Bytes{4000}) == "4kB");
+        REQUIRE(detail::format(Bytes{uint64_t{4} << 30}) == "4GiB");
+        REQUIRE(detail::format(Bytes{1500000}) == "1500kB");
+    }
+
+    SECTION("Duration") {
+        REQUIRE(parse_duration("0") == Duration::zero());
+        REQUIRE(parse_duration("250ms") == milliseconds{250});
+        REQUIRE(parse_duration("10us") == microseconds{10});
+        REQUIRE(parse_duration("10\xC2\xB5s") == microseconds{10});
+        REQUIRE(parse_duration("7ns") == nanoseconds{7});
+        REQUIRE(parse_duration("1h30m") == minutes{90});
+        REQUIRE(parse_duration("1m30.5s") == milliseconds{90500});
+        REQUIRE(parse_duration("1.5h") == minutes{90});
+
+        REQUIRE_THROWS_AS(parse_duration(""), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_duration("5"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_duration("5d"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_duration("1h30"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_duration("0.5ns"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_duration("3000000h"), std::out_of_range);
+
+        REQUIRE(detail::format(Duration::zero()) == "0s");
+        REQUIRE(detail::format(milliseconds{250}) == "250ms");
+        REQUIRE(detail::format(minutes{90}) == "1h30m");
+        REQUIRE(detail::format(milliseconds{1500}) == "1s500ms");
+        REQUIRE(detail::format(nanoseconds{1001}) == "1001ns");
+        REQUIRE(detail::format(-seconds{2}) == "-2s");
+    }
+
+    SECTION("Rate") {
+        REQUIRE(parse_rate("100") == Rate{100, seconds{1}});
+        REQUIRE(parse_rate("10k/s") == Rate{10000, seconds{1}});
+        REQUIRE(parse_rate("5/m") == Rate{5, minutes{1}});
+        REQUIRE(parse_rate("500/100ms") == Rate{500, milliseconds{100}});
+        REQUIRE(parse_rate("1.5M/h") == Rate{1500000, hours{1}});
+        REQUIRE(parse_rate("500/100ms").per_second() == Approx(5000.0));
+
+        REQUIRE_THROWS_AS(parse_rate("/s"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_rate("10k/"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_rate("10k/d"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_rate("10/0s"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_rate("10ks"), std::invalid_argument);
+        REQUIRE_THROWS_AS(parse_rate("20E/s"), std::out_of_range);
+
+        REQUIRE(detail::format(Rate{10000, seconds{1}}) == "10k/s");
+        REQUIRE(detail::format(Rate{500, milliseconds{100}}) == "500/100ms");
+        REQUIRE(detail::format(Rate{1001, minutes{1}}) == "1001/m");
+    }
+}
+
+/// Tests options of the unit types through the parser
+TEST_CASE("UnitOptions", "Parsing") {
+    using namespace std::chrono;
+
+    Parser p;
+    replace_exit_cb(p);
+
+    const auto cache = p.add(argparse::Config<Bytes>{.default_value = Bytes{uint64_t{1} << 30}, .allowed_values = {}, .name = "cache"});
+    const auto timeout = p.add(argparse::Config<Duration>{.default_value = seconds{30}, .allowed_values = {}, .name = "timeout"});
+    const auto limit = p.add(argparse::Config<Rate>{.default_value = {}, .allowed_values = {}, .name = "rate"});
+    const auto steps = p.add_multivalent(argparse::Config<Duration>{.default_value = {}, .allowed_values = {}, .name = "steps"});
+
+    SECTION("Values") {
+        const char *argv[] = {"path", "--cache", "4GiB", "--timeout", "250ms", "--rate", "10k/s", "--steps", "1s", "1m30s"};
+        p.parse(10, argv);
+
+        REQUIRE(cache->value() == Bytes{uint64_t{4} << 30});
+        REQUIRE(timeout->value() == milliseconds{250});
+        REQUIRE(limit->value() == Rate{10000, seconds{1}});
+        REQUIRE(steps->value() == std::vector<Duration>{seconds{1}, seconds{90}});
+    }
+
+    SECTION("Defaults") {
+        const char *argv[] = {"path"};
+        p.parse(1, argv);
+
+        REQUIRE(cache->value() == Bytes{uint64_t{1} << 30});
+        REQUIRE(timeout->value() == seconds{30});
+        REQUIRE(!limit->has_value());
+    }
+
+    SECTION("Invalid") {
+        const char *overflow[] = {"path", "--cache", "64EiB"};
+        REQUIRE(!p.validate(3, overflow));
+        REQUIRE_THROWS_AS(p.parse(3, overflow), std::out_of_range);
+
+        const char *unitless[] = {"path", "--timeout", "30"};
+        REQUIRE(!p.validate(3, unitless));
+        REQUIRE_THROWS_AS(p.parse(3, unitless), std::invalid_argument);
+    }
+
+    SECTION("Help") {
+        std::stringstream ss;
+        auto *const old = std::cout.rdbuf(ss.rdbuf());
+        p.help();
+        std::cout.rdbuf(old);
+
+        const auto help = ss.str();
+        REQUIRE(help.find("bytes") != std::string::npos);
+        REQUIRE(help.find("duration") != std::string::npos);
+        REQUIRE(help.find("rate") != std::string::npos);
+        REQUIRE(help.find("1GiB") != std::string::npos);
+        REQUIRE(help.find("30s") != std::string::npos);
+    }
+}
+
+/// Tests allowed values of the unit types, which compare the values as given
+TEST_CASE("UnitAllowedValues", "Parsing") {
+    using namespace std::chrono;
+
+    Parser p;
+    replace_exit_cb(p);
+
+    const auto timeout = p.add(argparse::Config<Duration>{.default_value = {}, .allowed_values = {seconds{1}, minutes{1}}, .name = "timeout"});
+    (void)timeout;
+
+    const char *allowed[] = {"path", "--timeout", "60s"};
+    REQUIRE(p.validate(3, allowed));
+
+    const char *not_allowed[] = {"path", "--timeout", "2s"};
+    REQUIRE(!p.validate(3, not_allowed));
+}
@@ -0,0 +1,350 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "usdt.h"
+#include "utilities.h"
+using namespace argparse;
+
+#include <elf.h>
+#include <link.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#if ARGPARSE_USDT && defined(__x86_64__)
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/ptrace.h>
+#include <sys/user.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <functional>
+#include <map>
+#endif
+
+namespace {
+
+using Words = std::vector<std::string>;
+
+/// A probe site as described by its note, as a tracer reads it
+struct Probe {
+    std::string provider;
+    std::string name;
+    Words arguments; /// Such as "-8@%rax", a size signed for signed values, then the operand
+    uintptr_t address = 0;
+};
+
+/// Finds the loaded library, its path and the address it is loaded at
+int find_library(dl_phdr_info *info, size_t, void *data) {
+    if (std::strstr(info->dlpi_name, "libargparse") == nullptr) {
+        return 0;
+    }
+    *static_cast<dl_phdr_info *>(data) = *info;
+    return 1;
+}
+
+/// \return The probes of the loaded library, read from [.note.stapsdt] in its file, which is not loaded
+std::vector<Probe> read_probes() {
+    dl_phdr_info library{};
+    REQUIRE(dl_iterate_phdr(&find_library, &library) == 1);
+
+    std::ifstream file(library.dlpi_name, std::ios::binary);
+    const std::string elf((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    REQUIRE(elf.size() > sizeof(Elf64_Ehdr));
+    REQUIRE(elf.compare(0, SELFMAG, ELFMAG) == 0);
+
+    Elf64_Ehdr header;
+    std::memcpy(&header, elf.data(), sizeof(header));
+    std::vector<Elf64_Shdr> sections(header.e_shnum);
+    std::memcpy(sections.data(), elf.data() + header.e_shoff, sections.size() * sizeof(Elf64_Shdr));
+    const char *names = elf.data() + sections[header.e_shstrndx].sh_offset;
+
+    const Elf64_Shdr *notes = nullptr;
+    const Elf64_Shdr *base = nullptr;
+    for (const auto &section : sections) {
+        if (std::strcmp(names + section.sh_name, ".note.stapsdt") == 0) {
+            notes = &section;
+        } else if (std::strcmp(names + section.sh_name, ".stapsdt.base") == 0) {
+            base = &section;
+        }
+    }
+
+    std::vector<Probe> probes;
+    if (notes == nullptr) {
+        return probes;
+    }
+    REQUIRE(base != nullptr);
+
+    // Each note is a header, the owner "stapsdt", then the address, the base, the semaphore and 3 strings
+    const char *it = elf.data() + notes->sh_offset;
+    const char *const end = it + notes->sh_size;
+    const auto align = [](const std::size_t size) { return (size + 3) & ~std::size_t{3}; };
+    while (it < end) {
+        Elf64_Nhdr note;
+        std::memcpy(&note, it, sizeof(note));
+        const char *owner = it + sizeof(note);
+        const char *desc = owner + align(note.n_namesz);
+        it = desc + align(note.n_descsz);
+        REQUIRE(note.n_type == 3);
+        REQUIRE(std::strcmp(owner, "stapsdt") == 0);
+
+        uint64_t pc = 0;
+        uint64_t note_base = 0;
+        std::memcpy(&pc, desc, 8);
+        std::memcpy(&note_base, desc + 8, 8);
+
+        Probe probe;
+        probe.address = library.dlpi_addr + pc + (base->sh_addr - note_base);
+        const char *strings = desc + 24;
+        probe.provider = strings;
+        strings += probe.provider.size() + 1;
+        probe.name = strings;
+        strings += probe.name.size() + 1;
+        for (const char *argument = strings; *argument != '\0';) {
+            const char *space = std::strchr(argument, ' ');
+            const std::size_t size = (space == nullptr) ? std::strlen(argument) : static_cast<std::size_t>(space - argument);
+            probe.arguments.emplace_back(argument, size);
+            argument += size + ((space == nullptr) ? 0 : 1);
+        }
+        probes.push_back(std::move(probe));
+    }
+
+    return probes;
+}
+
+#if ARGPARSE_USDT && defined(__x86_64__)
+
+/// Runs [run] in a child process with a breakpoint on every probe, the way a tracer attaches
+/// Each probe site is a single nop, so the child resumes after it without putting it back
+/// \return Each probe that fired, its name then its arguments, strings for the unsigned ones which are all names
+std::vector<Words> trace(const std::vector<Probe> &probes, const std::function<void()> &run) {
+    const pid_t pid = fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+        ptrace(PTRACE_TRACEME, 0, nullptr, nullptr);
+        raise(SIGSTOP);
+        try {
+            run();
+        } catch (...) {
+        }
+        _exit(0);
+    }
+
+    // The child is killed if a check fails while it is stopped
+    struct Child {
+        pid_t pid;
+        bool exited = false;
+        ~Child() {
+            if (!exited) {
+                kill(pid, SIGKILL);
+                waitpid(pid, nullptr, 0);
+            }
+        }
+    } child{pid};
+
+    int status = 0;
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    REQUIRE(WIFSTOPPED(status));
+
+    std::map<uintptr_t, const Probe *> sites;
+    for (const auto &probe : probes) {
+        errno = 0;
+        const long word = ptrace(PTRACE_PEEKTEXT, pid, probe.address, nullptr);
+        REQUIRE(errno == 0);
+        REQUIRE((word & 0xFF) == 0x90);
+        const long breakpoint = (word & ~0xFFL) | 0xCC;
+        REQUIRE(ptrace(PTRACE_POKETEXT, pid, probe.address, breakpoint) == 0);
+        sites[probe.address] = &probe;
+    }
+
+    const std::string path = "/proc/" + std::to_string(pid) + "/mem";
+    const int memory = open(path.c_str(), O_RDONLY);
+    REQUIRE(memory >= 0);
+    const auto read_string = [memory](uint64_t address) {
+        std::string out;
+        char c = 0;
+        while ((pread(memory, &c, 1, static_cast<off_t>(address++)) == 1) && (c != '\0')) {
+            out += c;
+        }
+        return out;
+    };
+
+    std::vector<Words> events;
+    REQUIRE(ptrace(PTRACE_CONT, pid, nullptr, nullptr) == 0);
+    while (true) {
+        REQUIRE(waitpid(pid, &status, 0) == pid);
+        if (WIFEXITED(status)) {
+            child.exited = true;
+            break;
+        }
+        REQUIRE(WIFSTOPPED(status));
+        if (WSTOPSIG(status) != SIGTRAP) {
+            REQUIRE(ptrace(PTRACE_CONT, pid, nullptr, WSTOPSIG(status)) == 0);
+            continue;
+        }
+
+        user_regs_struct regs{};
+        REQUIRE(ptrace(PTRACE_GETREGS, pid, nullptr, &regs) == 0);
+        const auto site = sites.find(regs.rip - 1);
+        REQUIRE(site != sites.end());
+
+        const std::map<std::string, uint64_t> registers{
+            {"rax", regs.rax}, {"rbx", regs.rbx}, {"rcx", regs.rcx}, {"rdx", regs.rdx}, {"rsi", regs.rsi},
+            {"rdi", regs.rdi}, {"rbp", regs.rbp}, {"rsp", regs.rsp}, {"r8", regs.r8},   {"r9", regs.r9},
+            {"r10", regs.r10}, {"r11", regs.r11}, {"r12", regs.r12}, {"r13", regs.r13}, {"r14", regs.r14},
+            {"r15", regs.r15}};
+        const auto read_register = [&registers](const std::string &name) {
+            const auto found = registers.find(name);
+            REQUIRE(found != registers.end());
+            return found->second;
+        };
+
+        Words event{site->second->name};
+        for (const auto &argument : site->second->arguments) {
+            // "$imm", "%reg" or "disp(%reg)"
+            const auto at = argument.find('@');
+            const std::string operand = argument.substr(at + 1);
+            uint64_t value = 0;
+            if (operand[0] == '$') {
+                value = static_cast<uint64_t>(std::stoll(operand.substr(1)));
+            } else if (operand[0] == '%') {
+                value = read_register(operand.substr(1));
+            } else {
+                const auto open = operand.find("(%");
+                const int64_t displacement = (open == 0) ? 0 : std::stoll(operand.substr(0, open));
+                const uint64_t address = read_register(operand.substr(open + 2, operand.size() - open - 3)) + displacement;
+                REQUIRE(pread(memory, &value, sizeof(value), static_cast<off_t>(address)) == sizeof(value));
+            }
+            const bool is_signed = argument[0] == '-';
+            event.push_back(is_signed ? std::to_string(static_cast<int64_t>(value)) : read_string(value));
+        }
+        events.push_back(std::move(event));
+
+        // Step over the nop
+        regs.rip = site->first + 1;
+        REQUIRE(ptrace(PTRACE_SETREGS, pid, nullptr, &regs) == 0);
+        REQUIRE(ptrace(PTRACE_CONT, pid, nullptr, nullptr) == 0);
+    }
+    close(memory);
+
+    return events;
+}
+
+/// \return The events of the probe [name]
+std::vector<Words> only(const std::vector<Words> &events, const std::string &name) {
+    std::vector<Words> out;
+    for (const auto &event : events) {
+        if (event.front() == name) {
+            out.push_back(event);
+        }
+    }
+    return out;
+}
+
+#endif
+
+} // namespace
+
+/// Tests that the library has a note for every probe, or none when they are compiled out
+TEST_CASE("UsdtNotes", "Usdt") {
+    const auto probes = read_probes();
+
+#if ARGPARSE_USDT
+    // Names are unsigned "8@", token indices, counts and outcomes are signed "-8@"
+    const std::vector<std::pair<std::string, Words>> expected{
+        {"parse_entry", {"8@", "-8@"}},
+        {"parse_return", {"8@", "-8@"}},
+        {"subparser", {"8@", "8@", "-8@"}},
+        {"set_failure", {"8@", "-8@", "8@"}},
+        {"callback", {"8@", "8@", "-8@"}},
+    };
+    for (const auto &pair : expected) {
+        INFO(pair.first);
+        std::size_t sites = 0;
+        for (const auto &probe : probes) {
+            if (probe.name != pair.first) {
+                continue;
+            }
+            sites++;
+            REQUIRE(probe.provider == "argparse");
+            REQUIRE(probe.arguments.size() == pair.second.size());
+            for (std::size_t ii = 0; ii < pair.second.size(); ii++) {
+                REQUIRE(probe.arguments[ii].compare(0, pair.second[ii].size(), pair.second[ii]) == 0);
+            }
+#if defined(__x86_64__)
+            REQUIRE(*reinterpret_cast<const uint8_t *>(probe.address) == 0x90);
+#endif
+        }
+        REQUIRE(sites > 0);
+    }
+#else
+    REQUIRE(probes.empty());
+#endif
+}
+
+#if ARGPARSE_USDT && defined(__x86_64__)
+
+/// Tests the token indices the probes give, indices into the input arguments of the top parser
+TEST_CASE("UsdtTokens", "Usdt") {
+    const auto probes = read_probes();
+
+    Parser p("prog");
+    Parser::Callbacks cbs;
+    cbs.invalid = [](const std::string &, const std::vector<std::string> &) {};
+    cbs.not_allowed = [](const std::string &, const std::vector<std::string> &) {};
+    cbs.missing = [](const std::string &) {};
+    p.set_callbacks(std::move(cbs));
+
+    auto &subparsers = p.add_subparser("command", {"run"});
+    auto &run = subparsers["run"];
+    run.add(Config<bool>{.default_value = false, .allowed_values = {}, .name = "verbose", .help = "", .required = false, .letter = 'v'});
+    run.add(Config<int32_t>{.default_value = 1, .allowed_values = {1, 2, 3}, .name = "level", .help = "", .required = false, .letter = 'l'});
+    run.add(Config<int32_t>{.default_value = 1, .allowed_values = {1, 2}, .name = "number", .help = "", .required = false, .letter = kUnusedChar, .env = "NUMBER"});
+
+    SECTION("Subparser offsets, clusters and '=' values") {
+        const auto events = trace(probes, [&p] {
+            const char *argv[] = {"path", "run", "-vl", "5", "--number=9"};
+            p.parse(5, argv);
+        });
+
+        REQUIRE(only(events, "parse_entry") == std::vector<Words>{{"parse_entry", "prog", "5"}});
+        REQUIRE(only(events, "subparser") == std::vector<Words>{{"subparser", "command", "run", "1"}});
+        REQUIRE(only(events, "set_failure") == std::vector<Words>{{"set_failure", "level", "2", "5"},
+                                                                  {"set_failure", "number", "4", "9"}});
+        REQUIRE(only(events, "callback") == std::vector<Words>{{"callback", "not_allowed", "level", "2"},
+                                                               {"callback", "not_allowed", "number", "4"},
+                                                               {"callback", "help", "run", "-1"},
+                                                               {"callback", "exit", "run", "-1"}});
+
+        // The exit callback throws, which the return probe reports
+        REQUIRE(only(events, "parse_return") == std::vector<Words>{{"parse_return", "prog", "1"}});
+    }
+
+    SECTION("Values that are not in the input arguments") {
+        const char *environment[] = {"NUMBER=9", nullptr};
+        p.set_environment(environment);
+        const auto events = trace(probes, [&p] {
+            const char *argv[] = {"path", "run"};
+            p.parse(2, argv);
+        });
+
+        REQUIRE(only(events, "set_failure") == std::vector<Words>{{"set_failure", "number", "-1", "9"}});
+        REQUIRE(only(events, "callback").front() == Words{"callback", "not_allowed", "number", "-1"});
+    }
+
+    SECTION("Subparsers that do not exist") {
+        const auto events = trace(probes, [&p] {
+            const char *argv[] = {"path", "walk"};
+            p.parse(2, argv);
+        });
+
+        REQUIRE(only(events, "subparser") == std::vector<Words>{{"subparser", "command", "walk", "1"}});
+        REQUIRE(only(events, "callback").front() == Words{"callback", "invalid", "command", "1"});
+    }
+}
+
+#endif
@@ -0,0 +1,158 @@
+#include "catch.hpp"
+
+#include "argparse.h"
+#include "utilities.h"
+using namespace argparse;
+
+#include <string>
+#include <vector>
+
+namespace {
+
+using Error = Parser::Diagnostic::Error;
+
+/// A diagnostic with its name copied, since the name is only valid during the callback
+struct Reported {
+    Error error;
+    std::string name;
+    pstd::optional<std::size_t> index;
+};
+
+} // namespace
+
+/// Tests checking arguments without setting values
+TEST_CASE("Validate", "Validate") {
+    Parser p;
+    replace_exit_cb(p);
+
+    std::vector<Reported> reported;
+    const auto report = [&reported](const Parser::Diagnostic &d) { reported.push_back({d.error, d.name, d.index}); };
+
+    auto file = p.add_leading_positional<std::string>({.default_value = {}, .allowed_values = {}, .name = "file", .help = ""});
+    auto number = p.add(argparse::Config<int32_t>{.default_value = 7, .allowed_values = {1, 2, 3, 7}, .name = "number"});
+    auto words = p.add_multivalent(argparse::Config<std::string>{.default_value = {}, .allowed_values = {"a", "b", "c"}, .name = "words"});
+    auto flag = p.add(argparse::Config<bool>{.default_value = false, .allowed_values = {}, .name = "flag"});
+
+    SECTION("Valid arguments leave the values untouched") {
+        const char *argv[] = {"path", "config.yaml", "--number=2", "--words", "a,b", "c", "--flag", "--", "--number"};
+        REQUIRE(p.validate(9, argv, report));
+        REQUIRE(reported.empty());
+
+        REQUIRE(!file->has_value());
+        REQUIRE(number->value() == 7);
+        REQUIRE(!words->has_value());
+        REQUIRE(!flag->value());
+    }
+
+    SECTION("Values that are not allowed") {
+        const char *argv[] = {"path", "config.yaml", "--number", "5", "--words", "a,d"};
+        REQUIRE(!p.validate(6, argv, report));
+
+        REQUIRE(reported.size() == 2);
+        REQUIRE(reported[0].error == Error::kNotAllowed);
+        REQUIRE(reported[0].name == "number");
+        REQUIRE(reported[0].index == std::size_t{3});
+        REQUIRE(reported[1].error == Error::kNotAllowed);
+        REQUIRE(reported[1].name == "words");
+        REQUIRE(reported[1].index == std::size_t{5});
+    }
+
+    SECTION("Values that can not be converted, and too many values") {
+        const char *argv[] = {"path", "config.yaml", "--number", "abc", "--number", "1", "2"};
+        REQUIRE(!p.validate(7, argv, report));
+
+        REQUIRE(reported.size() == 2);
+        REQUIRE(reported[0].error == Error::kInvalid);
+        REQUIRE(reported[0].index == std::size_t{3});
+        REQUIRE(reported[1].error == Error::kInvalid);
+        REQUIRE(reported[1].index == std::size_t{5});
+    }
+
+    SECTION("Missing values, options and positional arguments") {
+        const char *argv[] = {"path", "--number"};
+        REQUIRE(!p.validate(2, argv, report));
+
+        REQUIRE(reported.size() == 2);
+        REQUIRE(reported[0].error == Error::kMissing);
+        REQUIRE(reported[0].name == "number");
+        REQUIRE(!reported[0].index.has_value());
+        REQUIRE(reported[1].error == Error::kMissing);
+        REQUIRE(reported[1].name == "file");
+    }
+
+    SECTION("Help") {
+        p.add(argparse::Config<uint32_t>{.default_value = {}, .allowed_values = {}, .name = "level", .help = "", .required = true});
+
+        // Required options are not checked, as parse shows the help message before it would
+        const char *help[] = {"path", "config.yaml", "-h"};
+        REQUIRE(p.validate(3, help, report));
+        REQUIRE(reported.empty());
+
+        const char *long_help[] = {"path", "config.yaml", "--help", "--flag"};
+        REQUIRE(p.validate(4, long_help, report));
+        REQUIRE(reported.empty());
+
+        // Values are still checked, and positional arguments are still required, as parse checks them first
+        const char *not_allowed[] = {"path", "--help", "--number", "5"};
+        REQUIRE(!p.validate(4, not_allowed, report));
+        REQUIRE(reported.size() == 2);
+        REQUIRE(reported[0].error == Error::kNotAllowed);
+        REQUIRE(reported[0].name == "number");
+        REQUIRE(reported[1].error == Error::kMissing);
+        REQUIRE(reported[1].name == "file");
+    }
+
+    SECTION("Agrees with parse") {
+        bool exited = false;
+        Parser::Callbacks cbs;
+        cbs.exit = [&exited] { exited = true; };
+        p.set_callbacks(std::move(cbs));
+
+        const char *valid[] = {"path", "config.yaml", "--number", "3"};
+        REQUIRE(p.validate(4, valid));
+        p.parse(4, valid);
+        REQUIRE(!exited);
+
+        const char *invalid[] = {"path", "config.yaml", "--number", "4"};
+        REQUIRE(!p.validate(4, invalid));
+        p.parse(4, invalid);
+        REQUIRE(exited);
+    }
+}
+
+/// Tests checking arguments of subparsers
+TEST_CASE("ValidateSubparser", "Validate") {
+    Parser p;
+    replace_exit_cb(p);
+
+    auto &subparsers = p.add_subparser("mode", {"play", "stop"});
+    subparsers["play"].add(argparse::Config<int32_t>{.default_value = {}, .allowed_values = {}, .name = "speed", .help = "", .required = true});
+
+    std::vector<Reported> reported;
+    const auto report = [&reported](const Parser::Diagnostic &d) { reported.push_back({d.error, d.name, d.index}); };
+
+    SECTION("Arguments are checked by the selected subparser") {
+        const char *argv[] = {"path", "play", "--speed", "2"};
+        REQUIRE(p.validate(4, argv, report));
+
+        const char *missing[] = {"path", "play"};
+        REQUIRE(!p.validate(2, missing, report));
+        REQUIRE(reported.size() == 1);
+        REQUIRE(reported[0].name == "speed");
+    }
+
+    SECTION("Unknown or missing subparser") {
+        const char *unknown[] = {"path", "rewind"};
+        REQUIRE(!p.validate(2, unknown, report));
+
+        const char *missing[] = {"path"};
+        REQUIRE(!p.validate(1, missing, report));
+
+        REQUIRE(reported.size() == 2);
+        REQUIRE(reported[0].error == Error::kInvalid);
+        REQUIRE(reported[0].name == "mode");
+        REQUIRE(reported[0].index == std::size_t{1});
+        REQUIRE(reported[1].error == Error::kMissing);
+        REQUIRE(reported[1].name == "mode");
+    }
+}
@@ -21,6 +21,12 @@ TEST_CASE("variant", "Parsing") {
         std::string operator()(int8_t) { return "int8_t"; };
         std::string operator()(bool) { return "bool"; };
         std::string operator()(char) { return "char"; };
+        std::string operator()(Bytes) { return "Bytes"; };
+        std::string operator()(Duration) { return "Duration"; };
+        std::string operator()(Rate) { return "Rate"; };
+        std::string operator()(CpuSet) { return "CpuSet"; };
+        std::string operator()(IpAddress) { return "IpAddress"; };
+        std::string operator()(Cidr) { return "Cidr"; };
     };
 
     SECTION("std::string") {
@@ -126,4 +132,58 @@ TEST_CASE("variant", "Parsing") {
         REQUIRE(str == "char");
         REQUIRE(var == value);
     }
+
+    SECTION("Bytes") {
+        const auto value = Bytes{uint64_t{4} << 30};
+        var = value;
+        const auto str = var.visit(Visitor{});
+        REQUIRE(str == "Bytes");
+        REQUIRE(var == value);
+        REQUIRE(var.string() == "4GiB");
+    }
+
+    SECTION("Duration") {
+        const auto value = Duration{std::chrono::minutes{90}};
+        var = value;
+        const auto str = var.visit(Visitor{});
+        REQUIRE(str == "Duration");
+        REQUIRE(var == value);
+        REQUIRE(var.string() == "1h30m");
+    }
+
+    SECTION("Rate") {
+        const auto value = Rate{10000, std::chrono::seconds{1}};
+        var = value;
+        const auto str = var.visit(Visitor{});
+        REQUIRE(str == "Rate");
+        REQUIRE(var == value);
+        REQUIRE(var.string() == "10k/s");
+    }
+
+    SECTION("CpuSet") {
+        const auto value = CpuSet{{0xFFFF, 0x1}};
+        var = value;
+        const auto str = var.visit(Visitor{});
+        REQUIRE(str == "CpuSet");
+        REQUIRE(var == value);
+        REQUIRE(var.string() == "0-15,64");
+    }
+
+    SECTION("IpAddress") {
+        const auto value = IpAddress{{192, 0, 2, 1}, false};
+        var = value;
+        const auto str = var.visit(Visitor{});
+        REQUIRE(str == "IpAddress");
+        REQUIRE(var == value);
+        REQUIRE(var.string() == "192.0.2.1");
+    }
+
+    SECTION("Cidr") {
+        const auto value = Cidr{IpAddress{{0x20, 0x01, 0x0d, 0xb8}, true}, 32};
+        var = value;
+        const auto str = var.visit(Visitor{});
+        REQUIRE(str == "Cidr");
+        REQUIRE(var == value);
+        REQUIRE(var.string() == "2001:db8::/32");
+    }
 }